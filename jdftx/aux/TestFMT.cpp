@@ -0,0 +1,319 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+//Benchmark of the pointwise FMT and bonding kernels (MixedFMT.cpp) against a plain scalar loop
+
+#include <core/VectorField.h>
+#include <core/Thread.h>
+#include <core/Util.h>
+#include <fluid/MixedFMT.h>
+#include <fluid/MixedFMT_internal.h>
+
+//Defined in MixedFMT.cpp:
+TensorFieldTilde tensorKernel(const ScalarFieldTilde& nTilde);
+void phiFMT(int N, double* phiArr,
+	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
+	vector3<const double*> n1vArr, vector3<const double*> n2vArr, tensor3<const double*> n2mArr,
+	double *grad_n0arr, double *grad_n1arr, double *grad_n2arr, double *grad_n3arr,
+	vector3<double*> grad_n1vArr, vector3<double*> grad_n2vArr, tensor3<double*> grad_n2mArr);
+void phiBond(int N, double Rhm, double scale, double* phiArr,
+	const double *n0mol, const double *n2, const double *n3, vector3<const double*> n2vArr,
+	double *grad_n0mol, double *grad_n2, double *grad_n3, vector3<double*> grad_n2vArr);
+
+//Reference: scalar loops over the kernels prior to vectorization (copied from the original MixedFMT_internal.h, so that the
+//comparison below checks the new kernels in MixedFMT_internal.h against an independent implementation)
+namespace Reference
+{
+//Compute vT*m*v for a vector v and a symmetric traceless tensor m
+inline double mul_vTmv(const tensor3<>& m, const vector3<>& v)
+{	return 2*(m.xy()*v.x()*v.y() + m.yz()*v.y()*v.z() + m.zx()*v.z()*v.x())
+		+ m.xxr()*v.x()*v.x() + m.yyr()*v.y()*v.y() - (m.xxr()+m.yyr())*v.z()*v.z();
+}
+//Accumulate gradient of above function
+inline void mul_vTmv_grad(const double grad_mul, const tensor3<>& m, const vector3<>& v,
+	tensor3<>& grad_m, vector3<>& grad_v)
+{	grad_m.xy() += (2*grad_mul)*v.x()*v.y();
+	grad_m.yz() += (2*grad_mul)*v.y()*v.z();
+	grad_m.zx() += (2*grad_mul)*v.z()*v.x();
+	grad_m.xxr() += grad_mul*(v.x()*v.x()-v.z()*v.z());
+	grad_m.yyr() += grad_mul*(v.y()*v.y()-v.z()*v.z());
+	grad_v.x() += (2*grad_mul)*(m.xy()*v.y() + m.zx()*v.z() + m.xxr()*v.x());
+	grad_v.y() += (2*grad_mul)*(m.xy()*v.x() + m.yz()*v.z() + m.yyr()*v.y());
+	grad_v.z() += (2*grad_mul)*(m.yz()*v.y() + m.zx()*v.x()- (m.xxr()+m.yyr())*v.z());
+}
+
+
+//Compute tr(m^3) for a symmetric traceless tensor m (See ~/Water1D/FMT_tensorWeights.m for expressions)
+inline double trace_cubed(const tensor3<>& m)
+{	return -3.0 * (-2.0*m.xy()*m.yz()*m.zx() + pow(m.yz(),2)*m.xxr() - pow(m.xy(),2)*(m.xxr()+m.yyr()) + m.yyr()*(pow(m.zx(),2)+m.xxr()*(m.xxr()+m.yyr())));
+}
+//Accumulate gradient of above function
+inline void trace_cubed_grad(const double grad_trace, const tensor3<>& m, tensor3<>& grad_m)
+{	grad_m.xy() += (6*grad_trace)* (m.yz()*m.zx()+m.xy()*(m.xxr()+m.yyr()));
+	grad_m.yz() += (6*grad_trace)* (m.xy()*m.zx()-m.yz()*m.xxr());
+	grad_m.zx() += (6*grad_trace)* (m.xy()*m.yz()-m.zx()*m.yyr());
+	grad_m.xxr() += (-3*grad_trace)* (-pow(m.xy(),2)+pow(m.yz(),2)+m.yyr()*(2*m.xxr()+m.yyr()));
+	grad_m.yyr() += (-3*grad_trace)* (-pow(m.xy(),2)+pow(m.zx(),2)+m.xxr()*(m.xxr()+2*m.yyr()));
+}
+
+//White-Bear mark II FMT scale function f2 (and derivative) [replace with f2(x)=f3(x)=1 for standard Tarazona FMT]:
+inline double WB_f2(double x, double& f2_x)
+{	if(x<0.002)
+	{	f2_x = x*((2./9) + x*(3./18 + x*(4./30)));
+		return 1 + x*x*((1./9) + x*(1./18 + x*(1./30)));
+	}
+	else
+	{	f2_x = (-1./3)*(x*(2+x) + 2*log(1-x)) / (x*x);
+		return 1 + (1./3)*(2-x + 2*(1-x)*log(1-x)/x);
+	}
+}
+
+//White-Bear mark II FMT scale function f3 (and derivative) [replace with f2(x)=f3(x)=1 for standard Tarazona FMT]:
+inline double WB_f3(double x, double& f3_x)
+{	if(x<0.005)
+	{	f3_x = -4./9 + x*(2./18 + x*(3./45 + x*(4./90)));
+		return 1 + x*(-4./9 + x*(1./18 + x*(1./45 + x*(1./90))));
+	}
+	else
+	{	f3_x = 2*(1-x) * (x*(2+x) + 2*log(1-x)) / (3*x*x*x);
+		return 1 - (x*(2+x*(-3+x*2)) + 2*(1-x)*(1-x)*log(1-x)) / (3*x*x);
+	}
+}
+
+//FMT functional
+inline double phiFMT_calc(int i,
+	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
+	vector3<const double*> n1vArr, vector3<const double*> n2vArr, tensor3<const double*> n2mArr,
+	double *grad_n0arr, double *grad_n1arr, double *grad_n2arr, double *grad_n3arr,
+	vector3<double*> grad_n1vArr, vector3<double*> grad_n2vArr, tensor3<double*> grad_n2mArr)
+{
+	double n0 = n0arr[i];
+	double n1 = n1arr[i];
+	double n2 = n2arr[i];
+	double n3 = n3arr[i];
+	if(n0<0. || n1<0. || n2<0. || n3<0.) return 0.;
+	if(n3>=1.) return NAN;
+	vector3<> n1v = loadVector(n1vArr, i);
+	vector3<> n2v = loadVector(n2vArr, i);
+	tensor3<> n2m = loadTensor(n2mArr, i);
+	double tensorPart = Reference::mul_vTmv(n2m, n2v) - 0.5*Reference::trace_cubed(n2m);
+
+	double n1v_n2v = dot(n1v, n2v);
+	double n2vsq = n2v.length_squared();
+	double pole = 1./(1-n3); //The following is derived easily using: d(pole^N)/d(n3) = N pole^(N+1)
+
+	double f2prime, f2 = Reference::WB_f2(n3, f2prime), comb2 = (n1*n2-n1v_n2v);
+	double f3prime, f3 = Reference::WB_f3(n3, f3prime), comb3 = (n2*(n2*n2-3*n2vsq) + 9.*tensorPart);
+	double phi    = n0*log(pole) + pole*(f2*comb2 + pole*((1./((24*M_PI)))*f3*comb3));
+	double phi_n0 = log(pole);
+	double phi_n1 = pole*(f2*n2);
+	double phi_n2 = pole*(f2*n1 + pole*((1./(8*M_PI))*f3*(n2*n2-n2vsq)));
+	double phi_n3 = pole*(n0 + pole*(f2*comb2 + pole*((1./(12*M_PI))*f3*comb3)))
+		+ pole*(f2prime*comb2 + pole*((1./(24*M_PI))*f3prime*comb3));
+	vector3<> phi_n1v = (-pole*f2)*n2v;
+	vector3<> phi_n2v = (-pole)*(f2*n1v + (pole*f3*n2/(4*M_PI))*n2v );
+	double phi_tensorPart = pole*pole*f3*(9./(24*M_PI));
+
+	tensor3<> phi_n2m;
+	Reference::mul_vTmv_grad(phi_tensorPart, n2m, n2v, phi_n2m, phi_n2v);
+	Reference::trace_cubed_grad(-0.5*phi_tensorPart, n2m, phi_n2m);
+	accumTensor(phi_n2m, grad_n2mArr, i);
+	accumVector(phi_n2v, grad_n2vArr, i);
+	accumVector(phi_n1v, grad_n1vArr, i);
+	grad_n3arr[i] += phi_n3;
+	grad_n2arr[i] += phi_n2;
+	grad_n1arr[i] += phi_n1;
+	grad_n0arr[i] += phi_n0;
+	return phi;
+}
+
+//Bonding term
+inline double phiBond_calc(int i, double Rhm, double scale,
+	const double *n0arr, const double *n2arr, const double *n3arr, vector3<const double*> n2vArr,
+	double *grad_n0arr, double *grad_n2arr, double *grad_n3arr, vector3<double*> grad_n2vArr)
+{
+	double n0 = n0arr[i];
+	double n2 = n2arr[i];
+	double n3 = n3arr[i];
+	if(n0<0. || n2<0. || n3<0.) return 0.;
+	double pole = 1.0/(1-n3); //The following is derived easily using: d(pole^N)/d(n3) = N pole^(N+1)
+	//Vector correction factor and derivatives:
+	vector3<> n2v = loadVector(n2vArr, i);
+	double n2vsq = n2v.length_squared();
+	double zeta = (n2<=0 || n2vsq>n2*n2) ? 0.0 : (1-n2vsq/(n2*n2));
+	double zeta_n2 = zeta ? 2*n2vsq/(n2*n2*n2) : 0.0;
+	vector3<> zeta_n2v = zeta ? (-2/(n2*n2))*n2v : vector3<>();
+	//Compute the contact correlation function and its derivatives:
+	double gContact      = pole*(1 + zeta * pole*(Rhm*n2 + pole*(2.0/9)*pow(Rhm*n2,2) ));
+	double gContact_n2   = zeta * pow(pole,2)*(Rhm + pole*(4.0/9)*pow(Rhm,2)*n2 );
+	double gContact_n3   = pow(pole,2)*(1 + zeta * pole*(2*Rhm*n2 + pole*(6.0/9)*pow(Rhm*n2,2) ));
+	double gContact_zeta = pow(pole,2) * (Rhm*n2 + pole*(2.0/9)*pow(Rhm*n2,2) );
+	//Compute the bonding corrections and its derivatives:
+	double phi     = -scale*n0*log(gContact);
+	double phi_n0   = -scale*log(gContact);
+	double phi_n2   = -scale*n0*gContact_n2/gContact;
+	double phi_n3   = -scale*n0*gContact_n3/gContact;
+	double phi_zeta = -scale*n0*gContact_zeta/gContact;
+	//Accumulate the gradients and return the answer:
+	grad_n0arr[i] += phi_n0;
+	grad_n2arr[i] += phi_n2 + phi_zeta * zeta_n2;
+	grad_n3arr[i] += phi_n3;
+	accumVector(phi_zeta * zeta_n2v, grad_n2vArr, i);
+	return phi;
+}
+}
+double phiFMT_scalar(int N,
+	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
+	vector3<const double*> n1vArr, vector3<const double*> n2vArr, tensor3<const double*> n2mArr,
+	double *grad_n0arr, double *grad_n1arr, double *grad_n2arr, double *grad_n3arr,
+	vector3<double*> grad_n1vArr, vector3<double*> grad_n2vArr, tensor3<double*> grad_n2mArr)
+{	double phi = 0.;
+	for(int i=0; i<N; i++)
+		phi += Reference::phiFMT_calc(i, n0arr, n1arr, n2arr, n3arr, n1vArr, n2vArr, n2mArr,
+			grad_n0arr, grad_n1arr, grad_n2arr, grad_n3arr, grad_n1vArr, grad_n2vArr, grad_n2mArr);
+	return phi;
+}
+double phiBond_scalar(int N, double Rhm, double scale,
+	const double *n0mol, const double *n2, const double *n3, vector3<const double*> n2vArr,
+	double *grad_n0mol, double *grad_n2, double *grad_n3, vector3<double*> grad_n2vArr)
+{	double phi = 0.;
+	for(int i=0; i<N; i++)
+		phi += Reference::phiBond_calc(i, Rhm, scale, n0mol, n2, n3, n2vArr, grad_n0mol, grad_n2, grad_n3, grad_n2vArr);
+	return phi;
+}
+
+//Weighted densities of a hard sphere fluid with packing fraction eta and random spatial variations:
+struct WeightedDensities
+{	ScalarField n0, n1, n2, n3; VectorField n1v, n2v; TensorField n2m;
+
+	WeightedDensities(const GridInfo& gInfo, double R, double eta)
+	{	double nBulk = eta / (4*M_PI/3*R*R*R);
+		ScalarField r; nullToZero(r, gInfo); initRandomFlat(r);
+		ScalarField n = nBulk * (0.5 + r); //density varying between half and 1.5 times bulk
+		n0 = n; n1 = R*n; n2 = (4*M_PI*R*R)*n; n3 = (4*M_PI/3*R*R*R)*n;
+		n1v = (-0.1*R) * I(gradient(J(n))); n2v = (4*M_PI*R) * n1v;
+		n2m = (0.05*R*R) * I(tensorKernel(J(n)));
+	}
+};
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	const double R = 1.4; //typical hard sphere radius
+	const double eta = 0.38; //packing fraction of water at ambient conditions
+	const int nRepeat = 5;
+
+	for(int S: {64, 96, 128})
+	{	GridInfo gInfo;
+		gInfo.S = vector3<int>(S, S, S);
+		gInfo.R = Diag(0.25 * gInfo.S);
+		gInfo.initialize(true);
+		WeightedDensities w(gInfo, R, eta);
+		logPrintf("\n---------- Grid: %d^3 ----------\n", S);
+
+		//FMT kernel:
+		ScalarField grad_n0, grad_n1, grad_n2, grad_n3; VectorField grad_n1v, grad_n2v; TensorField grad_n2m;
+		ScalarField phiArr; nullToZero(phiArr, gInfo);
+		#define FMT_ARGS(grad) \
+			w.n0->data(), w.n1->data(), w.n2->data(), w.n3->data(), w.n1v.const_data(), w.n2v.const_data(), w.n2m.const_data(), \
+			grad##_n0->data(), grad##_n1->data(), grad##_n2->data(), grad##_n3->data(), grad##_n1v.data(), grad##_n2v.data(), grad##_n2m.data()
+		double phiRef = 0., phiNew = 0.;
+		ScalarField ref_n0, ref_n1, ref_n2, ref_n3; VectorField ref_n1v, ref_n2v; TensorField ref_n2m;
+		#define ZERO_GRADS(grad) \
+			grad##_n0=0; grad##_n1=0; grad##_n2=0; grad##_n3=0; grad##_n1v=VectorField(); grad##_n2v=VectorField(); grad##_n2m=TensorField(); \
+			nullToZero(grad##_n0, gInfo); nullToZero(grad##_n1, gInfo); nullToZero(grad##_n2, gInfo); nullToZero(grad##_n3, gInfo); \
+			nullToZero(grad##_n1v, gInfo); nullToZero(grad##_n2v, gInfo); nullToZero(grad##_n2m, gInfo);
+		TIME("\tphiFMT (scalar, 1 thread)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+			{	ZERO_GRADS(ref)
+				phiRef = phiFMT_scalar(gInfo.nr, FMT_ARGS(ref));
+			}
+		)
+		TIME("\tphiFMT (vectorized, 1 thread)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+			{	ZERO_GRADS(grad)
+				suspendOperatorThreading();
+				phiFMT(gInfo.nr, phiArr->data(), FMT_ARGS(grad));
+				resumeOperatorThreading();
+				phiNew = sum(phiArr);
+			}
+		)
+		TIME("\tphiFMT (vectorized, all threads)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+			{	ZERO_GRADS(grad)
+				phiFMT(gInfo.nr, phiArr->data(), FMT_ARGS(grad));
+				phiNew = sum(phiArr);
+			}
+		)
+		logPrintf("\tphiFMT relative error: %le  gradient relative error: %le\n", fabs(phiNew/phiRef-1.),
+			sqrt(dot(grad_n3-ref_n3, grad_n3-ref_n3) / dot(ref_n3, ref_n3)));
+		#undef FMT_ARGS
+		#undef ZERO_GRADS
+
+		//Bonding kernel:
+		ScalarField n0mol = 0.5*w.n0;
+		#define BOND_ARGS(grad) \
+			n0mol->data(), w.n2->data(), w.n3->data(), w.n2v.const_data(), \
+			grad##_n0->data(), grad##_n2->data(), grad##_n3->data(), grad##_n2v.data()
+		#define ZERO_GRADS(grad) \
+			grad##_n0=0; grad##_n2=0; grad##_n3=0; grad##_n2v=VectorField(); \
+			nullToZero(grad##_n0, gInfo); nullToZero(grad##_n2, gInfo); nullToZero(grad##_n3, gInfo); nullToZero(grad##_n2v, gInfo);
+		const double Rhm = 0.5*R, scale = 0.5;
+		TIME("\tphiBond (scalar, 1 thread)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+			{	ZERO_GRADS(ref)
+				phiRef = phiBond_scalar(gInfo.nr, Rhm, scale, BOND_ARGS(ref));
+			}
+		)
+		TIME("\tphiBond (vectorized, 1 thread)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+			{	ZERO_GRADS(grad)
+				suspendOperatorThreading();
+				phiBond(gInfo.nr, Rhm, scale, phiArr->data(), BOND_ARGS(grad));
+				resumeOperatorThreading();
+				phiNew = sum(phiArr);
+			}
+		)
+		TIME("\tphiBond (vectorized, all threads)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+			{	ZERO_GRADS(grad)
+				phiBond(gInfo.nr, Rhm, scale, phiArr->data(), BOND_ARGS(grad));
+				phiNew = sum(phiArr);
+			}
+		)
+		logPrintf("\tphiBond relative error: %le  gradient relative error: %le\n", fabs(phiNew/phiRef-1.),
+			sqrt(dot(grad_n3-ref_n3, grad_n3-ref_n3) / dot(ref_n3, ref_n3)));
+		#undef BOND_ARGS
+		#undef ZERO_GRADS
+
+		//Complete functional including the Fourier-space processing of weighted densities:
+		ScalarFieldTilde n3tilde = J(w.n3), n1vTilde = J(w.n1), n2mTilde = J(w.n2);
+		ScalarField g0, g1, g2; ScalarFieldTilde g3tilde, g1vTilde, g2mTilde;
+		TIME("\tPhiFMT (complete)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+				PhiFMT(w.n0, w.n1, w.n2, n3tilde, n1vTilde, n2mTilde, g0, g1, g2, g3tilde, g1vTilde, g2mTilde);
+		)
+		TIME("\tPhiBond (complete)", globalLog,
+			for(int iRep=0; iRep<nRepeat; iRep++)
+				PhiBond(Rhm, scale, n0mol, w.n2, n3tilde, g0, g2, g3tilde);
+		)
+	}
+
+	finalizeSystem();
+	return 0;
+}
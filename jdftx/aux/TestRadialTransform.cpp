@@ -0,0 +1,77 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+//Benchmark of the log-grid FFT (FFTLog) spherical Bessel transform against the direct sum,
+//on all the radial functions of the pseudopotentials specified in a regular input file
+
+#include <core/Util.h>
+#include <commands/parser.h>
+#include <electronic/Everything.h>
+#include <electronic/SpeciesInfo.h>
+#include <electronic/ColumnBundle.h>
+
+int main(int argc, char** argv)
+{	//Parse command line, initialize system and logs:
+	Everything e; //the parent data structure for, well, everything
+	InitParams ip("Benchmark fast (FFTLog) vs direct spherical Bessel transforms of pseudopotentials.", &e);
+	initSystemCmdline(argc, argv, ip);
+	logSuspend(); e.elecMinParams.fpLog = nullLog;
+	parse(readInputFile(ip.inputFilename), e, ip.printDefaults);
+	e.setup();
+	logResume(); e.elecMinParams.fpLog = globalLog;
+
+	double tFFTLogTot = 0., tDirectTot = 0.;
+	for(const auto& sp: e.iInfo.species)
+	{	logPrintf("\n---------- Species: %s ----------\n", sp->name.c_str());
+		double tFFTLog = 0., tDirect = 0., errMax = 0.;
+		int nFuncs = 0, nFallback = 0;
+		for(const auto& entry: sp->getRadialFunctions())
+		{	int l = entry.first;
+			const RadialFunctionG& func = *(entry.second);
+			double dG = 1./func.dGinv;
+			int nGrid = func.nCoeff - 4; //number of samples that the spline was initialized from
+			std::vector<double> fTildeFFTLog, fTildeDirect;
+			double t0 = clock_us();
+			bool success = func.rFunc->transformFFTLog(l, dG, nGrid, fTildeFFTLog);
+			double t1 = clock_us();
+			func.rFunc->transformDirect(l, dG, nGrid, fTildeDirect);
+			double t2 = clock_us();
+			tFFTLog += 1e-3*(t1-t0);
+			tDirect += 1e-3*(t2-t1);
+			nFuncs++;
+			if(!success) { nFallback++; continue; }
+			double diffMax = 0., fMax = 0.;
+			for(int iG=0; iG<nGrid; iG++)
+			{	diffMax = std::max(diffMax, fabs(fTildeFFTLog[iG] - fTildeDirect[iG]));
+				fMax = std::max(fMax, fabs(fTildeDirect[iG]));
+			}
+			if(fMax) errMax = std::max(errMax, diffMax/fMax);
+		}
+		logPrintf("\t%d radial functions (%d not applicable to FFTLog)\n", nFuncs, nFallback);
+		logPrintf("\tFFTLog: %9.3lf ms   Direct: %9.3lf ms   Speedup: %.1lfx\n", tFFTLog, tDirect, tDirect/tFFTLog);
+		logPrintf("\tMax relative difference (FFTLog - Direct): %le\n", errMax);
+		tFFTLogTot += tFFTLog;
+		tDirectTot += tDirect;
+	}
+	logPrintf("\nTotal:  FFTLog: %9.3lf ms   Direct: %9.3lf ms   Speedup: %.1lfx\n", tFFTLogTot, tDirectTot, tDirectTot/tFFTLogTot);
+	logPrintf("(Note that the direct sum is itself inaccurate at large G on coarse logarithmic grids.)\n");
+
+	finalizeSystem();
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+//Micro-benchmarks of the core computational kernels, on the system specified in a regular input file.
+//Results are printed to the log, and written as records of type "bench" to the metrics stream (see core/Metrics.h).
+
+#include <core/Util.h>
+#include <core/Metrics.h>
+#include <core/Operators.h>
+#include <core/ScalarFieldIO.h>
+#include <core/Pulay.h>
+#include <commands/parser.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <electronic/SpeciesInfo.h>
+#include <fluid/PCM_internal.h>
+#include <cfloat>
+
+//Time func (after an untimed warm-up call) by repeating it for at least tTarget seconds (and at least 3 times),
+//and report the best and mean times per call (divided by nInner, if func performs nInner iterations of the kernel)
+template<typename Func> void bench(const char* name, size_t size, const Func& func, int nInner=1, double tTarget=0.5)
+{	func();
+	double tMin = DBL_MAX, tSum = 0.;
+	int nCalls = 0;
+	bool done = false;
+	while(!done)
+	{	double tStart = clock_us();
+		func();
+		double t = clock_us() - tStart;
+		tMin = std::min(tMin, t);
+		tSum += t;
+		nCalls++;
+		done = (nCalls >= 3) && (tSum >= tTarget*1e6);
+		mpiWorld->bcast(done); //keep repetitions in sync for kernels with collectives
+	}
+	tMin *= 1e-6/nInner;
+	double tMean = tSum * 1e-6/(nInner*nCalls);
+	logPrintf("%20s  size: %10lu  calls: %5d  tMin[ms]: %10.3lf  tMean[ms]: %10.3lf\n", name, size, nCalls*nInner, 1e3*tMin, 1e3*tMean);
+	logFlush();
+	Metrics::Record("bench").add("suite", "micro").add("name", name).add("size", double(size))
+		.add("nThreads", nProcsAvailable).add("nProcesses", mpiWorld->nProcesses())
+		.add("nCalls", nCalls*nInner).add("tMin", tMin).add("tMean", tMean).emit(mpiWorld);
+}
+
+//Pulay mixing of a reciprocal-space scalar field, with an update driven by a source that changes every cycle
+//(so that it never converges, and every cycle mixes the full history)
+class PulayBench : public Pulay<ScalarFieldTilde>
+{	const GridInfo& gInfo;
+	ScalarFieldTilde x, source;
+	int iCycle;
+public:
+	PulayBench(const GridInfo& gInfo, const PulayParams& pp) : Pulay<ScalarFieldTilde>(pp), gInfo(gInfo), iCycle(0)
+	{	nullToZero(x, gInfo);
+		ScalarField r(ScalarFieldData::alloc(gInfo)); initRandom(r);
+		source = J(r);
+	}
+protected:
+	double cycle(double dEprev, std::vector<double>& extraValues)
+	{	x *= 0.5;
+		::axpy(cos(0.1*(iCycle++)), source, x);
+		return ::dot(x, x);
+	}
+	void axpy(double alpha, const ScalarFieldTilde& X, ScalarFieldTilde& Y) const { ::axpy(alpha, X, Y); }
+	double dot(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const { return ::dot(X, Y); }
+	size_t variableSize() const { return gInfo.nG * sizeof(complex); }
+	void readVariable(ScalarFieldTilde& X, FILE* fp) const { nullToZero(X, gInfo); loadRawBinary(X, fp); }
+	void writeVariable(const ScalarFieldTilde& X, FILE* fp) const { saveRawBinary(X, fp); }
+	ScalarFieldTilde getVariable() const { return clone(x); }
+	void setVariable(const ScalarFieldTilde& X) { x = clone(X); }
+	ScalarFieldTilde precondition(const ScalarFieldTilde& X) const { return 0.5*X; }
+	ScalarFieldTilde applyMetric(const ScalarFieldTilde& X) const { return clone(X); }
+};
+
+int main(int argc, char** argv)
+{	//Parse command line, initialize system and logs:
+	Everything e; //the parent data structure for, well, everything
+	InitParams ip("Micro-benchmarks of the core computational kernels on the system specified in an input file.", &e);
+	initSystemCmdline(argc, argv, ip);
+	logSuspend(); e.elecMinParams.fpLog = nullLog;
+	parse(readInputFile(ip.inputFilename), e, ip.printDefaults);
+	e.setup();
+	logResume(); e.elecMinParams.fpLog = globalLog;
+	if(mpiWorld->nProcesses() > e.eInfo.nStates)
+		die("KernelBench requires at least one k-point / spin state per process.\n");
+
+	//Inputs for the benchmarks:
+	const GridInfo& gInfo = e.gInfo;
+	int q = e.eInfo.qStart;
+	const ColumnBundle& C = e.eVars.C[q];
+	const diagMatrix& F = e.eVars.F[q];
+	ScalarFieldArray n = e.eVars.calcDensity();
+	ScalarField nTot = n.size()==1 ? n[0] : n[0]+n[1];
+	ScalarFieldTilde nTilde = J(nTot);
+	complexScalarField z = Complex(nTot);
+	complexScalarFieldTilde zTilde = J(z);
+	logPrintf("\nBenchmarking kernels on %d x %d x %d grid with %d bands of %lu basis functions, using %d threads:\n",
+		gInfo.S[0], gInfo.S[1], gInfo.S[2], C.nCols(), C.colLength(), nProcsAvailable);
+
+	//Fourier transforms:
+	bench("I(real)", gInfo.nr, [&]() { I(nTilde); });
+	bench("J(real)", gInfo.nr, [&]() { J(nTot); });
+	bench("I(complex)", gInfo.nr, [&]() { I(zTilde); });
+	bench("J(complex)", gInfo.nr, [&]() { J(z); });
+
+	//Wavefunction operations:
+	bench("Idag_DiagV_I", C.nData(), [&]() { Idag_DiagV_I(C, n); });
+	bench("diagouterI", C.nData(), [&]() { diagouterI(F, C, e.eInfo.nDensities, &gInfo); });
+	matrix CdagC = C^C;
+	bench("operator^", C.nData(), [&]() { C^C; });
+	bench("Y*M", C.nData(), [&]() { ColumnBundle CU = C * CdagC; });
+
+	//Nonlocal projectors (with caching disabled, so that they are recomputed on each call):
+	e.cntrl.cacheProjectors = false;
+	size_t nProjTot = 0;
+	for(const auto& sp: e.iInfo.species) nProjTot += sp->nProjectors();
+	bench("getV", nProjTot*C.colLength(), [&]() { for(const auto& sp: e.iInfo.species) sp->getV(C); });
+
+	//Exchange-correlation:
+	ScalarFieldArray tau;
+	if(e.exCorr.needsKEdensity()) tau = e.eVars.KEdensity();
+	bench("ExCorr", gInfo.nr, [&]() { ScalarFieldArray Vxc; e.exCorr(n, &Vxc, IncludeTXC(), tau.size() ? &tau : 0); });
+
+	//PCM cavity shape function (with typical LinearPCM parameters for water):
+	bench("PCMshape", gInfo.nr, [&]() { ScalarField shape; ShapeFunction::compute(nTot, shape, 7e-4, 0.6); });
+
+	//Pulay mixing (per cycle, with full history):
+	PulayParams pp;
+	pp.fpLog = nullLog;
+	pp.nIterations = 20;
+	pp.energyDiffThreshold = 0.;
+	pp.residualThreshold = 0.;
+	bench("PulayMix", gInfo.nG, [&]() { PulayBench(gInfo, pp).minimize(); }, pp.nIterations);
+
+	finalizeSystem();
+	return 0;
+}
@@ -0,0 +1,103 @@
+#!/bin/bash
+#Run the performance benchmarks (see README) and collect the results in results.jsonl in the run directory,
+#as one JSON object per line with "type":"bench", "suite":"micro" or "macro", the benchmark parameters and timings.
+#Usage: runBench.sh <benchSrcDir> <benchRunDir> <jdftxBuildDir> <KernelBench executable>
+
+benchSrcDir="$1"
+benchRunDir="$2"
+jdftxBuildDir="$3"
+kernelBench="$4"
+
+mkdir -p $benchRunDir
+cd $benchRunDir
+resultsFile="results.jsonl"
+rm -f $resultsFile
+
+#Launch command and thread counts:
+if [[ "$JDFTX_LAUNCH" == *'%d'* ]]; then
+	LAUNCH="$(printf "$JDFTX_LAUNCH" "${JDFTX_BENCH_NPROCS:-1}")"
+else
+	LAUNCH="$JDFTX_LAUNCH"
+fi
+nCores="$(getconf _NPROCESSORS_ONLN)"
+if [ -z "$JDFTX_BENCH_THREADS" ]; then
+	for (( n=1; n<nCores; n*=2 )); do
+		JDFTX_BENCH_THREADS="$JDFTX_BENCH_THREADS $n"
+	done
+	JDFTX_BENCH_THREADS="$JDFTX_BENCH_THREADS $nCores"
+fi
+export NITER="${JDFTX_BENCH_NITER:-10}"
+echo "launch=\"$LAUNCH\"  threads=\"$JDFTX_BENCH_THREADS\"  NITER=$NITER"
+
+#Summarize a metrics stream of a jdftx run as additional JSON fields
+function summarizeMetrics()
+{	awk '
+		function value(key) #numeric value of key in current line (or null if absent)
+		{	if(match($0, "\"" key "\":[-+0-9.eE]+")) return substr($0, RSTART+length(key)+3, RLENGTH-length(key)-3);
+			return "null";
+		}
+		/"type":"start"/ { nProcesses = value("nProcesses"); }
+		/"type":"stage"/ && /"name":"setup"/ { tSetup = value("dt"); }
+		/"type":"SCF"/ {
+			t = value("t");
+			if(!nIter) tFirst = t;
+			tLast = t; nIter++;
+			imbalance = value("imbalance");
+			if(imbalance != "null") { imbalanceSum += imbalance; nImbalance++; }
+		}
+		/"type":"end"/ {
+			tTotal = value("t");
+			successful = ($0 ~ /"successful":true/) ? "true" : "false";
+			if(match($0, /"Total":\{"current":[0-9]+,"peak":[0-9]+/))
+			{	memPeak = substr($0, RSTART, RLENGTH);
+				sub(/.*"peak":/, "", memPeak);
+			}
+			memPeakMax = value("memPeakMax");
+		}
+		END {
+			printf(",\"nProcesses\":%s,\"successful\":%s,\"tTotal\":%s,\"tSetup\":%s,\"nIter\":%d,\"tIter\":%s,\"imbalance\":%s,\"memPeak\":%s,\"memPeakMax\":%s",
+				nProcesses ? nProcesses : "null", successful ? successful : "false", tTotal ? tTotal : "null", tSetup ? tSetup : "null", nIter,
+				(nIter>1 ? (tLast-tFirst)/(nIter-1) : "null"), (nImbalance ? imbalanceSum/nImbalance : "null"),
+				memPeak ? memPeak : "null", memPeakMax ? memPeakMax : "null");
+		}
+	' $1
+}
+
+#Micro-benchmarks (for each thread count):
+if [ -z "$JDFTX_BENCH_FILTER" ]; then
+	for nThreads in $JDFTX_BENCH_THREADS; do
+		echo "Running kernel micro-benchmarks with $nThreads threads ..."
+		rm -f kernels_c$nThreads.metrics
+		JDFTX_METRICS=kernels_c$nThreads.metrics $LAUNCH $kernelBench -i $benchSrcDir/kernels.in -c $nThreads -o kernels_c$nThreads.out
+		grep '"type":"bench"' kernels_c$nThreads.metrics >> $resultsFile
+	done
+fi
+
+#Macro-benchmarks:
+grep -v '^#' $benchSrcDir/macro/configs | while read system s0 s1 s2 k0 k1 k2 threadMode; do
+	if [ -z "$system" ]; then continue; fi
+	if [ -n "$JDFTX_BENCH_FILTER" ] && [[ ! "$system" =~ $JDFTX_BENCH_FILTER ]]; then continue; fi
+	#Generate supercell ions:
+	awk -v s0=$s0 -v s1=$s1 -v s2=$s2 '
+		$1 == "ion" {
+			for(i0=0; i0<s0; i0++) for(i1=0; i1<s1; i1++) for(i2=0; i2<s2; i2++)
+			{	printf("ion %s %.9f %.9f %.9f", $2, ($3+i0)/s0, ($4+i1)/s1, ($5+i2)/s2);
+				for(j=6; j<=NF; j++) printf(" %s", $j);
+				printf("\n");
+			}
+		}' $benchSrcDir/macro/$system.ions > ions.in
+	nAtoms="$(grep -c '^ion ' ions.in)"
+	export SUPERCELL="$s0 $s1 $s2"
+	export KFOLD="$k0 $k1 $k2"
+	if [ "$threadMode" == "scan" ]; then threadList="$JDFTX_BENCH_THREADS"; else threadList="$nCores"; fi
+	for nThreads in $threadList; do
+		runName="${system}_${s0}${s1}${s2}_k${k0}x${k1}x${k2}_c${nThreads}"
+		echo "Running $runName ..."
+		rm -f $runName.metrics
+		JDFTX_METRICS=$runName.metrics $LAUNCH $jdftxBuildDir/jdftx$JDFTX_SUFFIX -i $benchSrcDir/macro/$system.in -c $nThreads -o $runName.out
+		printf '{"type":"bench","suite":"macro","name":"%s","supercell":[%d,%d,%d],"kpointFolding":[%d,%d,%d],"nAtoms":%d,"nThreads":%d,"nIterRequested":%d%s}\n' \
+			$system $s0 $s1 $s2 $k0 $k1 $k2 $nAtoms $nThreads $NITER "$(summarizeMetrics $runName.metrics)" >> $resultsFile
+	done
+done
+
+echo "Results written to $benchRunDir/$resultsFile"
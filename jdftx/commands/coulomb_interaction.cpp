@@ -133,6 +133,7 @@ struct CommandCoulombTruncationEmbed : public Command
 		//Dependencies due to coordinate system option:
 		require("latt-scale");
 		require("coords-type");
+		forbid("ewald-spme");
 	}
 
 	void process(ParamList& pl, Everything& e)
@@ -181,6 +182,40 @@ struct CommandCoulombTruncationIonMargin : public Command
 commandCoulombTruncationIonMargin;
 
 
+struct CommandEwaldSpme : public Command
+{
+	CommandEwaldSpme() : Command("ewald-spme", "jdftx/Coulomb interactions")
+	{
+		format = "[<order>=8]";
+		comments =
+			"Use the smooth particle-mesh Ewald method \\cite SPME for the ion-ion interaction,\n"
+			"with B-splines of even <order> between 4 and 12, instead of the exact Ewald sum.\n"
+			"This scales as O(N log N) instead of O(N^{3/2}) with the number of atoms N,\n"
+			"and is worthwhile only for very large unit cells (thousands of atoms).\n"
+			"The error relative to the exact sum is reported for the first evaluation;\n"
+			"increase <order> if it is too large. Supported only for Periodic and Slab\n"
+			"geometries (see command coulomb-interaction), without coulomb-truncation-embed.\n"
+			"Lattice derivatives for the stress tensor are always computed using the exact Ewald sum.";
+		
+		require("coulomb-interaction");
+		forbid("coulomb-truncation-embed"); //kernel would need to be sampled on the embedding grid
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.coulombParams.spmeOrder, 8, "order");
+		if(e.coulombParams.spmeOrder<4 || e.coulombParams.spmeOrder>12 || e.coulombParams.spmeOrder%2)
+			throw string("<order> must be even and between 4 and 12");
+		if(e.coulombParams.geometry!=CoulombParams::Periodic && e.coulombParams.geometry!=CoulombParams::Slab)
+			throw string("ewald-spme is supported only for Periodic and Slab geometries");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.coulombParams.spmeOrder);
+	}
+}
+commandEwaldSpme;
+
+
 struct CommandExchangeRegularization : public Command
 {
 	CommandExchangeRegularization() : Command("exchange-regularization", "jdftx/Coulomb interactions")
@@ -446,7 +446,8 @@ struct CommandPolarizabilityKdiff : public Command
 			"\n"
 			"<dkFilenamePattern> may be specified to read offset band structure calcualations when <dk>\n"
 			"does not belong to the k-point mesh. This string should be a filename pattern containing\n"
-			"$VAR (to be replaced by eigenvals and wfns) and $q (to be replaced by state index)";
+			"$VAR (to be replaced by eigenvals and wfns) and $q (to be replaced by state index).\n"
+			"Single-precision wavefunctions (wfnsSingle, see dump-wfns-single-precision) are used if wfns is absent.";
 		
 		require("polarizability");
 	}
@@ -869,3 +870,98 @@ struct CommandPotentialSubtraction : public Command
 	}
 }
 commandPotentialSubtraction;
+
+struct CommandDumpWfnsSinglePrecision : public Command
+{
+	CommandDumpWfnsSinglePrecision() : Command("dump-wfns-single-precision", "jdftx/Output")
+	{	format = "yes|no";
+		comments = 
+			"Whether to write wavefunctions (dumped as part of State) in single precision.\n"
+			"This halves the size of wavefunction checkpoints, at the cost of truncating\n"
+			"them to a relative precision ~ 1e-7, which is sufficient for restarting\n"
+			"calculations but not for post-processing that requires exact wavefunctions.\n"
+			"Single-precision wavefunctions are dumped with variable name wfnsSingle (instead of wfns),\n"
+			"which initial-state picks up automatically; with wavefunction read, specify <precision> = single.\n"
+			"Either way, basis and band conversions work as for double-precision files.";
+		hasDefault = true;
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.dump.wfnsSinglePrecision, false, boolMap, "yes|no");
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(e.dump.wfnsSinglePrecision));
+	}
+}
+commandDumpWfnsSinglePrecision;
+
+enum WfnsCompression { WfnsCompressNone, WfnsCompressZlib };
+EnumStringMap<WfnsCompression> wfnsCompressionMap
+(	WfnsCompressNone, "none",
+	WfnsCompressZlib, "zlib"
+);
+
+struct CommandDumpWfnsChunked : public Command
+{
+	CommandDumpWfnsChunked() : Command("dump-wfns-chunked", "jdftx/Output")
+	{	format = "yes|no [<compression>=none]";
+		comments = 
+			"Whether to write wavefunctions (dumped as part of State) as a chunked, self-describing\n"
+			"checkpoint with variable name wfnsChunked (instead of wfns or wfnsSingle).\n"
+			"The file starts with a versioned header listing the k-point, spin and basis size\n"
+			"of each state and a table of band-block chunks, so that mismatched restarts are\n"
+			"reported precisely instead of by file length alone. The data is stored in double\n"
+			"or single precision (following dump-wfns-single-precision), and optionally\n"
+			"compressed with <compression> = zlib (which requires a build with EnableZlib).\n"
+			"\n"
+			"initial-state picks up wfnsChunked if neither wfns nor wfnsSingle exist, and\n"
+			"wavefunction read detects the format from the header (ignoring <precision>);\n"
+			"basis and band conversions work as for raw files. The raw wfns format and all\n"
+			"its external readers are unaffected when this option is off (default).";
+		hasDefault = true;
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.dump.wfnsChunked, false, boolMap, "yes|no");
+		WfnsCompression compression;
+		pl.get(compression, WfnsCompressNone, wfnsCompressionMap, "compression");
+		e.dump.wfnsCompress = (compression == WfnsCompressZlib);
+		#ifndef ZLIB_ENABLED
+		if(e.dump.wfnsCompress)
+			throw string("<compression> = zlib requires a build with EnableZlib");
+		#endif
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %s", boolMap.getString(e.dump.wfnsChunked),
+			wfnsCompressionMap.getString(e.dump.wfnsCompress ? WfnsCompressZlib : WfnsCompressNone));
+	}
+}
+commandDumpWfnsChunked;
+
+struct CommandDumpFieldsHDF5 : public Command
+{
+	CommandDumpFieldsHDF5() : Command("dump-fields-hdf5", "jdftx/Output")
+	{	format = "yes|no";
+		comments = 
+			"Whether to write scalar fields (densities, potentials etc.) in HDF5 format,\n"
+			"instead of raw binary. Each field is written to <filename>.h5 as a 3D dataset\n"
+			"'data' of dimensions equal to the FFT box (with lattice vectors in 'R'),\n"
+			"chunked by planes along the first lattice direction so that post-processing\n"
+			"tools can efficiently read subsets of the grid. Requires HDF5 support.";
+		hasDefault = true;
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.dump.fieldsHDF5, false, boolMap, "yes|no");
+		#ifndef HDF5_ENABLED
+		if(e.dump.fieldsHDF5) throw string("dump-fields-hdf5 requires a build with EnableHDF5");
+		#endif
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(e.dump.fieldsHDF5));
+	}
+}
+commandDumpFieldsHDF5;
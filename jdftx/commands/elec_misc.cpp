@@ -300,6 +300,40 @@ commandCacheProjectors;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandMemoryBudget : public Command
+{
+	CommandMemoryBudget() : Command("memory-budget", "jdftx/Miscellaneous")
+	{
+		format = "<budget>";
+		comments =
+			"Memory budget per process in GB. The peak memory per process is always estimated\n"
+			"during setup (by the categories of the memory usage report); if it exceeds <budget>,\n"
+			"the following memory-saving options are selected in turn until the estimate fits:\n"
+			"+ historyOnDisk in command electronic-scf (if SCF)\n"
+			"+ exact exchange evaluated one band at a time (if hybrid functional)\n"
+			"+ davidson-band-ratio 1 (if Davidson eigenvalue algorithm)\n"
+			"+ history 3 in command electronic-minimize (if L-BFGS)\n"
+			"+ cache-projectors no\n"
+			"\n"
+			"The actual peak usage by category is compared to the estimate at the end of the run.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	double budgetGB;
+		pl.get(budgetGB, 0., "budget", true);
+		if(budgetGB <= 0.) throw string("<budget> must be positive");
+		e.memoryPlan.budget = budgetGB * pow(1024.,3);
+		ManagedMemoryBase::enableUsageTracking(); //before any setup allocations, to compare with the estimate at the end
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%lg", e.memoryPlan.budget / pow(1024.,3));
+	}
+}
+commandMemoryBudget;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandBasis : public Command
 {
 	CommandBasis() : Command("basis", "jdftx/Electronic/Parameters")
@@ -29,6 +29,8 @@ struct CommandInitialState : public Command
 		comments = "Initialize state from a filename pattern which contains a $VAR,\n"
 			"equivalent to invoking the following commands:\n"
 			"+ wavefunction          read  <filename-pattern>/$VAR/wfns\n"
+			"  (or <filename-pattern>/$VAR/wfnsSingle with precision single, if only that exists,\n"
+			"   or else <filename-pattern>/$VAR/wfnsChunked, see dump-wfns-chunked)\n"
 			"+ elec-initial-fillings read  <filename-pattern>/$VAR/fillings\n"
 			"+ elec-initial-Haux           <filename-pattern>/$VAR/Haux\n"
 			"+ fluid-initial-state         <filename-pattern>/$VAR/fluidState\n"
@@ -69,6 +71,12 @@ void setAvailableFilenames(string filenamePattern, Everything& e)
 {	if(filenamePattern.find("$VAR")==string::npos)
 		throw "<filename-pattern> = " + filenamePattern + " doesn't contain '$VAR'";
 	setAvailableFilename(filenamePattern, "wfns", e.eVars.wfnsFilename);
+	if(!e.eVars.wfnsFilename.length())
+	{	setAvailableFilename(filenamePattern, "wfnsSingle", e.eVars.wfnsFilename); //single-precision checkpoint
+		e.eVars.wfnsSinglePrecision = e.eVars.wfnsFilename.length();
+	}
+	if(!e.eVars.wfnsFilename.length())
+		setAvailableFilename(filenamePattern, "wfnsChunked", e.eVars.wfnsFilename); //chunked checkpoint (format detected on read)
 	setAvailableFilename(filenamePattern, "fillings", e.eInfo.initialFillingsFilename);
 	if(!e.eInfo.initialFillingsFilename.length())
 		setAvailableFilename(filenamePattern, "fill", e.eInfo.initialFillingsFilename); //alternate naming convention
@@ -89,6 +97,10 @@ EnumStringMap<WfnsInit> wfnsInitMap(
 	WfnsRead, "read",
 	WfnsReadRS, "read-rs" );
 
+EnumStringMap<bool> wfnsPrecisionMap(
+	false, "double",
+	true, "single" );
+
 struct CommandWavefunction : public Command
 {
 	CommandWavefunction() : Command("wavefunction", "jdftx/Initialization")
@@ -96,7 +108,7 @@ struct CommandWavefunction : public Command
 		format =
 			"lcao\n"
 			"           | random\n"
-			"           | read <filename> [<nBandsOld>] [<EcutOld>]\n"
+			"           | read <filename> [<nBandsOld>] [<EcutOld>] [<precision>=" + wfnsPrecisionMap.optionList() + "]\n"
 			"           | read-rs <filename-pattern> [<nBandsOld>] [<NxOld>] [<NyOld>] [<NzOld>]";
 		comments =
 			"Wavefunction initialization: use atomic orbitals (default), randomize or read from files:\n"
@@ -112,6 +124,9 @@ struct CommandWavefunction : public Command
 			"+ <EcutOld> can be used to specify a wavefunction with different planewave cutoff.\n"
 			"   The wavefunction will be appropriately up/down-sampled in Fourier space.\n"
 			"   Default: 0.0 => old and current Ecut must match exactly.\n"
+			"+ <precision> = single reads a single-precision checkpoint (see dump-wfns-single-precision).\n"
+			"   Default: double. Chunked checkpoints (see dump-wfns-chunked) are detected from their\n"
+			"   header instead, and <precision> is ignored for those.\n"
 			"+ <N*old> specify fftbox dimensions of the input data when reading real-space wavefunctions.\n"
 			"   The wavefunction will be appropriately up/down-sampled in Fourier space.\n"
 			"   Default: 0 => old and current fftbox must match exactly.";
@@ -136,6 +151,7 @@ struct CommandWavefunction : public Command
 				conversion-> realSpace = false;
 				pl.get(conversion->nBandsOld, -1, "nBandsOld");
 				pl.get(conversion->EcutOld, 0.0, "EcutOld");
+				pl.get(e.eVars.wfnsSinglePrecision, false, wfnsPrecisionMap, "precision");
 				if(conversion->nBandsOld>=0) e.eVars.readConversion = conversion;
 				break;
 			}
@@ -156,11 +172,14 @@ struct CommandWavefunction : public Command
 	void printStatus(Everything& e, int iRep)
 	{	if(!e.eVars.wfnsFilename.length())
 			logPrintf(e.eVars.initLCAO ? "lcao" : "random");
-		else if(!e.eVars.readConversion)
+		else if(!e.eVars.readConversion && !e.eVars.wfnsSinglePrecision)
 			logPrintf("read %s", e.eVars.wfnsFilename.c_str());
+		else if(!e.eVars.readConversion)
+			logPrintf("read %s -1 0 %s", e.eVars.wfnsFilename.c_str(), wfnsPrecisionMap.getString(true));
 		else if(!e.eVars.readConversion->realSpace)
-			logPrintf("read %s %d %lf", e.eVars.wfnsFilename.c_str(),
-				e.eVars.readConversion->nBandsOld, e.eVars.readConversion->EcutOld);
+			logPrintf("read %s %d %lf %s", e.eVars.wfnsFilename.c_str(),
+				e.eVars.readConversion->nBandsOld, e.eVars.readConversion->EcutOld,
+				wfnsPrecisionMap.getString(e.eVars.wfnsSinglePrecision));
 		else
 			logPrintf("read-rs %s %d %d %d %d", e.eVars.wfnsFilename.c_str(), e.eVars.readConversion->nBandsOld,
 				e.eVars.readConversion->S_old[0], e.eVars.readConversion->S_old[1], e.eVars.readConversion->S_old[2]);
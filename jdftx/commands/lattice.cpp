@@ -230,6 +230,38 @@ struct CommandLattMoveScale : public Command
 }
 commandLattMoveScale;
 
+
+struct CommandStressMethod : public Command
+{
+	CommandStressMethod() : Command("stress-method", "jdftx/Ionic/Optimization")
+	{
+		format = "<method>=" + stressMethodMap.optionList();
+		comments = "Method for computing the stress tensor (for lattice-minimize and dump Stress):\n"
+			"+ Auto: analytic stress when supported, and finite differences of the energy\n"
+			"  along each allowed strain otherwise (default).\n"
+			"+ FiniteDifference: always use finite differences.\n"
+			"+ Check: compute both, print them along with their maximum deviation,\n"
+			"  and proceed with the analytic stress.\n"
+			"\n"
+			"Analytic stress is currently supported for 3D-periodic calculations with\n"
+			"norm-conserving pseudopotentials (including partial cores), collinear spin,\n"
+			"LDA/GGA functionals, DFT-D2 corrections and smearing, on the CPU.\n"
+			"All other calculations (ultrasoft pseudopotentials, meta-GGAs, exact exchange,\n"
+			"DFT+U, spin-orbit / noncollinear spin, truncated or embedded Coulomb interactions,\n"
+			"fluids, external potentials and GPU runs) still use finite differences.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.stressMethod, StressAuto, stressMethodMap, "method");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	fputs(stressMethodMap.getString(e.cntrl.stressMethod), globalLog);
+	}
+}
+commandStressMethod;
+
 EnumStringMap<CoordsType> coordsMap(
 	CoordsLattice, "Lattice",
 	CoordsCartesian, "Cartesian" );
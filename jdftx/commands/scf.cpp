@@ -28,7 +28,8 @@ enum PulayParamsMember
 	PPM_residualThreshold,
 	PPM_mixFraction,
 	PPM_qMetric,
-	PPM_history
+	PPM_history,
+	PPM_historyOnDisk
 };
 
 EnumStringMap<PulayParamsMember> pulayParamsMap
@@ -37,7 +38,8 @@ EnumStringMap<PulayParamsMember> pulayParamsMap
 	PPM_residualThreshold, "residualThreshold",
 	PPM_mixFraction, "mixFraction",
 	PPM_qMetric, "qMetric",
-	PPM_history, "history"
+	PPM_history, "history",
+	PPM_historyOnDisk, "historyOnDisk"
 );
 
 EnumStringMap<PulayParamsMember> pulayParamsDescMap
@@ -46,7 +48,8 @@ EnumStringMap<PulayParamsMember> pulayParamsDescMap
 	PPM_residualThreshold, "convergence threshold for the residual in the mixed variable",
 	PPM_mixFraction, "mix fraction (default 0.5)",
 	PPM_qMetric, "wavevector controlling the metric for overlaps (default: 0.8 bohr^-1)",
-	PPM_history, "number of past residuals that are cached and used for mixing"
+	PPM_history, "number of past residuals that are cached and used for mixing",
+	PPM_historyOnDisk, "whether to store past residuals and variables in a scratch file (in $TMPDIR or /tmp) to save memory (default no)"
 );
 
 //Base class for pulay-mixing commands
@@ -74,6 +77,7 @@ protected:
 					case PPM_mixFraction: pl.get(pp.mixFraction, 0.5, "mixFraction", true); break;
 					case PPM_qMetric: pl.get(pp.qMetric, 0.8, "qMetric", true); break;
 					case PPM_history: pl.get(pp.history, 10, "history", true); if(pp.history<1) throw string("<history> must be >= 1"); break;
+					case PPM_historyOnDisk: pl.get(pp.historyOnDisk, false, boolMap, "historyOnDisk", true); break;
 				}
 			}
 			else process_sub(keyStr, pl, e);
@@ -89,6 +93,7 @@ protected:
 		PRINT(mixFraction, %lg)
 		PRINT(qMetric, %lg)
 		PRINT(history, %d)
+		logPrintf(" \\\n\thistoryOnDisk\t%s", boolMap.getString(pp.historyOnDisk));
 		#undef PRINT
 	}
 	
@@ -222,3 +227,47 @@ struct CommandPcmNonlinearScf: public CommandPulay
 	}
 }
 commandPcmNonlinearScf;
+
+
+struct CommandFluidScf: public CommandPulay
+{
+	CommandFluidScf() : CommandPulay("fluid-scf", "jdftx/Fluid/Optimization")
+	{	
+		comments =
+			"Converge classical DFT fluids by Pulay (Anderson) mixing of preconditioned\n"
+			"fixed-point iterations of the Euler-Lagrange equations, instead of conjugate gradients.\n"
+			"If the residual stops decreasing, the fluid minimization switches to conjugate gradients\n"
+			"from the best state so far, using the parameters in fluid-minimize.\n"
+			"Possible keys and value types to control SCF optimization:"
+			+ addDescriptions(pulayParamsMap.optionList(), linkDescription(pulayParamsMap, pulayParamsDescMap))
+			+ "\n\nAny number of these key-value pairs may be specified in any order.";
+		hasDefault = false;
+		require("fluid");
+		forbid("pcm-nonlinear-scf");
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	FluidSolverParams& fsp = e.eVars.fluidParams;
+		if(fsp.fluidType != FluidClassicalDFT)
+			throw string("fluid-scf is only supported for fluid type ClassicalDFT");
+		fsp.cdftSCF = true;
+		PulayParams& pp = fsp.scfParams;
+		pp.linePrefix = "FluidSCF: ";
+		pp.energyLabel = "Adiel";
+		pp.energyFormat = "%+.15lf";
+		pp.energyDiffThreshold = 1e-11;
+		pp.residualThreshold = 1e-8;
+		pp.nIterations = 200;
+		pp.fpLog = globalLog;
+		processCommon(pl, e, pp); //only base class parameters
+	}
+	
+	void process_sub(string keyStr, ParamList& pl, Everything& e)
+	{	throw string("Parameter <key> must be one of " + pulayParamsMap.optionList());
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	printStatusCommon(e.eVars.fluidParams.scfParams); //only base class parameters
+	}
+}
+commandFluidScf;
@@ -146,22 +146,21 @@ void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, double* x) { eblas
 void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, complex* x) { eblas_symmetrize_gpu<complex>(N, n, symmIndex, x); }
 
 __global__
-void eblas_symmetrize_phase_kernel(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, complex* x)
-{	int i=kernelIndex1D();
-	if(i<N)
-	{	complex xSum = 0.;
-		for(int j=0; j<n; j++)
-			xSum += x[symmIndex[n*i+j]] * phase[n*i+j];
-		xSum *= 1./(n*symmMult[i]); //average n in the equivalence class, with weight for accumulation below accounted)
-		for(int j=0; j<n; j++)
-			x[symmIndex[n*i+j]] = 0.;
-		for(int j=0; j<n; j++)
-			x[symmIndex[n*i+j]] += xSum * phase[n*i+j].conj();
+void eblas_symmetrize_phase_kernel(int nOrbits, int nSym, const int* orbitStart, const int* orbitIndex, const complex* orbitPhase, complex* x)
+{	int o=kernelIndex1D();
+	if(o<nOrbits)
+	{	int eStart = orbitStart[o], eStop = orbitStart[o+1];
+		complex xSum = 0.;
+		for(int e=eStart; e<eStop; e++)
+			xSum += x[orbitIndex[e]] * orbitPhase[e];
+		xSum *= (eStop-eStart) * (1./(nSym*nSym)); //average over orbit (with multiplicity nSym/orbitSize accounted for in orbitPhase)
+		for(int e=eStart; e<eStop; e++)
+			x[orbitIndex[e]] = xSum * orbitPhase[e].conj();
 	}
 }
-void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, complex* x)
-{	GpuLaunchConfig1D glc(eblas_symmetrize_phase_kernel, N);
-	eblas_symmetrize_phase_kernel<<<glc.nBlocks,glc.nPerBlock>>>(N, n, symmIndex, symmMult, phase, x);
+void eblas_symmetrize_gpu(int nOrbits, int nSym, const int* orbitStart, const int* orbitIndex, const complex* orbitPhase, complex* x)
+{	GpuLaunchConfig1D glc(eblas_symmetrize_phase_kernel, nOrbits);
+	eblas_symmetrize_phase_kernel<<<glc.nBlocks,glc.nPerBlock>>>(nOrbits, nSym, orbitStart, orbitIndex, orbitPhase, x);
 	gpuErrorCheck();
 }
 
@@ -210,18 +210,18 @@ void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, double* x);
 void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, complex* x);
 #endif
 
-//! @brief Symmetrize a complex array x with phase factors, using N n-fold equivalence classes in symmIndex
+//! @brief Symmetrize a complex array x with phase factors, using orbits (equivalence classes) of distinct points
 //! (useful for space group symmetrization in reciprocal space)
-//! @param N Length of array x
-//! @param n Length of symmetry equivalence classes
-//! @param symmIndex Every consecutive set of n indices in this array forms an equivalence class
-//! @param symmMult Multiplicity per equivalence class (number of repetitions of each element in orbit)
-//! @param phase Phase factors corresponding to each entry in symmIndex
+//! @param nOrbits Number of orbits
+//! @param nSym Number of symmetry operations (each orbit of m distinct points covers each point nSym/m times)
+//! @param orbitStart Entries of orbit o are orbitStart[o] to orbitStart[o+1]-1 in orbitIndex and orbitPhase
+//! @param orbitIndex Index into x for each entry
+//! @param orbitPhase Net phase factor for each entry (summed over symmetry operations that map to it)
 //! @param x Data array to be symmetrized in place
-void eblas_symmetrize(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, complex* x);
+void eblas_symmetrize(int nOrbits, int nSym, const int* orbitStart, const int* orbitIndex, const complex* orbitPhase, complex* x);
 #ifdef GPU_ENABLED
 //! @brief Equivalent of eblas_symmetrize() for complex GPU data pointers
-void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, complex* x);
+void eblas_symmetrize_gpu(int nOrbits, int nSym, const int* orbitStart, const int* orbitIndex, const complex* orbitPhase, complex* x);
 #endif
 
 //Threaded-wrappers for BLAS1 functions (Cblas)
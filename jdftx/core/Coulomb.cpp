@@ -23,13 +23,14 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/CoulombIsolated.h>
 #include <core/Coulomb_internal.h>
 #include <core/Coulomb_ExchangeEval.h>
+#include <core/Coulomb_Ewald.h>
 #include <core/LoopMacros.h>
 #include <core/BlasExtra.h>
 #include <core/Thread.h>
 #include <core/Operators.h>
 #include "LatticeUtils.h"
 
-CoulombParams::CoulombParams() : ionMargin(5.), embed(false), embedFluidMode(false)
+CoulombParams::CoulombParams() : ionMargin(5.), embed(false), embedFluidMode(false), spmeOrder(0)
 {
 }
 
@@ -174,11 +175,23 @@ complexScalarFieldTilde Coulomb::operator()(const complexScalarFieldTilde& in, v
 	return (*this)((complexScalarFieldTilde&&)out, kDiff, omega);
 }
 
-double Coulomb::energyAndGrad(std::vector<Atom>& atoms) const
+void Coulomb::operator()(std::vector<complexScalarFieldTilde>& in, vector3<> kDiff, double omega) const
+{	auto exEvalOmega = exchangeEval.find(omega);
+	assert(exEvalOmega != exchangeEval.end());
+	if(params.embed)
+	{	for(complexScalarFieldTilde& x: in) x = embedExpand((complexScalarFieldTilde&&)x);
+		(*exEvalOmega->second)(in, kDiff);
+		for(complexScalarFieldTilde& x: in) x = embedShrink((complexScalarFieldTilde&&)x);
+	}
+	else (*exEvalOmega->second)(in, kDiff);
+}
+
+double Coulomb::energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
 {	if(!ewald) ((Coulomb*)this)->ewald = createEwald(gInfo.R, atoms.size());
 	double Eewald = 0.;
 	if(params.embed)
-	{	matrix3<> embedScaleMat = Diag(embedScale);
+	{	assert(!E_RRT); //lattice derivatives not supported with truncation
+		matrix3<> embedScaleMat = Diag(embedScale);
 		matrix3<> invEmbedScaleMat = inv(embedScaleMat);
 		//Convert atom positions to embedding grid's lattice coordinates:
 		for(unsigned i=0; i<atoms.size(); i++)
@@ -219,7 +232,7 @@ double Coulomb::energyAndGrad(std::vector<Atom>& atoms) const
 			a.force = embedScaleMat * a.force;
 		}
 	}
-	else Eewald = ewald->energyAndGrad(atoms);
+	else Eewald = ewald->energyAndGrad(atoms, E_RRT);
 	//Electric field contributions if any:
 	if(params.Efield.length_squared())
 	{	vector3<> RT_Efield_ramp, RT_Efield_wave;
@@ -237,6 +250,22 @@ double Coulomb::energyAndGrad(std::vector<Atom>& atoms) const
 	return Eewald;
 }
 
+std::shared_ptr<Ewald> Coulomb::createEwaldSPME(matrix3<> R, std::shared_ptr<Ewald> ewaldExact) const
+{	if(!params.spmeOrder || nrm2(R - gInfo.R) > symmThreshold * nrm2(gInfo.R))
+		return ewaldExact; //not enabled, or a supercell (single-charge exchange correction, which is cheap exactly)
+	//Sample the Coulomb kernel on gInfo:
+	ScalarFieldTilde K(ScalarFieldTildeData::alloc(gInfo, isGpuEnabled()));
+	complex* Kdata = K->data();
+	for(int i=0; i<gInfo.nG; i++)
+		Kdata[i] = 1.;
+	K = apply((ScalarFieldTilde&&)K);
+	Kdata = K->data();
+	RealKernel coulombKernel(gInfo);
+	for(int i=0; i<gInfo.nG; i++)
+		coulombKernel.data()[i] = Kdata[i].real();
+	return std::make_shared<EwaldSPME>(gInfo, coulombKernel, params, ewaldExact);
+}
+
 void getEfieldPotential_sub(size_t iStart, size_t iStop, const vector3<int>& S, const WignerSeitz* ws,
 	const vector3<>& xCenter, const vector3<>& RT_Efield_ramp, const vector3<>& RT_Efield_wave, double* V)
 {	matrix3<> invS = inv(Diag(vector3<>(S)));
@@ -259,6 +288,10 @@ ScalarField Coulomb::getEfieldPotential() const
 	else return ScalarField();
 }
 
+matrix3<> Coulomb::latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const
+{	die("Lattice derivatives of the Coulomb interaction are only implemented for 3D periodic geometry.\n");
+}
+
 void setEmbedIndex_sub(size_t iStart, size_t iStop, const vector3<int>& S, const vector3<int>& Sembed, const WignerSeitz* ws, int* embedIndex)
 {	vector3<> invS; for(int k=0; k<3; k++) invS[k] = 1./S[k];
 	THREAD_rLoop
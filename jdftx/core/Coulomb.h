@@ -53,6 +53,8 @@ struct CoulombParams
 	
 	vector3<> Efield; //!< electric field (in Cartesian coordinates, atomic units [Eh/e/a0])
 	
+	int spmeOrder; //!< B-spline order for smooth particle-mesh Ewald sums of point charges (Periodic and Slab geometries only; 0 => exact Ewald sums)
+	
 	//Parameters for computing exchange integrals:
 	//! Regularization method for G=0 singularities in exchange
 	enum ExchangeRegularization
@@ -101,8 +103,9 @@ class Ewald
 public:
 	//!Get the energy of a point charge configurtaion, and accumulate corresponding forces
 	//!The implementation will shift each Atom::pos by lattice vectors to bring it to
-	//!the fundamental zone (or Wigner-Seitz cell as appropriate)
-	virtual double energyAndGrad(std::vector<Atom>& atoms) const=0;
+	//!the fundamental zone (or Wigner-Seitz cell as appropriate).
+	//!If E_RRT is non-null, accumulate the lattice derivative (dE/dR) R^T to it (3D periodic geometry only).
+	virtual double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT=0) const=0;
 };
 
 
@@ -127,11 +130,16 @@ public:
 	
 	//! Create the appropriate Ewald class, if required, and call Ewald::energyAndGrad
 	//! Includes interaction with Efield, if present (Requires embedded truncation)
-	double energyAndGrad(std::vector<Atom>& atoms) const; 
+	//! The lattice derivative (dE/dR) R^T is accumulated to E_RRT if non-null (3D periodic geometry only)
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT=0) const;
 
 	//! Generate the potential due to the Efield (if any) (Requires embedded truncation)
 	ScalarField getEfieldPotential() const;
 	
+	//! Lattice derivative (dE/dR) R^T of E = dot(X, O(coulomb(Y))) at fixed Fourier coefficients of X and Y,
+	//! i.e. due to the volume factor in O and the change in the kernel (3D periodic geometry only)
+	virtual matrix3<> latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const;
+	
 	//! Apply regularized coulomb kernel for exchange integral with k-point difference kDiff
 	//! and optionally screened with range parameter omega (destructible input)
 	complexScalarFieldTilde operator()(complexScalarFieldTilde&&, vector3<> kDiff, double omega) const;
@@ -140,6 +148,11 @@ public:
 	//! and optionally screened with range parameter omega (destructible input)
 	complexScalarFieldTilde operator()(const complexScalarFieldTilde&, vector3<> kDiff, double omega) const;
 
+	//! Apply regularized coulomb kernel for exchange integral with k-point difference kDiff
+	//! and optionally screened with range parameter omega, in place to each of a batch of fields
+	//! (more efficient than separate calls for numerical kernels, which are then loaded only once)
+	void operator()(std::vector<complexScalarFieldTilde>&, vector3<> kDiff, double omega) const;
+
 private:
 	const GridInfo& gInfoOrig; //!< original grid
 protected:
@@ -165,6 +178,10 @@ protected:
 	//!gInfo.R along the periodic directions (the truncated directions will be identical)
 	//!The number of atoms may be used for choosing the optimum gaussian width sigma
 	virtual std::shared_ptr<Ewald> createEwald(matrix3<> R, size_t nAtoms) const=0;
+	
+	//!Return a smooth particle-mesh Ewald evaluator (which uses the kernel from apply() on gInfo) if
+	//!enabled by params.spmeOrder and if R matches gInfo.R, and return ewaldExact otherwise
+	std::shared_ptr<Ewald> createEwaldSPME(matrix3<> R, std::shared_ptr<Ewald> ewaldExact) const;
 
 private:
 	//Data for mesh-embedded truncation:
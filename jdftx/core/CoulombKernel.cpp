@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/LoopMacros.h>
 #include <core/ManagedMemory.h>
 #include <core/Thread.h>
+#include <core/KernelCache.h>
 #include <cfloat>
 
 const double CoulombKernel::nSigmasPerWidth = 1.+sqrt(-2.*log(DBL_EPSILON)); //gaussian negligible at double precision (+1 sigma for safety)
@@ -34,6 +35,21 @@ CoulombKernel::CoulombKernel(const matrix3<> R, const vector3<int> S, const vect
 
 
 void CoulombKernel::compute(double* data, const WignerSeitz& ws) const
+{	if(KernelCache::enabled())
+	{	//Retrieve from (or save to) persistent cache:
+		size_t nG = S[0] * (S[1] * size_t(1 + S[2]/2));
+		KernelCacheKey key("CoulombKernel");
+		key << string("v1") << R << S << omega; //bump the version tag whenever computeUncached changes
+		for(int k=0; k<3; k++) key << int(isTruncated[k]);
+		if(!KernelCache::load(key, data, nG)) //read directly into the destination
+		{	computeUncached(data, ws);
+			KernelCache::save(key, data, nG);
+		}
+	}
+	else computeUncached(data, ws);
+}
+
+void CoulombKernel::computeUncached(double* data, const WignerSeitz& ws) const
 {	//Count number of truncated directions:
 	int nTruncated = 0;
 	for(int k=0; k<3; k++) if(isTruncated[k]) nTruncated++;
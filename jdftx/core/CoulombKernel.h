@@ -42,11 +42,14 @@ struct CoulombKernel
 	//! ws is the Wigner-Seitz cell corresponding to lattice vectors R.
 	//!      Supported modes include fully truncated (Isolated or Wigner-Seitz
 	//! truncated exchange kernel) and one direction periodic (Wire geometry).
+	//! The kernel is retrieved from / saved to the persistent KernelCache, if enabled.
 	void compute(double* data, const WignerSeitz& ws) const;
 	
 	static const double nSigmasPerWidth; //!< number of sigmas at which gaussian is negligible at working precision
 	
 private:
+	void computeUncached(double* data, const WignerSeitz& ws) const; //!< compute kernel, dispatching to the cases below
+	
 	//Various indiviudally optimized cases of computeKernel:
 	void computeIsolated(double* data, const WignerSeitz& ws) const; //!< Fully truncated
 	void computeWire(double* data, const WignerSeitz& ws) const; //!< 1 periodic direction
@@ -19,46 +19,57 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/CoulombPeriodic.h>
 #include <core/Coulomb_internal.h>
+#include <core/Coulomb_Ewald.h>
 #include <core/CoulombKernel.h>
 #include <core/BlasExtra.h>
+#include <core/LoopMacros.h>
+#include <core/Thread.h>
 
 //! Standard 3D Ewald sum
 class EwaldPeriodic : public Ewald
 {
 	matrix3<> R, G, RTR, GGT; //!< Lattice vectors, reciprocal lattice vectors and corresponding metrics
 	double sigma; //!< gaussian width for Ewald sums
-	vector3<int> Nreal; //!< max unit cell indices for real-space sum
+	std::shared_ptr<EwaldRealSpace> realSpace; //!< real-space sum
 	vector3<int> Nrecip; //!< max unit cell indices for reciprocal-space sum
+	std::vector< vector3<int> > iGarr; //!< reciprocal lattice vectors within the cutoff sphere (only one of each +/-G pair)
+	std::vector<double> eGarr; //!< reciprocal space Ewald kernel for each entry of iGarr (including a factor of 2 for -G)
 
 public:
 	EwaldPeriodic(const matrix3<>& R, int nAtoms)
 	: R(R), G((2*M_PI)*inv(R)), RTR((~R)*R), GGT(G*(~G))
 	{	logPrintf("\n---------- Setting up ewald sum ----------\n");
 		//Determine optimum gaussian width for Ewald sums:
-		// From below, the number of reciprocal cells ~ Prod_k |R.column[k]|
-		//    and number of real space cells ~ Prod_k |G.row[k]|
-		// including the fact that the real space cost ~ Natoms^2/cell
-		//    and the reciprocal space cost ~ Natoms/cell
-		sigma = 1.;
-		for(int k=0; k<3; k++)
-			sigma *= R.column(k).length() / G.row(k).length();
-		sigma = pow(sigma/std::max(1,nAtoms), 1./6);
+		// The real space sum (using a cell list) covers ~ Natoms^2 (4pi/3) rCut^3 / detR pairs with rCut ~ sigma,
+		// and the reciprocal space sum ~ Natoms (4pi/3) Gcut^3 detR / (2 (2pi)^3) terms with Gcut ~ 1/sigma
+		// (with only one of each +/-G pair), where the cost per term is comparable in the two sums
+		double detR = fabs(det(R));
+		sigma = pow(detR*detR / (2.*pow(2*M_PI,3) * std::max(1,nAtoms)), 1./6);
 		logPrintf("Optimum gaussian width for ewald sums = %lf bohr.\n", sigma);
 		
-		//Carry real space sums to Rmax = 10 sigma and Gmax = 10/sigma
-		//This leads to relative errors ~ 1e-22 in both sums, well within double precision limits
+		//Cut off the real space sum at rCut = nSigmasPerWidth sigma (pair distance, using a cell list),
+		//and the reciprocal space sum at Gcut = nSigmasPerWidth / sigma (G magnitude, within a sphere),
+		//beyond which the erfc and gaussian terms are below double precision relative to the retained ones
+		realSpace = std::make_shared<EwaldRealSpace>(R, sigma);
+		//--- reciprocal lattice vectors within Gcut:
+		double Gcut = CoulombKernel::nSigmasPerWidth / sigma;
 		for(int k=0; k<3; k++)
-		{	Nreal[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * G.row(k).length() * sigma / (2*M_PI));
-			Nrecip[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * R.column(k).length() / (2*M_PI*sigma));
-		}
-		logPrintf("Real space sum over %d unit cells with max indices ", (2*Nreal[0]+1)*(2*Nreal[1]+1)*(2*Nreal[2]+1));
-		Nreal.print(globalLog, " %d ");
-		logPrintf("Reciprocal space sum over %d terms with max indices ", (2*Nrecip[0]+1)*(2*Nrecip[1]+1)*(2*Nrecip[2]+1));
+			Nrecip[k] = 1+ceil(Gcut * R.column(k).length() / (2*M_PI));
+		vector3<int> iG; //integer reciprocal cell number
+		for(iG[0]=0; iG[0]<=Nrecip[0]; iG[0]++)
+			for(iG[1]=(iG[0] ? -Nrecip[1] : 0); iG[1]<=Nrecip[1]; iG[1]++)
+				for(iG[2]=((iG[0] || iG[1]) ? -Nrecip[2] : 1); iG[2]<=Nrecip[2]; iG[2]++)
+				{	double Gsq = GGT.metric_length_squared(iG);
+					if(Gsq > Gcut*Gcut) continue;
+					iGarr.push_back(iG);
+					eGarr.push_back(2. * 4*M_PI * exp(-0.5*sigma*sigma*Gsq)/(Gsq * detR));
+				}
+		logPrintf("Reciprocal space sum over %lu terms with max indices ", 2*iGarr.size());
 		Nrecip.print(globalLog, " %d ");
 	}
 
-	double energyAndGrad(std::vector<Atom>& atoms) const
-	{	double eta = sqrt(0.5)/sigma, etaSq=eta*eta;
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
+	{	double eta = sqrt(0.5)/sigma;
 		double sigmaSq = sigma * sigma;
 		double detR = fabs(det(R)); //cell volume
 		//Position independent terms:
@@ -67,48 +78,82 @@ public:
 		{	Ztot += a.Z;
 			ZsqTot += a.Z * a.Z;
 		}
-		double E
-			= 0.5 * 4*M_PI * Ztot*Ztot * (-0.5*sigmaSq) / detR //G=0 correction
-			- 0.5 * ZsqTot * eta * (2./sqrt(M_PI)); //Self-energy correction
+		double EG0 = 0.5 * 4*M_PI * Ztot*Ztot * (-0.5*sigmaSq) / detR; //G=0 correction
+		double E = EG0 - 0.5 * ZsqTot * eta * (2./sqrt(M_PI)); //Self-energy correction
+		if(E_RRT) *E_RRT -= EG0 * matrix3<>(1,1,1); //G=0 correction scales inversely with volume
 		//Reduce positions to first centered unit cell:
 		for(Atom& a: atoms)
 			for(int k=0; k<3; k++)
 				a.pos[k] -= floor(0.5 + a.pos[k]);
+		
 		//Real space sum:
-		vector3<int> iR; //integer cell number
-		for(const Atom& a2: atoms)
-			for(Atom& a1: atoms)
-				for(iR[0]=-Nreal[0]; iR[0]<=Nreal[0]; iR[0]++)
-					for(iR[1]=-Nreal[1]; iR[1]<=Nreal[1]; iR[1]++)
-						for(iR[2]=-Nreal[2]; iR[2]<=Nreal[2]; iR[2]++)
-						{	vector3<> x = iR + (a1.pos - a2.pos);
-							double rSq = RTR.metric_length_squared(x);
-							if(!rSq) continue; //exclude self-interaction
-							double r = sqrt(rSq);
-							E += 0.5 * a1.Z * a2.Z * erfc(eta*r)/r;
-							a1.force += (RTR * x) *
-								(a1.Z * a2.Z * (erfc(eta*r)/r + (2./sqrt(M_PI))*eta*exp(-etaSq*rSq))/rSq);
-						}
+		E += realSpace->energyAndGrad(atoms, E_RRT);
+		
 		//Reciprocal space sum:
-		vector3<int> iG; //integer reciprocal cell number
-		for(iG[0]=-Nrecip[0]; iG[0]<=Nrecip[0]; iG[0]++)
-			for(iG[1]=-Nrecip[1]; iG[1]<=Nrecip[1]; iG[1]++)
-				for(iG[2]=-Nrecip[2]; iG[2]<=Nrecip[2]; iG[2]++)
-				{	double Gsq = GGT.metric_length_squared(iG);
-					if(!Gsq) continue; //skip G=0
-					//Compute structure factor:
-					complex SG = 0.;
-					for(const Atom& a: atoms)
-						SG += a.Z * cis(-2*M_PI*dot(iG,a.pos));
-					//Accumulate energy:
-					double eG = 4*M_PI * exp(-0.5*sigmaSq*Gsq)/(Gsq * detR);
-					E += 0.5 * eG * SG.norm();
-					//Accumulate forces:
-					for(Atom& a: atoms)
-						a.force -= (eG * a.Z * 2*M_PI * (SG.conj() * cis(-2*M_PI*dot(iG,a.pos))).imag()) * iG;
-				}
+		//--- phase factors of each atom along each lattice direction:
+		std::vector<complex> phase[3]; //phase[k][(n+Nrecip[k])*nAtoms + iAtom] = cis(-2 pi n pos[k])
+		for(int k=0; k<3; k++)
+			phase[k].resize((2*Nrecip[k]+1) * atoms.size());
+		threadedLoop(phase_calc, atoms.size(), this, &atoms, phase);
+		//--- structure factors:
+		std::vector<complex> SG(iGarr.size());
+		threadedLoop(structureFactor_calc, iGarr.size(), this, &atoms, (const std::vector<complex>*)phase, SG.data());
+		for(size_t iG=0; iG<iGarr.size(); iG++)
+		{	double EG = 0.5 * eGarr[iG] * SG[iG].norm();
+			E += EG;
+			if(E_RRT) //strain derivative via the change in G and the volume factor in eGarr
+			{	vector3<> Gvec = iGarr[iG] * G;
+				double Gsq = Gvec.length_squared();
+				*E_RRT += EG * ((sigmaSq + 2./Gsq) * outer(Gvec, Gvec) - matrix3<>(1,1,1));
+			}
+		}
+		//--- forces:
+		threadedLoop(recipForce_calc, atoms.size(), this, &atoms, (const std::vector<complex>*)phase, SG.data());
 		return E;
 	}
+
+private:
+	//Phase factors of atom i along each lattice direction for all reciprocal lattice indices
+	static void phase_calc(size_t i, const EwaldPeriodic* ewald, std::vector<Atom>* atoms, std::vector<complex>* phase)
+	{	const vector3<int>& Nrecip = ewald->Nrecip;
+		size_t nAtoms = atoms->size();
+		const vector3<>& pos = atoms->at(i).pos;
+		for(int k=0; k<3; k++)
+			for(int n=-Nrecip[k]; n<=Nrecip[k]; n++)
+				phase[k][(n+Nrecip[k])*nAtoms + i] = cis(-2*M_PI*n*pos[k]);
+	}
+	
+	//Structure factor for the iG'th reciprocal lattice vector
+	static void structureFactor_calc(size_t iG, const EwaldPeriodic* ewald, std::vector<Atom>* atoms,
+		const std::vector<complex>* phase, complex* SG)
+	{	const vector3<int>& Nrecip = ewald->Nrecip;
+		const vector3<int>& G = ewald->iGarr[iG];
+		size_t nAtoms = atoms->size();
+		const complex* phase0 = phase[0].data() + (G[0]+Nrecip[0])*nAtoms;
+		const complex* phase1 = phase[1].data() + (G[1]+Nrecip[1])*nAtoms;
+		const complex* phase2 = phase[2].data() + (G[2]+Nrecip[2])*nAtoms;
+		complex S = 0.;
+		for(size_t i=0; i<nAtoms; i++)
+			S += atoms->at(i).Z * (phase0[i] * phase1[i] * phase2[i]);
+		SG[iG] = S;
+	}
+	
+	//Reciprocal-space force on atom i
+	static void recipForce_calc(size_t i, const EwaldPeriodic* ewald, std::vector<Atom>* atoms,
+		const std::vector<complex>* phase, const complex* SG)
+	{	const vector3<int>& Nrecip = ewald->Nrecip;
+		size_t nAtoms = atoms->size();
+		Atom& a = atoms->at(i);
+		vector3<> force;
+		for(size_t iG=0; iG<ewald->iGarr.size(); iG++)
+		{	const vector3<int>& G = ewald->iGarr[iG];
+			complex phaseG = phase[0][(G[0]+Nrecip[0])*nAtoms + i]
+				* phase[1][(G[1]+Nrecip[1])*nAtoms + i]
+				* phase[2][(G[2]+Nrecip[2])*nAtoms + i];
+			force -= (ewald->eGarr[iG] * a.Z * 2*M_PI * (SG[iG].conj() * phaseG).imag()) * G;
+		}
+		a.force += force;
+	}
 };
 
 
@@ -125,6 +170,28 @@ ScalarFieldTilde CoulombPeriodic::apply(ScalarFieldTilde&& in) const
 	return in;
 }
 
+void CoulombPeriodic_latticeGradient_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G,
+	const complex* X, const complex* Y, matrix3<>* result, std::mutex* m)
+{	matrix3<> resultSub;
+	THREAD_halfGspaceLoop
+	(	vector3<> Gvec = iG * G;
+		double Gsq = Gvec.length_squared();
+		if(Gsq) //no G=0 contribution
+		{	double weight = (iG[2]==0 || 2*iG[2]==S[2]) ? 1. : 2.; //account for real symmetry
+			double XKY = weight * (X[i].conj() * Y[i]).real() * (4*M_PI)/Gsq;
+			resultSub += XKY * ((2./Gsq) * outer(Gvec,Gvec) + matrix3<>(1,1,1)); //change in kernel and volume factor
+		}
+	)
+	m->lock();
+	*result += resultSub;
+	m->unlock();
+}
+matrix3<> CoulombPeriodic::latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const
+{	matrix3<> result; std::mutex m;
+	threadLaunch(CoulombPeriodic_latticeGradient_sub, gInfo.nG, gInfo.S, gInfo.G, X->data(), Y->data(), &result, &m);
+	return gInfo.detR * result;
+}
+
 std::shared_ptr<Ewald> CoulombPeriodic::createEwald(matrix3<> R, size_t nAtoms) const
-{	return std::make_shared<EwaldPeriodic>(R, nAtoms);
+{	return createEwaldSPME(R, std::make_shared<EwaldPeriodic>(R, nAtoms));
 }
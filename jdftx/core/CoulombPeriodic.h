@@ -31,6 +31,7 @@ class CoulombPeriodic : public Coulomb
 {
 public:
 	CoulombPeriodic(const GridInfo& gInfoOrig, const CoulombParams& params);
+	matrix3<> latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const;
 protected:
 	ScalarFieldTilde apply(ScalarFieldTilde&&) const;
 	std::shared_ptr<Ewald> createEwald(matrix3<> R, size_t nAtoms) const;
@@ -59,8 +59,9 @@ public:
 		Nrecip.print(globalLog, " %d ");
 	}
 	
-	double energyAndGrad(std::vector<Atom>& atoms) const
-	{	if(!atoms.size()) return 0.;
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
+	{	assert(!E_RRT); //lattice derivative not implemented with truncation
+		if(!atoms.size()) return 0.;
 		double eta = sqrt(0.5)/sigma, etaSq=eta*eta, etaSqrtPiInv = 1./(eta*sqrt(M_PI));
 		double sigmaSq = sigma * sigma;
 		//Position independent terms: (Self-energy correction)
@@ -161,5 +162,5 @@ ScalarFieldTilde CoulombSlab::apply(ScalarFieldTilde&& in) const
 }
 
 std::shared_ptr<Ewald> CoulombSlab::createEwald(matrix3<> R, size_t nAtoms) const
-{	return std::make_shared<EwaldSlab>(R, params.iDir, params.ionMargin);
+{	return createEwaldSPME(R, std::make_shared<EwaldSlab>(R, params.iDir, params.ionMargin));
 }
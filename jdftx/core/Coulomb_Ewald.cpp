@@ -0,0 +1,298 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Coulomb_Ewald.h>
+#include <core/Coulomb_internal.h>
+#include <core/CoulombKernel.h>
+#include <core/Operators.h>
+#include <core/Thread.h>
+
+//---------------------- class EwaldRealSpace -----------------------
+
+EwaldRealSpace::EwaldRealSpace(const matrix3<>& R, double sigma, vector3<bool> isTruncated)
+: R(R), RTR((~R)*R), sigma(sigma), rCut(CoulombKernel::nSigmasPerWidth * sigma)
+{	matrix3<> G = (2*M_PI)*inv(R);
+	for(int k=0; k<3; k++)
+	{	if(isTruncated[k])
+		{	nCells[k] = 1;
+			nReach[k] = 0; //no images along truncated directions
+		}
+		else
+		{	double planeSpacing = (2*M_PI) / G.row(k).length(); //distance between lattice planes normal to direction k
+			nCells[k] = std::max(1, int(floor(planeSpacing / rCut)));
+			nReach[k] = int(ceil(rCut * nCells[k] / planeSpacing));
+		}
+	}
+	logPrintf("Real space sum within %lg bohrs using a cell list with ", rCut);
+	nCells.print(globalLog, " %d ");
+}
+
+double EwaldRealSpace::energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
+{	//Bin atoms into cells:
+	int nCellsTot = nCells[0]*nCells[1]*nCells[2];
+	std::vector< vector3<int> > atomCell(atoms.size());
+	std::vector<int> cellStart(nCellsTot+1, 0); //atoms in cell c are cellAtoms[cellStart[c]] to cellAtoms[cellStart[c+1]-1]
+	for(size_t i=0; i<atoms.size(); i++)
+	{	for(int k=0; k<3; k++)
+			atomCell[i][k] = std::max(0, std::min(nCells[k]-1, int(floor((atoms[i].pos[k] + 0.5) * nCells[k]))));
+		cellStart[cellIndex(atomCell[i])+1]++;
+	}
+	for(int c=0; c<nCellsTot; c++)
+		cellStart[c+1] += cellStart[c];
+	std::vector<int> cellAtoms(atoms.size());
+	{	std::vector<int> cellNext(cellStart.begin(), cellStart.end()-1);
+		for(size_t i=0; i<atoms.size(); i++)
+			cellAtoms[cellNext[cellIndex(atomCell[i])]++] = i;
+	}
+	//Sum over neighbouring cells:
+	std::vector< matrix3<> > E_xxT(E_RRT ? atoms.size() : 0); //virial in lattice coordinates per atom (if needed)
+	double E = threadedAccumulate(energyAndGrad_calc, atoms.size(), this, &atoms,
+		atomCell.data(), cellStart.data(), cellAtoms.data(), E_RRT ? E_xxT.data() : 0);
+	if(E_RRT)
+	{	matrix3<> E_xxTsum;
+		for(const matrix3<>& m: E_xxT) E_xxTsum += m;
+		*E_RRT += R * E_xxTsum * (~R);
+	}
+	return E;
+}
+
+//Real-space energy and force on atom i1 from all atoms (and periodic images) within rCut,
+//and the corresponding virial, sum_pairs (1/r)(dE/dr) x x^T for lattice separations x, in E_xxT[i1] (if non-null)
+double EwaldRealSpace::energyAndGrad_calc(size_t i1, const EwaldRealSpace* ewald, std::vector<Atom>* atoms,
+	const vector3<int>* atomCell, const int* cellStart, const int* cellAtoms, matrix3<>* E_xxT)
+{	const vector3<int>& nCells = ewald->nCells;
+	const vector3<int>& nReach = ewald->nReach;
+	const matrix3<>& RTR = ewald->RTR;
+	double eta = sqrt(0.5)/ewald->sigma, etaSq = eta*eta;
+	double rCutSq = ewald->rCut * ewald->rCut;
+	Atom& a1 = atoms->at(i1);
+	double E = 0.;
+	vector3<int> dCell; //offset to neighbouring cell
+	for(dCell[0]=-nReach[0]; dCell[0]<=nReach[0]; dCell[0]++)
+		for(dCell[1]=-nReach[1]; dCell[1]<=nReach[1]; dCell[1]++)
+			for(dCell[2]=-nReach[2]; dCell[2]<=nReach[2]; dCell[2]++)
+			{	//Wrap neighbouring cell into the unit cell, and determine corresponding lattice vector shift:
+				vector3<int> cell2, iR; //the neighbouring cell is cell2 translated by -iR
+				for(int k=0; k<3; k++)
+				{	int c = atomCell[i1][k] + dCell[k];
+					iR[k] = (c>=0) ? -(c/nCells[k]) : (nCells[k]-1-c)/nCells[k]; //-floor(c/nCells[k])
+					cell2[k] = c + iR[k]*nCells[k];
+				}
+				int c2 = ewald->cellIndex(cell2);
+				for(int j=cellStart[c2]; j<cellStart[c2+1]; j++)
+				{	const Atom& a2 = atoms->at(cellAtoms[j]);
+					vector3<> x = iR + (a1.pos - a2.pos);
+					double rSq = RTR.metric_length_squared(x);
+					if(!rSq || rSq>rCutSq) continue; //exclude self-interaction and negligible terms
+					double r = sqrt(rSq);
+					E += 0.5 * a1.Z * a2.Z * erfc(eta*r)/r;
+					double minusE_r_r = a1.Z * a2.Z * (erfc(eta*r)/r + (2./sqrt(M_PI))*eta*exp(-etaSq*rSq))/rSq; //-(1/r) dE/dr for pair
+					a1.force += (RTR * x) * minusE_r_r;
+					if(E_xxT) E_xxT[i1] -= (0.5 * minusE_r_r) * outer(x, x); //factor of 0.5 since each pair is visited twice
+				}
+			}
+	return E;
+}
+
+//---------------------- class EwaldSPME -----------------------
+
+EwaldSPME::EwaldSPME(const GridInfo& gInfo, const RealKernel& coulombKernel, const CoulombParams& params, std::shared_ptr<Ewald> ewaldExact)
+: gInfo(gInfo), params(params), order(params.spmeOrder), isTruncated(params.isTruncated()), kernel(gInfo), ewaldExact(ewaldExact), checked(false)
+{	logPrintf("\n---------- Setting up smooth particle-mesh ewald sum ----------\n");
+	Citations::add("Smooth particle-mesh Ewald", "U. Essmann et al., J. Chem. Phys. 103, 8577 (1995)");
+	assert(params.geometry==CoulombParams::Periodic || params.geometry==CoulombParams::Slab);
+
+	//Choose the gaussian width so that the long-ranged part is negligible beyond the grid's Nyquist frequency:
+	double Gnyq = DBL_MAX;
+	for(int k=0; k<3; k++)
+		Gnyq = std::min(Gnyq, M_PI * gInfo.S[k] / gInfo.R.column(k).length());
+	sigma = CoulombKernel::nSigmasPerWidth / Gnyq;
+	logPrintf("Order %d B-splines on the %d x %d x %d grid with gaussian width %lf bohr.\n",
+		order, gInfo.S[0], gInfo.S[1], gInfo.S[2], sigma);
+	logPrintf("Note: lattice derivatives (stress) will use the exact Ewald sum.\n");
+	realSpace = std::make_shared<EwaldRealSpace>(gInfo.R, sigma, isTruncated);
+
+	//Squared magnitude of the B-spline structure factor correction |b(m)|^2 along each direction:
+	std::vector<double> M(order), Mprime(order);
+	bSplines(0., order, M.data(), Mprime.data()); //M[j] = M_order(j)
+	std::vector<double> bSq[3];
+	for(int k=0; k<3; k++)
+	{	bSq[k].resize(gInfo.S[k]);
+		for(int m=0; m<gInfo.S[k]; m++)
+		{	complex den = 0.;
+			for(int j=0; j<order-1; j++)
+				den += M[j+1] * cis((2*M_PI*m*j)/gInfo.S[k]);
+			bSq[k][m] = 1./den.norm(); //den is non-zero for even orders
+		}
+	}
+
+	//Long-range kernel:
+	const double* Kdata = coulombKernel.data();
+	double* kernelData = kernel.data();
+	const vector3<int>& S = gInfo.S;
+	size_t iStart=0, iStop=gInfo.nG;
+	THREAD_halfGspaceLoop
+	(	double Gsq = gInfo.GGT.metric_length_squared(iG);
+		vector3<int> iGwrapped = gInfo.wrapGcoords(iG);
+		kernelData[i] = Kdata[i] * exp(-0.5*sigma*sigma*Gsq) / gInfo.detR
+			* bSq[0][iGwrapped[0]] * bSq[1][iGwrapped[1]] * bSq[2][iGwrapped[2]];
+	)
+}
+
+void EwaldSPME::bSplines(double w, int order, double* M, double* Mprime)
+{	//Recursion M_n(u) = [u M_{n-1}(u) + (n-u) M_{n-1}(u-1)] / (n-1) starting from M_1(u) = 1 for u in [0,1),
+	//evaluated in place at u = w+j for j = 0 to n-1 at each level n:
+	M[0] = 1.;
+	for(int n=2; n<=order; n++)
+	{	if(n==order) //derivative M_n'(u) = M_{n-1}(u) - M_{n-1}(u-1)
+		{	Mprime[0] = M[0];
+			for(int j=1; j<n-1; j++) Mprime[j] = M[j] - M[j-1];
+			Mprime[n-1] = -M[n-2];
+		}
+		M[n-1] = 0.;
+		for(int j=n-1; j>=0; j--)
+		{	double u = w + j;
+			M[j] = (u*M[j] + (n-u)*(j ? M[j-1] : 0.)) / (n-1);
+		}
+	}
+}
+
+double EwaldSPME::energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
+{	if(E_RRT) //lattice derivative only available from the exact sum (needed once per stress evaluation):
+	{	assert(ewaldExact);
+		return ewaldExact->energyAndGrad(atoms, E_RRT);
+	}
+	if(!ewaldExact || checked)
+		return energyAndGrad_sub(atoms);
+	//Compare first evaluation against exact Ewald sum:
+	checked = true;
+	std::vector<Atom> atomsExact(atoms), atomsSPME(atoms);
+	for(Atom& a: atomsExact) a.force = vector3<>();
+	for(Atom& a: atomsSPME) a.force = vector3<>();
+	double Eexact = ewaldExact->energyAndGrad(atomsExact);
+	double E = energyAndGrad_sub(atomsSPME);
+	matrix3<> invRT = inv(~gInfo.R); //convert lattice to Cartesian forces
+	double forceErrSq = 0.;
+	for(size_t i=0; i<atoms.size(); i++)
+	{	forceErrSq += (invRT * (atomsSPME[i].force - atomsExact[i].force)).length_squared();
+		atoms[i].pos = atomsSPME[i].pos;
+		atoms[i].force += atomsSPME[i].force;
+	}
+	logPrintf("Smooth particle-mesh ewald error relative to exact sum: %le Eh in energy, %le Eh/bohr rms in forces.\n",
+		E-Eexact, sqrt(forceErrSq/std::max(size_t(1), atoms.size())));
+	return E;
+}
+
+//Long-range forces on atom i given the potential phi on the grid:
+void EwaldSPME_force(size_t i, std::vector<Atom>* atoms, const vector3<int>* base, const double* M, const double* Mprime,
+	int order, const vector3<int> S, const double* phi)
+{	Atom& a = atoms->at(i);
+	const double* Mi = M + 3*order*i;
+	const double* Mprime_i = Mprime + 3*order*i;
+	vector3<> E_pos;
+	for(int j0=0; j0<order; j0++)
+	{	int m0 = base[i][0]-j0; if(m0<0) m0 += S[0];
+		for(int j1=0; j1<order; j1++)
+		{	int m1 = base[i][1]-j1; if(m1<0) m1 += S[1];
+			const double* phiSlice = phi + S[2]*(m1 + S[1]*m0);
+			for(int j2=0; j2<order; j2++)
+			{	int m2 = base[i][2]-j2; if(m2<0) m2 += S[2];
+				double phiCur = phiSlice[m2];
+				E_pos[0] += phiCur * Mprime_i[j0] * Mi[order+j1] * Mi[2*order+j2];
+				E_pos[1] += phiCur * Mi[j0] * Mprime_i[order+j1] * Mi[2*order+j2];
+				E_pos[2] += phiCur * Mi[j0] * Mi[order+j1] * Mprime_i[2*order+j2];
+			}
+		}
+	}
+	for(int k=0; k<3; k++)
+		a.force[k] -= a.Z * S[k] * E_pos[k];
+}
+
+double EwaldSPME::energyAndGrad_sub(std::vector<Atom>& atoms) const
+{	if(!atoms.size()) return 0.;
+	double eta = sqrt(0.5)/sigma;
+	//Position independent terms:
+	double Ztot = 0., ZsqTot = 0.;
+	for(const Atom& a: atoms)
+	{	Ztot += a.Z;
+		ZsqTot += a.Z * a.Z;
+	}
+	double E = -0.5 * ZsqTot * eta * (2./sqrt(M_PI)); //Self-energy correction
+	if(params.geometry==CoulombParams::Periodic)
+		E += 0.5 * 4*M_PI * Ztot*Ztot * (-0.5*sigma*sigma) / gInfo.detR; //G=0 correction
+
+	//Reduce positions to first unit cell (centered on first atom along truncated directions):
+	vector3<> pos0;
+	for(int k=0; k<3; k++)
+		if(isTruncated[k]) pos0[k] = atoms[0].pos[k];
+	for(Atom& a: atoms)
+		for(int k=0; k<3; k++)
+			a.pos[k] -= floor(0.5 + a.pos[k] - pos0[k]);
+	if(params.geometry==CoulombParams::Slab)
+	{	int iDir = params.iDir;
+		double zMin = DBL_MAX, zMax = -DBL_MAX;
+		for(const Atom& a: atoms)
+		{	zMin = std::min(zMin, a.pos[iDir]);
+			zMax = std::max(zMax, a.pos[iDir]);
+		}
+		double L = gInfo.R.column(iDir).length();
+		if((zMax-zMin)*L >= 0.5*L-params.ionMargin)
+			die("Separation between atoms along the truncated direction lies within the margin of %lg bohrs from the Wigner-Seitz boundary.\n" ionMarginMessage, params.ionMargin);
+	}
+
+	//Real space sum:
+	E += realSpace->energyAndGrad(atoms);
+
+	//Spread charges onto grid:
+	const vector3<int>& S = gInfo.S;
+	std::vector< vector3<int> > base(atoms.size()); //grid point of each atom (B-splines extend over base-order+1 to base)
+	std::vector<double> M(3*order*atoms.size()), Mprime(3*order*atoms.size()); //B-spline weights and derivatives
+	ScalarField Q; nullToZero(Q, gInfo);
+	double* Qdata = Q->data();
+	for(size_t i=0; i<atoms.size(); i++)
+	{	double* Mi = M.data() + 3*order*i;
+		double* Mprime_i = Mprime.data() + 3*order*i;
+		for(int k=0; k<3; k++)
+		{	double u = S[k] * (atoms[i].pos[k] - floor(atoms[i].pos[k])); //in [0, S[k]]
+			base[i][k] = int(floor(u));
+			bSplines(u - base[i][k], order, Mi+k*order, Mprime_i+k*order);
+			base[i][k] %= S[k];
+		}
+		for(int j0=0; j0<order; j0++)
+		{	int m0 = base[i][0]-j0; if(m0<0) m0 += S[0];
+			for(int j1=0; j1<order; j1++)
+			{	int m1 = base[i][1]-j1; if(m1<0) m1 += S[1];
+				double* Qslice = Qdata + S[2]*(m1 + S[1]*m0);
+				double Mprod = atoms[i].Z * Mi[j0] * Mi[order+j1];
+				for(int j2=0; j2<order; j2++)
+				{	int m2 = base[i][2]-j2; if(m2<0) m2 += S[2];
+					Qslice[m2] += Mprod * Mi[2*order+j2];
+				}
+			}
+		}
+	}
+
+	//Long-range energy and potential:
+	ScalarField phi = I(kernel * Idag(Q));
+	E += 0.5 * dot(Q, phi);
+
+	//Long-range forces:
+	threadedLoop(EwaldSPME_force, atoms.size(), &atoms, base.data(), (const double*)M.data(), (const double*)Mprime.data(), order, S, (const double*)phi->data());
+	return E;
+}
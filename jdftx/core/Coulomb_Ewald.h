@@ -0,0 +1,86 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_COULOMB_EWALD_H
+#define JDFTX_CORE_COULOMB_EWALD_H
+
+//! @addtogroup LongRange
+//! @{
+
+//! @file Coulomb_Ewald.h Components of Ewald sums shared between geometries, and smooth particle-mesh Ewald
+
+#include <core/Coulomb.h>
+
+//! Real-space part of Ewald sums, sum_{pairs, images} Z1 Z2 erfc(r/(sqrt(2) sigma))/r,
+//! evaluated within a cutoff using a cell list (so that the cost is linear in the number of atoms).
+//! Periodic images are included only along the non-truncated directions.
+class EwaldRealSpace
+{
+public:
+	EwaldRealSpace(const matrix3<>& R, double sigma, vector3<bool> isTruncated=vector3<bool>(false,false,false));
+
+	//! Return real-space energy and accumulate forces (excluding self-interaction),
+	//! and the lattice derivative (dE/dR) R^T to E_RRT if non-null.
+	//! Atom positions must already be reduced to the unit cell (centered at the origin).
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT=0) const;
+
+private:
+	matrix3<> R, RTR; //!< lattice vectors and metric
+	double sigma; //!< gaussian width
+	double rCut; //!< cutoff radius (erfc negligible at double precision beyond)
+	vector3<int> nCells; //!< number of cells along each lattice direction in the cell list
+	vector3<int> nReach; //!< number of neighbouring cells along each lattice direction that may contain atoms within rCut
+
+	inline int cellIndex(const vector3<int>& c) const { return c[2] + nCells[2]*(c[1] + nCells[1]*c[0]); }
+	static double energyAndGrad_calc(size_t i1, const EwaldRealSpace* ewald, std::vector<Atom>* atoms,
+		const vector3<int>* atomCell, const int* cellStart, const int* cellAtoms, matrix3<>* E_xxT);
+};
+
+//! Smooth particle-mesh Ewald sum \cite SPME for periodic and slab geometries.
+//! The long-ranged part is computed by spreading gaussian-smoothed charges onto gInfo with B-splines
+//! and applying the (truncated) Coulomb kernel of the geometry in reciprocal space,
+//! and the short-ranged part is the usual real-space sum, using EwaldRealSpace.
+//! The gaussian width is set by the resolution of gInfo, so that the cost is O(N) + O(nr log nr) for N atoms.
+class EwaldSPME : public Ewald
+{
+public:
+	//! Set up SPME on grid gInfo, given the Coulomb kernel on that grid (for the geometry in params),
+	//! using ewaldExact to check the accuracy of the first evaluation, and for lattice derivatives
+	EwaldSPME(const GridInfo& gInfo, const RealKernel& coulombKernel, const CoulombParams& params,
+		std::shared_ptr<Ewald> ewaldExact=0);
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT=0) const;
+
+	static void bSplines(double w, int order, double* M, double* Mprime); //!< B-spline weights M(w+j) and derivatives for j=0 to order-1, given fractional offset w in [0,1)
+
+private:
+	const GridInfo& gInfo;
+	const CoulombParams& params;
+	int order; //!< B-spline order
+	vector3<bool> isTruncated; //!< truncated directions
+	double sigma; //!< gaussian width for Ewald sums
+	std::shared_ptr<EwaldRealSpace> realSpace; //!< real-space part
+	RealKernel kernel; //!< long-range kernel including gaussian smoothing and B-spline structure factor correction
+	std::shared_ptr<Ewald> ewaldExact; //!< exact Ewald sum for checking accuracy
+	mutable bool checked; //!< whether accuracy has been checked against ewaldExact
+
+	double energyAndGrad_sub(std::vector<Atom>& atoms) const;
+};
+
+//! @}
+#endif // JDFTX_CORE_COULOMB_EWALD_H
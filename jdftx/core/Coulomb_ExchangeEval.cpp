@@ -527,23 +527,56 @@ complexScalarFieldTilde ExchangeEval::operator()(complexScalarFieldTilde&& in, v
 			break;
 		}
 		case NumericalKernel:
-		{	//Find the appropriate kDiff:
-			bool kDiffFound = false;
-			for(unsigned ik=0; ik<dkArr.size(); ik++)
-				if(circDistanceSquared(dkArr[ik], kDiff) < symmThresholdSq)
-				{	//Find the integer offset, if any:
-					double err;
-					vector3<int> offset = round(dkArr[ik] - kDiff, &err);
-					assert(err < symmThreshold);
-					//Multiply kernel:
-					multTransformedKernel(in, kernelData.dataPref() + gInfo.nr * ik, offset);
-					kDiffFound = true;
-					break;
-				}
-			assert(kDiffFound);
+		{	vector3<int> offset;
+			const double* kernel = getKernel(kDiff, offset);
+			multTransformedKernel(in, kernel, offset);
 			break;
 		}
 	}
 	#undef CALL_exchangeAnalytic
 	return in;
 }
+
+const double* ExchangeEval::getKernel(vector3<> kDiff, vector3<int>& offset) const
+{	//Find the appropriate kDiff:
+	for(unsigned ik=0; ik<dkArr.size(); ik++)
+		if(circDistanceSquared(dkArr[ik], kDiff) < symmThresholdSq)
+		{	//Find the integer offset, if any:
+			double err;
+			offset = round(dkArr[ik] - kDiff, &err);
+			assert(err < symmThreshold);
+			return kernelData.dataPref() + gInfo.nr * ik;
+		}
+	assert(!"kDiff not found in k-point difference mesh");
+	return 0;
+}
+
+//Multiply a batch of fields by the same kernel (sampled with offset) in a single sweep, so that each kernel entry is loaded once:
+void multTransformedKernelBatch_thread(size_t iStart, size_t iStop,
+	const vector3<int>& S, const double* kernel, complex* const* data, int nBatch, const vector3<int>& offset)
+{	THREAD_fullGspaceLoop
+	(	vector3<int> iGkernel = (iG - offset); //Compute index on the real kernel
+		for(int k=0; k<3; k++) if(iGkernel[k]<0) iGkernel[k] += S[k]; //Reduce to [0,S-1) in each dimension
+		double K = kernel[iGkernel[2] + S[2]*size_t(iGkernel[1] + S[1]*iGkernel[0])];
+		for(int b=0; b<nBatch; b++)
+			data[b][i] *= K;
+	)
+}
+
+void ExchangeEval::operator()(std::vector<complexScalarFieldTilde>& in, vector3<> kDiff) const
+{
+	#ifndef GPU_ENABLED
+	if(kernelMode==NumericalKernel && in.size()>1)
+	{	vector3<int> offset;
+		const double* kernel = getKernel(kDiff, offset);
+		std::vector<complex*> data(in.size());
+		for(size_t b=0; b<in.size(); b++)
+			data[b] = in[b]->data(false);
+		threadLaunch(multTransformedKernelBatch_thread, gInfo.nr, gInfo.S, kernel, (complex* const*)data.data(), int(in.size()), offset);
+		return;
+	}
+	#endif
+	//Analytic kernels (already a single sweep per field without any kernel data), or GPU:
+	for(complexScalarFieldTilde& x: in)
+		x = (*this)((complexScalarFieldTilde&&)x, kDiff);
+}
@@ -32,6 +32,7 @@ struct ExchangeEval
 	ExchangeEval(const GridInfo& gInfo, const CoulombParams& params, const Coulomb& coulomb, double omega);
 	~ExchangeEval();
 	complexScalarFieldTilde operator()(complexScalarFieldTilde&& in, vector3<> kDiff) const;
+	void operator()(std::vector<complexScalarFieldTilde>& in, vector3<> kDiff) const; //!< apply kernel in place to a batch of fields with the same kDiff
 
 private:
 	const GridInfo& gInfo;
@@ -60,6 +61,7 @@ private:
 	//For precomputed numerical kernel mode:
 	std::vector< vector3<> > dkArr; //list of allowed k-point differences (modulo integer offsets)
 	ManagedArray<double> kernelData; //data for all the kernels
+	const double* getKernel(vector3<> kDiff, vector3<int>& offset) const; //find the kernel for kDiff in kernelData, and the integer offset of kDiff relative to it
 };
 
 //! @}
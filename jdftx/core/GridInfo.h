@@ -119,6 +119,7 @@ public:
 		PlanCtoR, //!< Complex to real transform
 	};
 	fftw_plan getPlan(PlanType planType, int nThreads) const; //get an FFTW plan of specified type with specified thread count
+	static std::mutex planLock; //!< Global lock since FFTW planner routines are not thread safe (hold while creating or destroying any FFTW plan)
 	#ifdef GPU_ENABLED
 	cufftHandle planZ2Z; //!< CUFFT plan for all the complex transforms
 	cufftHandle planD2Z; //!< CUFFT plan for R -> G
@@ -150,7 +151,6 @@ private:
 	
 	//FFTW plans by thread count and type:
 	std::map<std::pair<PlanType,int>,fftw_plan> planCache;
-	static std::mutex planLock; //Global lock since planner routines are not thread safe
 };
 
 //! @}
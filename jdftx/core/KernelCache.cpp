@@ -0,0 +1,208 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/KernelCache.h>
+#include <core/Util.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+//----------------- class KernelCacheKey -------------------
+
+KernelCacheKey::KernelCacheKey(string name) : name(name)
+{
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(double x)
+{	char buf[32]; sprintf(buf, "%.17g ", x);
+	params += buf;
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(int i)
+{	char buf[32]; sprintf(buf, "%d ", i);
+	params += buf;
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(size_t i)
+{	char buf[32]; sprintf(buf, "%zu ", i);
+	params += buf;
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(const string& s)
+{	params += "'" + s + "' ";
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(const vector3<>& v)
+{	for(int k=0; k<3; k++) (*this) << v[k];
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(const vector3<int>& v)
+{	for(int k=0; k<3; k++) (*this) << v[k];
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(const matrix3<>& m)
+{	for(int i=0; i<3; i++)
+		for(int j=0; j<3; j++)
+			(*this) << m(i,j);
+	return *this;
+}
+
+KernelCacheKey& KernelCacheKey::operator<<(const std::vector<double>& arr)
+{	char buf[64]; sprintf(buf, "[%zu:%016" PRIx64 "] ", arr.size(), hash(arr.data(), arr.size()*sizeof(double)));
+	params += buf;
+	return *this;
+}
+
+uint64_t KernelCacheKey::hash() const
+{	return hash(params.data(), params.length(), hash(name.data(), name.length()));
+}
+
+uint64_t KernelCacheKey::hash(const void* data, size_t nBytes, uint64_t h)
+{	const unsigned char* bytes = (const unsigned char*)data;
+	for(size_t i=0; i<nBytes; i++)
+	{	h ^= bytes[i];
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+//----------------- namespace KernelCache -------------------
+
+namespace KernelCache
+{
+	const uint64_t magic = 0x3143484b58544644ULL; //"DFTXKHC1" on little-endian machines (files from other endianness are rejected)
+
+	//File layout: header, followed by params string (nParamBytes) and then data (nData doubles)
+	struct Header
+	{	uint64_t magic, keyHash, nParamBytes, nData, dataHash;
+	};
+
+	string cacheDir; //set by init()
+
+	void init()
+	{	//Get directory from head (to ensure consistency across processes):
+		const char* dir = getenv("JDFTX_KERNEL_CACHE");
+		if(dir) cacheDir = dir;
+		mpiWorld->bcast(cacheDir);
+	}
+
+	const char* directory()
+	{	return cacheDir.length() ? cacheDir.c_str() : 0;
+	}
+
+	bool enabled()
+	{	return directory();
+	}
+
+	string filename(const KernelCacheKey& key)
+	{	char buf[32]; sprintf(buf, "_%016" PRIx64 ".bin", key.hash());
+		return string(directory()) + "/" + key.getName() + buf;
+	}
+
+	//Read and validate a cache file (on the calling process alone), copying the data to getBuffer(nData),
+	//which returns the destination for nData doubles (or null to reject that length):
+	template<typename GetBuffer> bool loadLocal(const string& fname, const KernelCacheKey& key, const GetBuffer& getBuffer)
+	{	int fd = open(fname.c_str(), O_RDONLY);
+		if(fd < 0) return false;
+		off_t fsize = lseek(fd, 0, SEEK_END);
+		bool success = false;
+		if(fsize >= off_t(sizeof(Header)))
+		{	void* map = mmap(0, fsize, PROT_READ, MAP_SHARED, fd, 0);
+			if(map != MAP_FAILED)
+			{	const Header& h = *((const Header*)map);
+				const char* params = (const char*)map + sizeof(Header);
+				const char* dataPtr = params + h.nParamBytes;
+				const string& keyParams = key.getParams();
+				if(h.magic==magic && h.keyHash==key.hash() && h.nParamBytes==keyParams.length()
+					&& off_t(sizeof(Header) + h.nParamBytes + h.nData*sizeof(double)) == fsize
+					&& !memcmp(params, keyParams.data(), h.nParamBytes)
+					&& KernelCacheKey::hash(dataPtr, h.nData*sizeof(double)) == h.dataHash)
+				{	double* data = getBuffer(h.nData);
+					if(data)
+					{	memcpy(data, dataPtr, h.nData*sizeof(double));
+						success = true;
+					}
+				}
+				munmap(map, fsize);
+			}
+		}
+		close(fd);
+		return success;
+	}
+
+	bool load(const KernelCacheKey& key, std::vector<double>& data)
+	{	if(!enabled()) return false;
+		//Read on head and broadcast, so that all processes agree on whether to compute (which may involve collectives):
+		string fname = filename(key);
+		bool success = mpiWorld->isHead() && loadLocal(fname, key, [&](size_t nData) { data.resize(nData); return data.data(); });
+		mpiWorld->bcast(success);
+		if(!success) return false;
+		unsigned long nData = data.size();
+		mpiWorld->bcast(nData);
+		data.resize(nData);
+		mpiWorld->bcast(data.data(), nData);
+		logPrintf("Loaded cached '%s' kernel from '%s'.\n", key.getName().c_str(), fname.c_str());
+		return true;
+	}
+
+	bool load(const KernelCacheKey& key, double* data, size_t nData)
+	{	if(!enabled()) return false;
+		string fname = filename(key);
+		bool success = mpiWorld->isHead() && loadLocal(fname, key, [&](size_t nDataFile) { return (nDataFile==nData) ? data : (double*)0; });
+		mpiWorld->bcast(success);
+		if(!success) return false;
+		mpiWorld->bcast(data, nData);
+		logPrintf("Loaded cached '%s' kernel from '%s'.\n", key.getName().c_str(), fname.c_str());
+		return true;
+	}
+
+	void save(const KernelCacheKey& key, const double* data, size_t nData)
+	{	if(!enabled() || !mpiWorld->isHead()) return;
+		string fname = filename(key);
+		char suffix[64]; sprintf(suffix, ".tmp%d", int(getpid()));
+		string fnameTmp = fname + suffix;
+		FILE* fp = fopen(fnameTmp.c_str(), "wb");
+		if(!fp)
+		{	logPrintf("WARNING: could not write kernel cache file '%s'.\n", fnameTmp.c_str());
+			return;
+		}
+		const string& params = key.getParams();
+		Header h;
+		h.magic = magic;
+		h.keyHash = key.hash();
+		h.nParamBytes = params.length();
+		h.nData = nData;
+		h.dataHash = KernelCacheKey::hash(data, nData*sizeof(double));
+		bool ok = (fwrite(&h, sizeof(Header), 1, fp) == 1)
+			&& (fwrite(params.data(), 1, params.length(), fp) == params.length())
+			&& (fwrite(data, sizeof(double), nData, fp) == nData);
+		ok = (fclose(fp)==0) && ok;
+		if(!ok || rename(fnameTmp.c_str(), fname.c_str()) != 0)
+		{	logPrintf("WARNING: could not write kernel cache file '%s'.\n", fname.c_str());
+			unlink(fnameTmp.c_str());
+		}
+	}
+}
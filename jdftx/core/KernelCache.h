@@ -0,0 +1,88 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_KERNELCACHE_H
+#define JDFTX_CORE_KERNELCACHE_H
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file KernelCache.h Persistent on-disk cache of expensive precomputed kernels, shared between runs
+
+#include <core/string.h>
+#include <core/matrix3.h>
+#include <vector>
+#include <cstdint>
+
+//! Description of all the parameters that a cached kernel depends on
+class KernelCacheKey
+{
+public:
+	KernelCacheKey(string name); //!< name identifies the kind of kernel (and prefixes the cache filename)
+
+	KernelCacheKey& operator<<(double x); //!< add a parameter (exactly, at full precision)
+	KernelCacheKey& operator<<(int i); //!< add a parameter
+	KernelCacheKey& operator<<(size_t i); //!< add a parameter
+	KernelCacheKey& operator<<(const string& s); //!< add a parameter
+	KernelCacheKey& operator<<(const vector3<>& v); //!< add a parameter
+	KernelCacheKey& operator<<(const vector3<int>& v); //!< add a parameter
+	KernelCacheKey& operator<<(const matrix3<>& m); //!< add a parameter
+	KernelCacheKey& operator<<(const std::vector<double>& arr); //!< add an array parameter (by its length and hash)
+
+	const string& getName() const { return name; }
+	const string& getParams() const { return params; } //!< canonical text representation of parameters
+	uint64_t hash() const; //!< hash of name and parameters
+
+	static uint64_t hash(const void* data, size_t nBytes, uint64_t h=0xcbf29ce484222325ULL); //!< 64-bit FNV-1a hash (continued from h, if specified)
+private:
+	string name, params;
+};
+
+//! Persistent cache of kernels (arrays of doubles) in the directory specified by the environment variable JDFTX_KERNEL_CACHE.
+//! Cache files are named by kernel and parameter hash, and are validated against the complete parameter description
+//! and a checksum of the data on loading, so that a corrupt or mismatched file is simply recomputed and overwritten.
+//! The cache is disabled if JDFTX_KERNEL_CACHE is unset.
+namespace KernelCache
+{
+	void init(); //!< configure from JDFTX_KERNEL_CACHE on the head process (called from initSystem)
+	bool enabled(); //!< whether a cache directory has been specified
+
+	//! Retrieve data for key from the cache, if available (memory-mapped read on the head process, broadcast to others).
+	//! Returns whether successful (consistently on all processes).
+	bool load(const KernelCacheKey& key, std::vector<double>& data);
+
+	//! Retrieve data for key directly into a preallocated buffer of nData doubles (avoiding a temporary copy for large kernels).
+	//! Fails (consistently on all processes) if the cache is unavailable or the cached data does not have exactly nData entries.
+	bool load(const KernelCacheKey& key, double* data, size_t nData);
+
+	//! Save data for key to the cache (from head process only; no-op if cache is disabled).
+	//! The file is written under a temporary name and then renamed, so that concurrent runs never see partial files.
+	void save(const KernelCacheKey& key, const double* data, size_t nData);
+	inline void save(const KernelCacheKey& key, const std::vector<double>& data) { save(key, data.data(), data.size()); } //!< save data for key from an std::vector
+
+	//! Load data for key from the cache if available, and otherwise compute it using compute(data) and save it
+	template<typename Compute> void get(const KernelCacheKey& key, std::vector<double>& data, const Compute& compute)
+	{	if(load(key, data)) return;
+		compute(data);
+		save(key, data);
+	}
+}
+
+//! @}
+#endif // JDFTX_CORE_KERNELCACHE_H
@@ -37,6 +37,9 @@ MPIUtil::ProcDivision::ProcDivision(const MPIUtil *mpiUtil, size_t nGroups, size
 
 //---------- class MPIUtil ----------
 
+bool MPIUtil::timeCollectives = false;
+double MPIUtil::tCollectives = 0.;
+
 MPIUtil::MPIUtil(int argc, char** argv, ProcDivision procDivision)
 : procDivision(procDivision)
 {
@@ -67,6 +67,9 @@ public:
 
 	void checkErrors(const ostringstream&) const; //!< collect error messages from all processes; if any, display them and quit
 	
+	static bool timeCollectives; //!< whether to accumulate the time spent in broadcasts and reductions (enabled by Metrics for load-imbalance reports)
+	static double tCollectives; //!< accumulated time in seconds spent in broadcasts and reductions (by all MPIUtil objects, if timeCollectives)
+	
 	//Point-to-point functions:
 	template<typename T> void send(const T* data, size_t nData, int dest, int tag) const; //!< generic array send
 	template<typename T> void recv(T* data, size_t nData, int src, int tag) const; //!< generic array receive
@@ -151,6 +154,13 @@ namespace MPIUtilPrivate
 	DECLARE_DataType(double, DOUBLE)
 	#undef DECLARE_DataType
 	
+	//! Accumulate the duration of a blocking collective operation in MPIUtil::tCollectives (if enabled)
+	struct CollectiveTimer
+	{	double tStart;
+		CollectiveTimer() : tStart(MPIUtil::timeCollectives ? MPI_Wtime() : 0.) {}
+		~CollectiveTimer() { if(MPIUtil::timeCollectives) MPIUtil::tCollectives += MPI_Wtime() - tStart; }
+	};
+	
 	static inline MPI_Op mpiOp(MPIUtil::ReduceOp op)
 	{	switch(op)
 		{	case MPIUtil::ReduceMax: return MPI_MAX;
@@ -211,7 +221,7 @@ template<typename T> void MPIUtil::recv(T& data, int src, int tag) const
 template<typename T> void MPIUtil::bcast(T* data, size_t nData, int root) const
 {	using namespace MPIUtilPrivate;
 	#ifdef MPI_ENABLED
-	if(nProcs>1) MPI_Bcast(data, nData, DataType<T>::get(), root, comm);
+	if(nProcs>1) { CollectiveTimer timer; MPI_Bcast(data, nData, DataType<T>::get(), root, comm); }
 	#endif
 }
 
@@ -224,11 +234,13 @@ template<typename T> void MPIUtil::allReduce(T* data, size_t nData, MPIUtil::Red
 	#ifdef MPI_ENABLED
 	if(nProcs>1)
 	{	if(safeMode) //Reduce to root node and then broadcast result (to ensure identical values)
-		{	MPI_Reduce(isHead()?MPI_IN_PLACE:data, data, nData, DataType<T>::get(), mpiOp(op), 0, comm);
+		{	{ CollectiveTimer timer; MPI_Reduce(isHead()?MPI_IN_PLACE:data, data, nData, DataType<T>::get(), mpiOp(op), 0, comm); }
 			bcast(data, nData, 0);
 		}
 		else //standard Allreduce
+		{	CollectiveTimer timer;
 			MPI_Allreduce(MPI_IN_PLACE, data, nData, DataType<T>::get(), mpiOp(op), comm);
+		}
 	}
 	#endif
 }
@@ -243,6 +255,7 @@ template<typename T> void MPIUtil::allReduce(T& data, int& index, MPIUtil::Reduc
 	if(nProcs>1)
 	{	struct Pair { T data; int index; } pair;
 		pair.data = data; pair.index = index;
+		CollectiveTimer timer;
 		MPI_Allreduce(MPI_IN_PLACE, &pair, 1, DataTypeIntPair<T>::get(), mpiLocOp(op), comm);
 		data = pair.data; index = pair.index;
 	}
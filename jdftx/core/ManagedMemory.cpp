@@ -28,28 +28,18 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace MemUsageReport
 {
-	enum Mode { Add, Remove, Print };
+	enum Mode { Add, Remove, Print, Get };
+	
+	#ifdef ENABLE_PROFILING
+	bool enabled = true;
+	#else
+	bool enabled = false; //enabled at run time by ManagedMemoryBase::enableUsageTracking
+	#endif
 	
 	//Add, remove or retrieve memory report based on mode
-	void manager(Mode mode, string category=string(), size_t nBytes=0)
-	{	
-		#ifdef ENABLE_PROFILING
-		struct Usage
-		{	size_t current, peak; //!< current and peak memory usage (in unit of complex numbers i.e. 16 bytes)
-			Usage() : current(0), peak(0) {}
-			
-			Usage& operator+=(size_t n)
-			{	current += n;
-				if(current > peak)
-					peak = current;
-				return *this;
-			}
-			
-			Usage& operator-=(size_t n)
-			{	current -= n;
-				return *this;
-			}
-		};
+	void manager(Mode mode, string category=string(), size_t nBytes=0, std::map<string,ManagedMemoryBase::Usage>* result=0)
+	{	if(!enabled) return;
+		typedef ManagedMemoryBase::Usage Usage;
 		static std::map<string, Usage> usageMap;
 		static Usage usageTotal;
 		static std::mutex usageLock;
@@ -68,16 +58,18 @@ namespace MemUsageReport
 					logPrintf("MEMUSAGE: %30s %12.6lf GB\n", category.c_str(), (usageMap[category].current+nBytes)*bytesToGB);
 				}
 				*/
-				usageMap[category] += nBytes;
-				usageTotal += nBytes;
+				for(Usage* usage: { &usageMap[category], &usageTotal })
+				{	usage->current += nBytes;
+					usage->peak = std::max(usage->peak, usage->current);
+				}
 				usageLock.unlock();
 				assert(category.length());
 				break;
 			}
 			case Remove:
 			{	usageLock.lock();
-				usageMap[category] -= nBytes;
-				usageTotal -= nBytes;
+				for(Usage* usage: { &usageMap[category], &usageTotal })
+					usage->current -= std::min(usage->current, nBytes); //clamp for memory allocated before tracking was enabled
 				usageLock.unlock();
 				assert(category.length());
 				break;
@@ -88,8 +80,14 @@ namespace MemUsageReport
 				logPrintf("MEMUSAGE: %30s %12.6lf GB\n", "Total", usageTotal.peak * bytesToGB);
 				break;
 			}
+			case Get:
+			{	usageLock.lock();
+				*result = usageMap;
+				(*result)["Total"] = usageTotal;
+				usageLock.unlock();
+				break;
+			}
 		}
-		#endif //ENABLE_PROFILING
 	}
 }
 
@@ -263,6 +261,16 @@ void ManagedMemoryBase::reportUsage()
 {	MemUsageReport::manager(MemUsageReport::Print);
 }
 
+void ManagedMemoryBase::enableUsageTracking()
+{	MemUsageReport::enabled = true;
+}
+
+std::map<string,ManagedMemoryBase::Usage> ManagedMemoryBase::getUsage()
+{	std::map<string,Usage> result;
+	MemUsageReport::manager(MemUsageReport::Get, string(), 0, &result);
+	return result;
+}
+
 //Free memory
 void ManagedMemoryBase::memFree()
 {	if(!nBytes) return; //nothing to free
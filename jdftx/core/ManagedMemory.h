@@ -35,6 +35,14 @@ class ManagedMemoryBase
 public:
 	static void reportUsage(); //!< print memory usage report
 
+	//! Current and peak (high-water mark) memory usage of one category, in bytes
+	struct Usage
+	{	size_t current, peak;
+		Usage() : current(0), peak(0) {}
+	};
+	static void enableUsageTracking(); //!< track usage by category from now on (always on in builds with EnableProfiling)
+	static std::map<string,Usage> getUsage(); //!< usage by category, with the overall usage under "Total" (empty if not tracking)
+
 protected:
 	ManagedMemoryBase(): nBytes(0),c(0),onGpu(false) {} //!< Initialize a valid state, but don't allocate anything
 	~ManagedMemoryBase() { memFree(); }
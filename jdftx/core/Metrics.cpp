@@ -0,0 +1,150 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Metrics.h>
+#include <core/ManagedMemory.h>
+#include <core/Thread.h>
+#include <cmath>
+#include <map>
+
+namespace Metrics
+{
+	bool enabled = false;
+	FILE* fp = 0; //output stream (only on head process)
+
+	//Time and accumulated collective time at the previous record of each type:
+	struct Mark
+	{	double t, tCollectives;
+		Mark() : t(0.), tCollectives(0.) {}
+	};
+	std::map<string,Mark> prevMarks;
+
+	void init()
+	{	//Get filename from head (to ensure consistency across processes):
+		string filename;
+		const char* filenameStr = getenv("JDFTX_METRICS");
+		if(filenameStr) filename = filenameStr;
+		mpiWorld->bcast(filename);
+		if(!filename.length()) return;
+		enabled = true;
+		MPIUtil::timeCollectives = true;
+		ManagedMemoryBase::enableUsageTracking();
+		if(mpiWorld->isHead())
+		{	fp = fopen(filename.c_str(), "w");
+			if(fp)
+			{	setvbuf(fp, 0, _IOLBF, 0); //line buffered, for live monitoring
+				logPrintf("Writing metrics stream to '%s'.\n", filename.c_str());
+			}
+			else logPrintf("WARNING: could not open metrics stream '%s' for writing.\n", filename.c_str());
+		}
+		Record("start").add("nProcesses", mpiWorld->nProcesses()).add("nThreads", nProcsAvailable).emit();
+	}
+
+	void finalize(bool successful)
+	{	if(!enabled) return;
+		Record("end").add("successful", successful).emit(mpiWorld);
+		if(fp) fclose(fp);
+		fp = 0;
+		enabled = false;
+	}
+
+	//Output helpers:
+	string jsonString(const string& s)
+	{	string result("\"");
+		for(char c: s)
+		{	if(c=='"' || c=='\\') result += '\\';
+			result += c;
+		}
+		return result + '"';
+	}
+	string jsonNumber(double x)
+	{	if(!std::isfinite(x)) return "null"; //not representable in JSON
+		char buf[32]; snprintf(buf, sizeof(buf), "%.15lg", x);
+		return buf;
+	}
+
+	Record::Record(string type)
+	{	size_t start = type.find_first_not_of(" \t\n:");
+		size_t stop = type.find_last_not_of(" \t\n:");
+		if(start != string::npos)
+			this->type = type.substr(start, stop+1-start);
+	}
+
+	Record& Record::add(string key, double value)
+	{	if(enabled) oss << ',' << jsonString(key) << ':' << jsonNumber(value);
+		return *this;
+	}
+
+	Record& Record::add(string key, int value)
+	{	if(enabled) oss << ',' << jsonString(key) << ':' << value;
+		return *this;
+	}
+
+	Record& Record::add(string key, bool value)
+	{	if(enabled) oss << ',' << jsonString(key) << ':' << (value ? "true" : "false");
+		return *this;
+	}
+
+	Record& Record::add(string key, string value)
+	{	if(enabled) oss << ',' << jsonString(key) << ':' << jsonString(value);
+		return *this;
+	}
+
+	void Record::emit(const MPIUtil* mpiUtil)
+	{	if(!enabled) return;
+		//Interval since previous record of same type:
+		double t = clock_sec();
+		Mark& prev = prevMarks[type];
+		double dt = t - prev.t;
+		double dtBusy = dt - (MPIUtil::tCollectives - prev.tCollectives);
+		std::map<string,ManagedMemoryBase::Usage> usage = ManagedMemoryBase::getUsage();
+
+		ostringstream out;
+		out << "{\"type\":" << jsonString(type) << ",\"t\":" << jsonNumber(t) << ",\"dt\":" << jsonNumber(dt) << oss.str();
+
+		//Memory usage:
+		out << ",\"mem\":{";
+		for(auto iter=usage.begin(); iter!=usage.end(); iter++)
+			out << (iter==usage.begin() ? "" : ",") << jsonString(iter->first)
+				<< ":{\"current\":" << iter->second.current << ",\"peak\":" << iter->second.peak << '}';
+		out << '}';
+
+		//Load imbalance:
+		if(mpiUtil)
+		{	double busyMin = dtBusy, busyMax = dtBusy, busyMean = dtBusy;
+			double memPeakMax = usage["Total"].peak;
+			mpiUtil->allReduce(busyMin, MPIUtil::ReduceMin);
+			mpiUtil->allReduce(busyMax, MPIUtil::ReduceMax);
+			mpiUtil->allReduce(busyMean, MPIUtil::ReduceSum); busyMean /= mpiUtil->nProcesses();
+			mpiUtil->allReduce(memPeakMax, MPIUtil::ReduceMax);
+			out << ",\"mpi\":{\"nProcesses\":" << mpiUtil->nProcesses()
+				<< ",\"busyMin\":" << jsonNumber(busyMin)
+				<< ",\"busyMean\":" << jsonNumber(busyMean)
+				<< ",\"busyMax\":" << jsonNumber(busyMax)
+				<< ",\"imbalance\":" << jsonNumber(busyMean>0. ? busyMax/busyMean-1. : 0.)
+				<< ",\"memPeakMax\":" << jsonNumber(memPeakMax) << '}';
+		}
+		out << '}';
+
+		//Set marks after communication above, so that it is not attributed to the next interval:
+		prev.t = clock_sec();
+		prev.tCollectives = MPIUtil::tCollectives;
+		if(fp) fprintf(fp, "%s\n", out.str().c_str());
+	}
+}
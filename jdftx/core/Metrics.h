@@ -0,0 +1,70 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_METRICS_H
+#define JDFTX_CORE_METRICS_H
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file Metrics.h Machine-readable stream of calculation progress and performance metrics
+
+#include <core/MPIUtil.h>
+#include <sstream>
+
+/** Structured metrics stream, enabled by setting environment variable JDFTX_METRICS to a file name
+(which may also be a named pipe for live monitoring). The head process writes one JSON object per line, containing:
+ - "type": source of the record, such as start, stage, end, or the line prefix of a minimizer (ElecMinimize, IonicMinimize, SCF etc.)
+ - "t": wall time in seconds since start-up, and "dt": time since the previous record of the same type
+ - source-specific values such as the iteration number, energies, residuals and step sizes
+ - "mem": current and peak (high-water mark) managed memory in bytes on the head process,
+   by the same categories as ManagedMemoryBase::reportUsage, and in total
+ - "mpi": minimum, mean and maximum over processes of the busy time (dt excluding time spent in MPIUtil broadcasts and reductions),
+   the load imbalance (maximum / mean - 1), and the maximum peak memory of any process;
+   present only in records that are emitted collectively by all processes of a calculation
+*/
+namespace Metrics
+{
+	extern bool enabled; //!< whether the metrics stream is active
+	void init(); //!< configure from JDFTX_METRICS (called from initSystem)
+	void finalize(bool successful); //!< write the final record and close the stream (called from finalizeSystem)
+
+	//! One record of the metrics stream: add values with chained calls to add(), and then call emit()
+	class Record
+	{
+	public:
+		Record(string type); //!< leading and trailing whitespace / colons are dropped, so that log line prefixes may be used directly
+		Record& add(string key, double value);
+		Record& add(string key, int value);
+		Record& add(string key, bool value);
+		Record& add(string key, string value);
+		Record& add(string key, const char* value) { return add(key, string(value)); } //!< (prevents string literals from converting to bool)
+
+		//! Write the record to the stream (no-op unless enabled). If mpiUtil is non-null, this must be called
+		//! from all processes of mpiUtil, and the record then also reports load imbalance over those processes.
+		void emit(const MPIUtil* mpiUtil=0);
+
+	private:
+		string type;
+		std::ostringstream oss; //!< values added so far
+	};
+}
+
+//! @}
+#endif // JDFTX_CORE_METRICS_H
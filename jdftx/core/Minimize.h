@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/MinimizeParams.h>
 #include <core/Util.h>
+#include <core/Metrics.h>
 #include <deque>
 #include <cmath>
 #include <cfloat>
@@ -62,6 +63,9 @@ template<typename Vector> struct Minimizable
 	//! Override to synchronize scalars over MPI processes (if the same minimization is happening in sync over many processes)
 	virtual double sync(double x) const { return x; }
 	
+	//! Override to return the processes that perform this minimization in sync (to include their load imbalance in the Metrics stream)
+	virtual const MPIUtil* metricsComm() const { return 0; }
+	
 	//! Override to return maximum safe step size along a given direction. Steps can be arbitrarily large by default.
 	virtual double safeStepSize(const Vector& dir) const { return DBL_MAX; }
 	
@@ -163,6 +167,8 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 		fprintf(p.fpLog, "%sIter: %3d  %s: ", p.linePrefix, iter, p.energyLabel);
 		fprintf(p.fpLog, p.energyFormat, E);
 		fprintf(p.fpLog, "  |grad|_K: %10.3le  alpha: %10.3le", sqrt(gKNorm/p.nDim), alpha);
+		Metrics::Record record(p.linePrefix);
+		record.add("iter", iter).add("energyLabel", p.energyLabel).add("energy", E).add("gradK", sqrt(gKNorm/p.nDim)).add("alpha", alpha);
 
 		//Print prev step stats and set CG direction parameter if necessary
 		beta = 0.0;
@@ -170,9 +176,13 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 		{	double dotgd = sync(dot(g,d));
 			double dotgPrevKg = gPrevUsed ? sync(dot(gPrev, Kg)) : 0.;
 
-			fprintf(p.fpLog, "  linmin: %10.3le", dotgd/sqrt(sync(dot(g,g))*sync(dot(d,d))));
+			double linminTest = dotgd/sqrt(sync(dot(g,g))*sync(dot(d,d)));
+			fprintf(p.fpLog, "  linmin: %10.3le", linminTest);
+			record.add("linmin", linminTest);
 			if(gPrevUsed)
-				fprintf(p.fpLog, "  cgtest: %10.3le", dotgPrevKg/sqrt(gKNorm*gKNormPrev));
+			{	fprintf(p.fpLog, "  cgtest: %10.3le", dotgPrevKg/sqrt(gKNorm*gKNormPrev));
+				record.add("cgtest", dotgPrevKg/sqrt(gKNorm*gKNormPrev));
+			}
 			fprintf(p.fpLog, "  t[s]: %9.2lf", clock_sec());
 
 			//Update beta:
@@ -190,6 +200,7 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 		}
 		forceGradDirection = false;
 		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
+		if(metricsComm() || p.fpLog != nullLog) record.emit(metricsComm());
 		if(sqrt(gKNorm/p.nDim) < p.knormThreshold)
 		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
 			fflush(p.fpLog); return E;
@@ -68,9 +68,16 @@ template<typename Vector> double Minimizable<Vector>::lBFGS(const MinimizeParams
 		if(alpha) fprintf(p.fpLog, "  alpha: %10.3le", alpha);
 		if(linminTest) fprintf(p.fpLog, "  linmin: %10.3le", linminTest);
 		fprintf(p.fpLog, "  t[s]: %9.2lf", clock_sec());
+		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
+		if(metricsComm() || p.fpLog != nullLog)
+		{	Metrics::Record record(p.linePrefix);
+			record.add("iter", iter).add("energyLabel", p.energyLabel).add("energy", E).add("gradK", sqrt(gKnorm/p.nDim));
+			if(alpha) record.add("alpha", alpha);
+			if(linminTest) record.add("linmin", linminTest);
+			record.emit(metricsComm());
+		}
 		
 		//Check stopping conditions:
-		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
 		if(sqrt(gKnorm/p.nDim) < p.knormThreshold)
 		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
 			fflush(p.fpLog); return E;
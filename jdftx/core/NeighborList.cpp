@@ -0,0 +1,125 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/NeighborList.h>
+#include <core/Thread.h>
+
+NeighborList::NeighborList(double rCut, double skin) : rCut(rCut), skin(skin)
+{
+}
+
+bool NeighborList::update(const matrix3<>& R, const std::vector< vector3<> >& pos, vector3<bool> isTruncated)
+{	bool rebuild = !(R == this->R) || !(isTruncated == this->isTruncated) || pos.size() != posBuild.size();
+	if(!rebuild)
+	{	//Check displacements (modulo lattice vectors) since last build:
+		double dMaxSq = 0.25*skin*skin;
+		for(size_t i=0; i<pos.size(); i++)
+		{	vector3<> d = pos[i] - posBuild[i];
+			for(int k=0; k<3; k++)
+				if(!isTruncated[k]) d[k] -= floor(0.5 + d[k]);
+			if((R*d).length_squared() > dMaxSq) { rebuild = true; break; }
+			this->pos[i] = posBuild[i] + d; //consistent with image offsets in list
+		}
+	}
+	if(rebuild)
+	{	this->R = R;
+		this->isTruncated = isTruncated;
+		posBuild = pos;
+		for(vector3<>& x: posBuild)
+			for(int k=0; k<3; k++)
+				if(!isTruncated[k]) x[k] -= floor(0.5 + x[k]); //reduce to [-0.5,0.5) along periodic directions
+		this->pos = posBuild;
+		build();
+	}
+	return rebuild;
+}
+
+//Whether pair (i, j translated by -iR) is listed under atom i (rather than as its reverse under j):
+inline bool ownsPair(int i, int j, const vector3<int>& iR)
+{	if(i == j) return iR[0]>0 || (iR[0]==0 && (iR[1]>0 || (iR[1]==0 && iR[2]>0))); //one of +/-iR
+	return ((i+j) % 2) ? (i > j) : (i < j); //alternate between lower and higher index for load balancing
+}
+
+void NeighborList_build_sub(size_t iStart, size_t iStop, const matrix3<>* RTR, double rMaxSq,
+	const vector3<int>* nCells, const vector3<int>* nReach, const vector3<>* pos,
+	const vector3<int>* atomCell, const int* cellStart, const int* cellAtoms, std::vector<NeighborList::Neighbor>* neighbors)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	std::vector<NeighborList::Neighbor>& list = neighbors[i];
+		list.clear();
+		vector3<int> dCell; //offset to neighbouring cell
+		for(dCell[0]=-(*nReach)[0]; dCell[0]<=(*nReach)[0]; dCell[0]++)
+		for(dCell[1]=-(*nReach)[1]; dCell[1]<=(*nReach)[1]; dCell[1]++)
+		for(dCell[2]=-(*nReach)[2]; dCell[2]<=(*nReach)[2]; dCell[2]++)
+		{	//Wrap neighbouring cell into the unit cell, and determine corresponding lattice vector shift:
+			NeighborList::Neighbor n;
+			vector3<int> cell2; //the neighbouring cell is cell2 translated by -n.iR
+			for(int k=0; k<3; k++)
+			{	int c = atomCell[i][k] + dCell[k];
+				n.iR[k] = (c>=0) ? -(c/(*nCells)[k]) : ((*nCells)[k]-1-c)/(*nCells)[k]; //-floor(c/nCells[k])
+				cell2[k] = c + n.iR[k]*(*nCells)[k];
+			}
+			int c2 = cell2[2] + (*nCells)[2]*(cell2[1] + (*nCells)[1]*cell2[0]);
+			for(int jIndex=cellStart[c2]; jIndex<cellStart[c2+1]; jIndex++)
+			{	n.j = cellAtoms[jIndex];
+				if(!ownsPair(i, n.j, n.iR)) continue;
+				if(RTR->metric_length_squared(n.iR + (pos[i] - pos[n.j])) <= rMaxSq)
+					list.push_back(n);
+			}
+		}
+	}
+}
+
+void NeighborList::build()
+{	double rMax = rCut + skin;
+	//Set up cells:
+	matrix3<> G = (2*M_PI)*inv(R);
+	vector3<int> nCells, nReach;
+	for(int k=0; k<3; k++)
+	{	if(isTruncated[k])
+		{	nCells[k] = 1;
+			nReach[k] = 0; //no images along truncated directions
+		}
+		else
+		{	double planeSpacing = (2*M_PI) / G.row(k).length(); //distance between lattice planes normal to direction k
+			nCells[k] = std::max(1, int(floor(planeSpacing / rMax)));
+			nReach[k] = int(ceil(rMax * nCells[k] / planeSpacing));
+		}
+	}
+	//Bin atoms into cells:
+	int nCellsTot = nCells[0]*nCells[1]*nCells[2];
+	std::vector< vector3<int> > atomCell(pos.size());
+	std::vector<int> cellStart(nCellsTot+1, 0); //atoms in cell c are cellAtoms[cellStart[c]] to cellAtoms[cellStart[c+1]-1]
+	for(size_t i=0; i<pos.size(); i++)
+	{	for(int k=0; k<3; k++)
+			atomCell[i][k] = std::max(0, std::min(nCells[k]-1, int(floor((pos[i][k] + 0.5) * nCells[k]))));
+		cellStart[atomCell[i][2] + nCells[2]*(atomCell[i][1] + nCells[1]*atomCell[i][0]) + 1]++;
+	}
+	for(int c=0; c<nCellsTot; c++)
+		cellStart[c+1] += cellStart[c];
+	std::vector<int> cellAtoms(pos.size());
+	{	std::vector<int> cellNext(cellStart.begin(), cellStart.end()-1);
+		for(size_t i=0; i<pos.size(); i++)
+			cellAtoms[cellNext[atomCell[i][2] + nCells[2]*(atomCell[i][1] + nCells[1]*atomCell[i][0])]++] = i;
+	}
+	//Collect neighbours of each atom:
+	matrix3<> RTR = (~R)*R;
+	neighbors.resize(pos.size());
+	threadLaunch(NeighborList_build_sub, pos.size(), &RTR, rMax*rMax, &nCells, &nReach, pos.data(),
+		atomCell.data(), cellStart.data(), cellAtoms.data(), neighbors.data());
+}
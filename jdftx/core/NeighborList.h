@@ -0,0 +1,70 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_NEIGHBORLIST_H
+#define JDFTX_CORE_NEIGHBORLIST_H
+
+//! @addtogroup Geometry
+//! @{
+
+//! @file NeighborList.h Verlet neighbour lists for pair interactions between atoms
+
+#include <core/matrix3.h>
+#include <vector>
+
+//! Verlet list of atom pairs (including periodic images) within a cutoff radius, constructed using a cell list.
+//! Pairs are listed within rCut + skin, so that the list remains valid (and is reused) for subsequent positions,
+//! until some atom moves by more than half the skin, or the lattice vectors or number of atoms change.
+//! Each unordered pair appears only once (a half list), distributed evenly between the two atoms
+//! so that loops over atoms balance well across threads.
+class NeighborList
+{
+public:
+	NeighborList(double rCut, double skin);
+
+	//! Update the list for atoms at lattice coordinates pos in a lattice with vectors in the columns of R,
+	//! and with periodic images only along the non-truncated directions. Returns true if the list was rebuilt.
+	bool update(const matrix3<>& R, const std::vector< vector3<> >& pos, vector3<bool> isTruncated=vector3<bool>(false,false,false));
+
+	//! A neighbour of atom i: atom j translated by lattice vector -iR
+	struct Neighbor
+	{	int j; //!< index of neighbouring atom
+		vector3<int> iR; //!< lattice vector offset
+	};
+	const std::vector<Neighbor>& operator[](size_t i) const { return neighbors[i]; } //!< neighbours of atom i (within rCut + skin, and without self)
+
+	//! Separation (in lattice coordinates) of neighbour n from atom i, for the positions in the latest update()
+	inline vector3<> separation(size_t i, const Neighbor& n) const { return n.iR + (pos[i] - pos[n.j]); }
+
+	size_t nAtoms() const { return pos.size(); }
+	double getCutoff() const { return rCut; }
+
+private:
+	double rCut, skin;
+	matrix3<> R; //!< lattice vectors at the latest build
+	vector3<bool> isTruncated; //!< truncated directions at the latest build
+	std::vector< vector3<> > pos; //!< positions at the latest update, consistent with the image offsets in the list
+	std::vector< vector3<> > posBuild; //!< positions at the latest build
+	std::vector< std::vector<Neighbor> > neighbors;
+
+	void build();
+};
+
+//! @}
+#endif // JDFTX_CORE_NEIGHBORLIST_H
@@ -124,9 +124,13 @@ complexScalarFieldTilde O(const complexScalarFieldTilde& in) { return in * in->g
 complexScalarFieldTilde O(complexScalarFieldTilde&& in) { return in *= in->gInfo.detR; }
 
 
+//Nominal floating point operation count of an FFT on gInfo's grid (prefactor 5 for complex, 2.5 for real transforms)
+inline double fftFlops(const GridInfo& gInfo, double prefactor) { return prefactor * gInfo.nr * log2(double(gInfo.nr)); }
+
 //Forward transform
 ScalarField I(ScalarFieldTilde&& in, int nThreads)
 {	//CPU c2r transforms destroy input, but this input can be destroyed
+	static StopWatch watch("FFT(c2r)"); watch.start();
 	ScalarField out(ScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
 	cufftExecZ2D(in->gInfo.planZ2D, (double2*)in->dataGpu(false), out->dataGpu(false));
@@ -136,6 +140,7 @@ ScalarField I(ScalarFieldTilde&& in, int nThreads)
 		(fftw_complex*)in->data(false), out->data(false));
 	#endif
 	out->scale = in->scale;
+	watch.addWork(fftFlops(in->gInfo, 2.5), 8.*in->gInfo.nr + 16.*in->gInfo.nG); watch.stop();
 	return out;
 }
 ScalarField I(const ScalarFieldTilde& in, int nThreads)
@@ -147,7 +152,8 @@ ScalarField I(const ScalarFieldTilde& in, int nThreads)
 	#endif
 }
 complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
-{	complexScalarField out(complexScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
+{	static StopWatch watch("FFT(c2c)"); watch.start();
+	complexScalarField out(complexScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_INVERSE);
 	#else
@@ -156,10 +162,12 @@ complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
 	#endif
 	out->scale = in->scale;
+	watch.addWork(fftFlops(in->gInfo, 5.), 32.*in->gInfo.nr); watch.stop();
 	return out;
 }
 complexScalarField I(complexScalarFieldTilde&& in, int nThreads)
 {	//Destructible input (transform in place):
+	static StopWatch watch("FFT(c2c)"); watch.start();
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_INVERSE);
 	#else
@@ -167,12 +175,14 @@ complexScalarField I(complexScalarFieldTilde&& in, int nThreads)
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverseInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
 	#endif
+	watch.addWork(fftFlops(in->gInfo, 5.), 32.*in->gInfo.nr); watch.stop();
 	return std::static_pointer_cast<complexScalarFieldData>(std::static_pointer_cast<FieldData<complex>>(in));
 }
 
 //Forward transform h.c.
 ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 {	//r2c transform does not destroy input (no backing up needed)
+	static StopWatch watch("FFT(r2c)"); watch.start();
 	ScalarFieldTilde out(ScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
 	cufftExecD2Z(in->gInfo.planD2Z, in->dataGpu(false), (double2*)out->dataGpu(false));
@@ -182,10 +192,12 @@ ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 		in->data(false), (fftw_complex*)out->data(false));
 	#endif
 	out->scale = in->scale;
+	watch.addWork(fftFlops(in->gInfo, 2.5), 8.*in->gInfo.nr + 16.*in->gInfo.nG); watch.stop();
 	return out;
 }
 complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
-{	complexScalarFieldTilde out(complexScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
+{	static StopWatch watch("FFT(c2c)"); watch.start();
+	complexScalarFieldTilde out(complexScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_FORWARD);
 	#else
@@ -194,10 +206,12 @@ complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
 	#endif
 	out->scale = in->scale;
+	watch.addWork(fftFlops(in->gInfo, 5.), 32.*in->gInfo.nr); watch.stop();
 	return out;
 }
 complexScalarFieldTilde Idag(complexScalarField&& in, int nThreads)
 {	//Destructible input (transform in place):
+	static StopWatch watch("FFT(c2c)"); watch.start();
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_FORWARD);
 	#else
@@ -205,6 +219,7 @@ complexScalarFieldTilde Idag(complexScalarField&& in, int nThreads)
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForwardInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
 	#endif
+	watch.addWork(fftFlops(in->gInfo, 5.), 32.*in->gInfo.nr); watch.stop();
 	return std::static_pointer_cast<complexScalarFieldTildeData>(std::static_pointer_cast<FieldData<complex>>(in));
 }
 
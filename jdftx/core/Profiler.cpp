@@ -0,0 +1,345 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Util.h>
+#include <core/GpuUtil.h>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <algorithm>
+
+namespace Profiler
+{
+	#ifdef ENABLE_PROFILING
+	bool enabled = true;
+	#else
+	bool enabled = false;
+	#endif
+
+	//Configured outputs:
+	#ifdef ENABLE_PROFILING
+	bool summary = true;
+	#else
+	bool summary = false;
+	#endif
+	string jsonFilename, traceFilename;
+	const size_t nTraceEventsMax = 1<<22; //limit on trace events per process (to bound memory usage)
+
+	std::vector<string> watchNames; //names of all watches, indexed by StopWatch::id
+	std::mutex lock; //guards watchNames and all the merged data below
+
+	//Node in the call tree of timed intervals
+	struct Node
+	{	int watchId, parent;
+		std::map<int,int> children; //index of child node by watch id
+		size_t nCalls;
+		double tTot, tSqTot, tChildren; //total, total squared and total within children (in microseconds)
+		double flops, bytes; //work recorded by StopWatch::addWork
+
+		Node(int watchId=-1, int parent=-1) : watchId(watchId), parent(parent), nCalls(0), tTot(0.), tSqTot(0.), tChildren(0.), flops(0.), bytes(0.) {}
+	};
+
+	//Call tree of timed intervals:
+	struct Tree
+	{	std::vector<Node> nodes; //node 0 is the root (not associated with any watch)
+		Tree() : nodes(1) {}
+
+		//Get child of iNode for specified watch, creating it if necessary
+		int child(int iNode, int watchId)
+		{	auto iter = nodes[iNode].children.find(watchId);
+			if(iter != nodes[iNode].children.end()) return iter->second;
+			int iChild = nodes.size();
+			nodes[iNode].children[watchId] = iChild;
+			nodes.push_back(Node(watchId, iNode));
+			return iChild;
+		}
+
+		//Accumulate node iSrc of src (and its descendants) into node iDest of this
+		void merge(const Tree& src, int iSrc=0, int iDest=0)
+		{	const Node& s = src.nodes[iSrc];
+			Node& d = nodes[iDest];
+			d.nCalls += s.nCalls; d.tTot += s.tTot; d.tSqTot += s.tSqTot; d.tChildren += s.tChildren;
+			d.flops += s.flops; d.bytes += s.bytes;
+			for(const auto& c: s.children)
+				merge(src, c.second, child(iDest, c.first));
+		}
+	};
+
+	struct TraceEvent
+	{	int watchId, tid;
+		double tStart, duration; //in microseconds
+	};
+	std::atomic<size_t> nTraceEvents(0);
+
+	Tree mainTree, workerTree; //trees merged from main thread and (exited) worker threads respectively
+	std::vector<TraceEvent> traceEvents; //trace events merged from all threads
+	std::atomic<int> nThreads(0);
+
+	//Profiling state of each thread, merged into the above on thread exit
+	struct ThreadState
+	{	int tid; //sequential thread index (0 for main thread)
+		Tree tree;
+		std::vector<std::pair<int,double>> stack; //node index and start time of active intervals
+		std::vector<TraceEvent> trace;
+
+		ThreadState() : tid(nThreads++) {}
+		~ThreadState() { flush(); }
+
+		void flush()
+		{	std::lock_guard<std::mutex> guard(lock);
+			(tid ? workerTree : mainTree).merge(tree);
+			traceEvents.insert(traceEvents.end(), trace.begin(), trace.end());
+			tree = Tree(); trace.clear(); stack.clear(); //intervals in progress are discarded
+		}
+	};
+
+	inline ThreadState& threadState()
+	{	thread_local ThreadState ts;
+		return ts;
+	}
+
+	void init()
+	{	threadState(); //ensure main thread is assigned tid = 0
+		//Parse environment variable (from head, to ensure consistency across processes):
+		string config;
+		const char* configStr = getenv("JDFTX_PROFILE");
+		if(configStr) config = configStr;
+		mpiWorld->bcast(config);
+		if(!config.length()) return;
+		istringstream iss(config);
+		string item;
+		while(getline(iss, item, ','))
+		{	if(item == "summary") summary = true;
+			else if(item.substr(0,5) == "json=") jsonFilename = item.substr(5);
+			else if(item.substr(0,6) == "trace=") traceFilename = item.substr(6);
+			else if(item.length()) logPrintf("Ignoring unrecognized output '%s' in JDFTX_PROFILE.\n", item.c_str());
+		}
+		enabled = summary || jsonFilename.length() || traceFilename.length();
+		if(enabled)
+			logPrintf("Profiling enabled with outputs:%s%s%s%s%s\n", summary ? " summary" : "",
+				jsonFilename.length() ? " json=" : "", jsonFilename.c_str(),
+				traceFilename.length() ? " trace=" : "", traceFilename.c_str());
+	}
+
+	//Get output filename, appending process index if necessary
+	string getFilename(const string& filename)
+	{	if(mpiWorld->nProcesses() == 1) return filename;
+		ostringstream oss; oss << filename << '.' << mpiWorld->iProcess();
+		return oss.str();
+	}
+
+	//Escape a string for JSON output
+	string jsonEscape(const string& s)
+	{	string result;
+		for(char c: s)
+		{	if(c=='"' || c=='\\') result += '\\';
+			result += c;
+		}
+		return result;
+	}
+
+	//Print the call tree below iNode to the log
+	void printTree(const Tree& tree, int iNode, int depth)
+	{	const Node& node = tree.nodes[iNode];
+		if(iNode)
+		{	double tSec = node.tTot*1e-6;
+			string label = string(2*(depth-1), ' ') + watchNames[node.watchId];
+			logPrintf("PROFILER-TREE: %-48s %13.6lf s total %13.6lf s self %10lu calls",
+				label.c_str(), tSec, (node.tTot-node.tChildren)*1e-6, node.nCalls);
+			if(node.flops) logPrintf(" %9.3lf GFLOP/s", node.flops*1e-9/tSec);
+			if(node.bytes) logPrintf(" %9.3lf GB/s", node.bytes*1e-9/tSec);
+			logPrintf("\n");
+		}
+		//Children in descending order of time:
+		std::vector<std::pair<double,int>> children;
+		for(const auto& c: node.children) children.push_back(std::make_pair(-tree.nodes[c.second].tTot, c.second));
+		std::sort(children.begin(), children.end());
+		for(const auto& c: children) printTree(tree, c.second, depth+1);
+	}
+
+	//Write the call tree below iNode in JSON format
+	void writeTreeJSON(FILE* fp, const Tree& tree, int iNode, int depth)
+	{	const Node& node = tree.nodes[iNode];
+		string indent(depth+2, '\t');
+		fprintf(fp, "{ \"name\": \"%s\", \"calls\": %lu, \"total\": %.6le, \"self\": %.6le, \"sigma\": %.6le, \"flops\": %.6le, \"bytes\": %.6le, \"children\": [",
+			iNode ? jsonEscape(watchNames[node.watchId]).c_str() : "", node.nCalls, (iNode ? node.tTot : node.tChildren)*1e-6, (iNode ? node.tTot-node.tChildren : 0.)*1e-6,
+			node.nCalls ? 1e-6*sqrt(std::max(0., node.tSqTot/node.nCalls - std::pow(node.tTot/node.nCalls,2))) : 0.,
+			node.flops, node.bytes);
+		bool first = true;
+		for(const auto& c: node.children)
+		{	fprintf(fp, "%s\n%s\t", first ? "" : ",", indent.c_str());
+			writeTreeJSON(fp, tree, c.second, depth+1);
+			first = false;
+		}
+		fprintf(fp, "%s]}", first ? "" : ("\n"+indent).c_str());
+	}
+
+	void report()
+	{	if(!(summary || jsonFilename.length() || traceFilename.length())) return;
+		bool wasEnabled = enabled;
+		enabled = false; //stop recording while reporting
+		threadState().flush(); //merge main thread's data
+		std::lock_guard<std::mutex> guard(lock);
+
+		if(summary)
+		{	//Flat statistics by watch name (accumulated over all call paths and threads):
+			struct Stats
+			{	size_t nCalls; double tTot, tSqTot, flops, bytes;
+				Stats() : nCalls(0), tTot(0.), tSqTot(0.), flops(0.), bytes(0.) {}
+			};
+			std::map<string,Stats> statsMap;
+			for(const Tree* tree: {&mainTree, &workerTree})
+				for(const Node& node: tree->nodes)
+					if(node.watchId >= 0)
+					{	Stats& stats = statsMap[watchNames[node.watchId]];
+						stats.nCalls += node.nCalls;
+						stats.tTot += node.tTot;
+						stats.tSqTot += node.tSqTot;
+						stats.flops += node.flops;
+						stats.bytes += node.bytes;
+					}
+			//Range of total times across processes (for the watch names on the head process):
+			std::vector<string> names;
+			for(const auto& entry: statsMap) names.push_back(entry.first);
+			int nNames = names.size(); mpiWorld->bcast(nNames);
+			names.resize(nNames);
+			for(string& name: names) mpiWorld->bcast(name);
+			std::vector<double> tMin(nNames), tMax(nNames);
+			for(int iName=0; iName<nNames; iName++)
+			{	auto iter = statsMap.find(names[iName]);
+				tMin[iName] = tMax[iName] = (iter==statsMap.end()) ? 0. : iter->second.tTot;
+			}
+			mpiWorld->allReduce(tMin.data(), nNames, MPIUtil::ReduceMin);
+			mpiWorld->allReduce(tMax.data(), nNames, MPIUtil::ReduceMax);
+			//Print flat statistics (only on head, so no need to handle names missing locally):
+			logPrintf("\n");
+			if(mpiWorld->isHead())
+				for(int iName=0; iName<nNames; iName++)
+				{	const Stats& stats = statsMap[names[iName]];
+					if(!stats.nCalls) continue;
+					double meanT = stats.tTot/stats.nCalls;
+					double sigmaT = sqrt(std::max(0., stats.tSqTot/stats.nCalls - meanT*meanT));
+					logPrintf("PROFILER: %30s %12.6lf +/- %12.6lf s, %4lu calls, %13.6lf s total",
+						names[iName].c_str(), meanT*1e-6, sigmaT*1e-6, stats.nCalls, stats.tTot*1e-6);
+					if(mpiWorld->nProcesses() > 1) logPrintf(" [%.6lf to %.6lf s over processes]", tMin[iName]*1e-6, tMax[iName]*1e-6);
+					if(stats.flops) logPrintf(" %9.3lf GFLOP/s", stats.flops*1e-3/stats.tTot);
+					if(stats.bytes) logPrintf(" %9.3lf GB/s", stats.bytes*1e-3/stats.tTot);
+					logPrintf("\n");
+				}
+			//Print call trees:
+			logPrintf("\nPROFILER-TREE: Main thread:\n");
+			printTree(mainTree, 0, 0);
+			if(workerTree.nodes.size() > 1)
+			{	logPrintf("PROFILER-TREE: Worker threads (times summed over threads):\n");
+				printTree(workerTree, 0, 0);
+			}
+		}
+
+		if(jsonFilename.length())
+		{	string fname = getFilename(jsonFilename);
+			FILE* fp = fopen(fname.c_str(), "w");
+			if(!fp) logPrintf("WARNING: could not open '%s' for writing profile.\n", fname.c_str());
+			else
+			{	fprintf(fp, "{\n\t\"process\": %d,\n\t\"nProcesses\": %d,\n\t\"units\": { \"time\": \"s\" },\n",
+					mpiWorld->iProcess(), mpiWorld->nProcesses());
+				fprintf(fp, "\t\"main\": ");   writeTreeJSON(fp, mainTree, 0, 0);   fprintf(fp, ",\n");
+				fprintf(fp, "\t\"workers\": "); writeTreeJSON(fp, workerTree, 0, 0); fprintf(fp, "\n}\n");
+				fclose(fp);
+			}
+		}
+
+		if(traceFilename.length())
+		{	string fname = getFilename(traceFilename);
+			FILE* fp = fopen(fname.c_str(), "w");
+			if(!fp) logPrintf("WARNING: could not open '%s' for writing profile trace.\n", fname.c_str());
+			else
+			{	fprintf(fp, "{\"traceEvents\": [\n");
+				fprintf(fp, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"name\": \"Process %d\"}}",
+					mpiWorld->iProcess(), mpiWorld->iProcess());
+				for(const TraceEvent& event: traceEvents)
+					fprintf(fp, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.1lf, \"dur\": %.1lf, \"pid\": %d, \"tid\": %d}",
+						jsonEscape(watchNames[event.watchId]).c_str(), event.tStart, event.duration, mpiWorld->iProcess(), event.tid);
+				fprintf(fp, "\n]}\n");
+				fclose(fp);
+				if(nTraceEvents > nTraceEventsMax)
+					logPrintf("WARNING: profile trace truncated to the first %lu intervals.\n", nTraceEventsMax);
+			}
+		}
+		enabled = wasEnabled;
+	}
+}
+
+
+StopWatch::StopWatch(string name)
+{	std::lock_guard<std::mutex> guard(Profiler::lock);
+	//Watches with the same name (eg. in overloads of a function) share statistics:
+	auto iter = std::find(Profiler::watchNames.begin(), Profiler::watchNames.end(), name);
+	id = iter - Profiler::watchNames.begin();
+	if(iter == Profiler::watchNames.end()) Profiler::watchNames.push_back(name);
+}
+
+void StopWatch::startActive()
+{	Profiler::ThreadState& ts = Profiler::threadState();
+	int iNode = ts.tree.child(ts.stack.size() ? ts.stack.back().first : 0, id);
+	#ifdef GPU_ENABLED
+	if(!ts.tid) cudaThreadSynchronize(); //only main thread accesses GPU
+	#endif
+	ts.stack.push_back(std::make_pair(iNode, clock_us()));
+}
+
+void StopWatch::stopActive()
+{	Profiler::ThreadState& ts = Profiler::threadState();
+	//Find innermost active interval of this watch (normally on top of the stack):
+	int iStack = int(ts.stack.size())-1;
+	while(iStack>=0 && ts.tree.nodes[ts.stack[iStack].first].watchId != id) iStack--;
+	if(iStack < 0) return; //not started while profiling was enabled
+	#ifdef GPU_ENABLED
+	if(!ts.tid) cudaThreadSynchronize(); //only main thread accesses GPU
+	#endif
+	double tStop = clock_us();
+	//End this interval (along with any unterminated ones nested within it):
+	while(int(ts.stack.size()) > iStack)
+	{	int iNode = ts.stack.back().first;
+		double tStart = ts.stack.back().second;
+		ts.stack.pop_back();
+		double T = tStop - tStart;
+		Profiler::Node& node = ts.tree.nodes[iNode];
+		node.nCalls++;
+		node.tTot += T;
+		node.tSqTot += T*T;
+		ts.tree.nodes[node.parent].tChildren += T;
+		if(Profiler::traceFilename.length() && (Profiler::nTraceEvents++ < Profiler::nTraceEventsMax))
+		{	Profiler::TraceEvent event = { node.watchId, ts.tid, tStart, T };
+			ts.trace.push_back(event);
+		}
+	}
+}
+
+void StopWatch::addWorkActive(double flops, double bytes)
+{	Profiler::ThreadState& ts = Profiler::threadState();
+	for(int iStack=int(ts.stack.size())-1; iStack>=0; iStack--)
+	{	Profiler::Node& node = ts.tree.nodes[ts.stack[iStack].first];
+		if(node.watchId == id)
+		{	node.flops += flops;
+			node.bytes += bytes;
+			return;
+		}
+	}
+}
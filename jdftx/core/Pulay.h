@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/PulayParams.h>
 #include <core/matrix.h>
 #include <core/string.h>
+#include <core/Metrics.h>
 #include <cfloat>
 
 //! @addtogroup Algorithms
@@ -34,6 +35,7 @@ template<typename Variable> class Pulay
 {
 public:
 	Pulay(const PulayParams& pp);
+	~Pulay();
 	
 	//! @brief Minimize energy using a self-consistent iteration
 	//! @param Eprev Initial energy (optional)
@@ -49,6 +51,9 @@ public:
 	//! Override to synchronize scalars over MPI processes (if the same minimization is happening in sync over many processes)
 	virtual double sync(double x) const { return x; }
 	
+	//! Override to return the processes that perform this minimization in sync (to include their load imbalance in the Metrics stream)
+	virtual const MPIUtil* metricsComm() const { return 0; }
+	
 protected:
 	//----- Interface specification -----
 
@@ -63,6 +68,7 @@ protected:
 	virtual double cycle(double dEprev, std::vector<double>& extraValues)=0;
 	
 	virtual void report(int iter) {} //!< Override to perform optional reporting
+	virtual bool stalled(double residualNorm) { return false; } //!< Override to end minimize() early (eg. to switch to a fallback algorithm) based on the residual norm of each cycle
 	virtual void axpy(double alpha, const Variable& X, Variable& Y) const=0; //!< Scaled accumulate on variable
 	virtual double dot(const Variable& X, const Variable& Y) const=0; //!< Euclidean dot product. Metric applied separately for efficiency.
 	virtual size_t variableSize() const=0; //!< Number of bytes per variable
@@ -78,6 +84,12 @@ private:
 	std::vector<Variable> pastVariables; //!< Previous variables
 	std::vector<Variable> pastResiduals; //!< Previous residuals
 	matrix overlap; //!< Overlap matrix of residuals
+	
+	//History on disk (if pp.historyOnDisk):
+	FILE* fpHistory; //!< Scratch file containing past variables and residuals
+	std::vector<int> historySlots; //!< Slot in fpHistory of each past variable and residual pair (-1 if still in memory)
+	void stashHistory(size_t j); //!< Move past variable and residual j to the scratch file (if historyOnDisk)
+	void fetchHistory(size_t j, Variable* variable, Variable* residual) const; //!< Retrieve past variable and/or residual j (from memory or scratch file)
 };
 
 //! @}
@@ -87,6 +99,8 @@ private:
 
 #include <core/Minimize.h>
 #include <memory>
+#include <algorithm>
+#include <unistd.h>
 
 //Norm convergence check (eigenvalue-difference or residual)
 //Make sure value is within tolerance for nCheck consecutive cycles
@@ -109,10 +123,14 @@ public:
 };
 
 template<typename Variable> Pulay<Variable>::Pulay(const PulayParams& pp)
-: pp(pp), overlap(pp.history, pp.history)
+: pp(pp), overlap(pp.history, pp.history), fpHistory(0)
 {
 }
 
+template<typename Variable> Pulay<Variable>::~Pulay()
+{	if(fpHistory) fclose(fpHistory);
+}
+
 template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::vector<string> extraNames, std::vector<double> extraThresh)
 {
 	double E = sync(Eprev); Eprev = 0.;
@@ -135,11 +153,13 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 			if(ndim>1) overlap.set(0,ndim-1, 0,ndim-1, overlap(1,ndim, 1,ndim));
 			pastVariables.erase(pastVariables.begin());
 			pastResiduals.erase(pastResiduals.begin());
+			historySlots.erase(historySlots.begin());
 		}
 		
 		//Cache the old energy and variables
 		Eprev = E;
 		pastVariables.push_back(getVariable());
+		historySlots.push_back(-1);
 
 		//Perform cycle:
 		std::vector<double> extraValues(extraThresh.size());
@@ -163,6 +183,13 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 			fprintf(pp.fpLog, "   |%s|: %.3e", extraNames[iExtra].c_str(), extraValues[iExtra]);
 		fprintf(pp.fpLog, "  t[s]: %9.2lf", clock_sec());
 		fprintf(pp.fpLog, "\n"); fflush(pp.fpLog);
+		if(metricsComm() || pp.fpLog != nullLog)
+		{	Metrics::Record record(pp.linePrefix);
+			record.add("iter", iter).add("energyLabel", pp.energyLabel).add("energy", E).add("dE", dE).add("residual", residualNorm);
+			for(size_t iExtra=0; iExtra<extraNames.size(); iExtra++)
+				record.add(extraNames[iExtra], extraValues[iExtra]);
+			record.emit(metricsComm());
+		}
 		
 		//Optional reporting:
 		report(iter);
@@ -190,6 +217,10 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 				}
 		fflush(pp.fpLog);
 		if(converged || killFlag) break; //converged or manually interrupted
+		if(stalled(residualNorm))
+		{	fprintf(pp.fpLog, "%sStalled (|Residual| not decreasing). Stopping ...\n\n", pp.linePrefix);
+			break;
+		}
 		
 		//---- DIIS/Pulay mixing -----
 			
@@ -197,7 +228,8 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 		size_t ndim = pastResiduals.size();
 		Variable MlastResidual = applyMetric(pastResiduals.back());
 		for(size_t j=0; j<ndim; j++)
-		{	double thisOverlap = dot(pastResiduals[j], MlastResidual);
+		{	Variable residual_j; fetchHistory(j, 0, &residual_j);
+			double thisOverlap = dot(residual_j, MlastResidual);
 			overlap.set(j, ndim-1, thisOverlap);
 			overlap.set(ndim-1, j, thisOverlap);
 		}
@@ -217,10 +249,12 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 		Variable v;
 		for(size_t j=0; j<ndim; j++)
 		{	double alpha = coefs[cOverlap_inv.index(j, ndim)].real();
-			axpy(alpha, pastVariables[j], v);
-			axpy(alpha, precondition(pastResiduals[j]), v);
+			Variable variable_j, residual_j; fetchHistory(j, &variable_j, &residual_j);
+			axpy(alpha, variable_j, v);
+			axpy(alpha, precondition(residual_j), v);
 		}
 		setVariable(v);
+		stashHistory(ndim-1);
 	}
 	return E;
 }
@@ -240,6 +274,7 @@ template<typename Variable> void Pulay<Variable>::loadState(const char* filename
 	fprintf(pp.fpLog, "%sReading %lu past variables and residuals from '%s' ... ", pp.linePrefix, ndim, filename); logFlush();
 	pastVariables.resize(ndim);
 	pastResiduals.resize(ndim);
+	historySlots.assign(ndim, -1);
 	FILE* fp = fopen(filename, "r");
 	if(dimOffset) fseek(fp, dimOffset*nBytesCycle, SEEK_SET);
 	for(size_t idim=0; idim<ndim; idim++)
@@ -257,6 +292,8 @@ template<typename Variable> void Pulay<Variable>::loadState(const char* filename
 			overlap.set(j,i, thisOverlap);
 		}
 	}
+	for(size_t i=0; i<ndim; i++)
+		stashHistory(i);
 }
 
 template<typename Variable> void Pulay<Variable>::saveState(const char* filename) const
@@ -264,8 +301,9 @@ template<typename Variable> void Pulay<Variable>::saveState(const char* filename
 	if(mpiWorld->isHead())
 	{	FILE* fp = fopen(filename, "w");
 		for(size_t idim=0; idim<pastVariables.size(); idim++)
-		{	writeVariable(pastVariables[idim], fp);
-			writeVariable(pastResiduals[idim], fp);
+		{	Variable variable, residual; fetchHistory(idim, &variable, &residual);
+			writeVariable(variable, fp);
+			writeVariable(residual, fp);
 		}
 		fclose(fp);
 	}
@@ -274,6 +312,42 @@ template<typename Variable> void Pulay<Variable>::saveState(const char* filename
 template<typename Variable> void Pulay<Variable>::clearState()
 {	pastVariables.clear();
 	pastResiduals.clear();
+	historySlots.clear();
+}
+
+template<typename Variable> void Pulay<Variable>::stashHistory(size_t j)
+{	if(!pp.historyOnDisk || historySlots[j]>=0) return;
+	if(!fpHistory)
+	{	//Create an anonymous scratch file (unlinked immediately, so that it is removed on exit):
+		const char* tmpDir = getenv("TMPDIR");
+		string filename = string(tmpDir ? tmpDir : "/tmp") + "/jdftxPulayXXXXXX";
+		std::vector<char> filenameBuf(filename.begin(), filename.end()); filenameBuf.push_back(0);
+		int fd = mkstemp(filenameBuf.data());
+		if(fd < 0) die_alone("Could not create scratch file '%s' for Pulay history.\n", filename.c_str());
+		unlink(filenameBuf.data());
+		fpHistory = fdopen(fd, "w+");
+	}
+	//Find a free slot (one released by the discarded oldest entry, if any):
+	int slot = 0;
+	while(std::find(historySlots.begin(), historySlots.end(), slot) != historySlots.end()) slot++;
+	fseek(fpHistory, slot * 2 * variableSize(), SEEK_SET);
+	writeVariable(pastVariables[j], fpHistory);
+	writeVariable(pastResiduals[j], fpHistory);
+	fflush(fpHistory);
+	pastVariables[j] = Variable();
+	pastResiduals[j] = Variable();
+	historySlots[j] = slot;
+}
+
+template<typename Variable> void Pulay<Variable>::fetchHistory(size_t j, Variable* variable, Variable* residual) const
+{	if(historySlots[j] < 0)
+	{	if(variable) *variable = pastVariables[j];
+		if(residual) *residual = pastResiduals[j];
+		return;
+	}
+	fseek(fpHistory, historySlots[j] * 2 * variableSize() + (variable ? 0 : variableSize()), SEEK_SET);
+	if(variable) readVariable(*variable, fpHistory);
+	if(residual) readVariable(*residual, fpHistory);
 }
 
 //!@endcond
@@ -21,6 +21,11 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/SphericalHarmonics.h>
 #include <core/GpuUtil.h>
 #include <core/Thread.h>
+#include <core/KernelCache.h>
+#include <core/GridInfo.h>
+#include <gsl/gsl_sf_gamma.h>
+#include <fftw3.h>
+#include <mutex>
 
 RadialFunctionG::RadialFunctionG() : dGinv(0), nCoeff(0),
 #ifdef GPU_ENABLED
@@ -163,18 +168,119 @@ static void RadialFunction_transform_sub(int iMineStart, int iMineStop, int iGst
 		fTilde[iG] = rFunc->transform(l, iG*dG);
 }
 
-// Initialize a uniform G radial function from the log-grid function
-void RadialFunctionR::transform(int l, double dG, int nGrid, RadialFunctionG& func) const
-{	static StopWatch watch("RadialFunctionR::transform"); watch.start();
-	std::vector<double> fTilde(nGrid, 0.);
+void RadialFunctionR::transformDirect(int l, double dG, int nGrid, std::vector<double>& fTilde) const
+{	fTilde.assign(nGrid, 0.);
 	int iGstart, iGstop; TaskDivision(nGrid, mpiWorld).myRange(iGstart, iGstop);
 	int nGridMine = iGstop-iGstart;
 	if(nGridMine)
 		threadLaunch(RadialFunction_transform_sub, nGridMine, iGstart, l, dG, this, fTilde.data());
 	mpiWorld->allReduce(fTilde.data(), fTilde.size(), MPIUtil::ReduceSum);
+}
+
+//Mellin transform of the spherical bessel function, int_0^inf dx x^(s-1) j_l(x), at s = q + i omega (valid for -l < q < 2)
+inline complex besselMellin(int l, double q, double omega)
+{	gsl_sf_result lnNumAbs, lnNumArg, lnDenAbs, lnDenArg;
+	gsl_sf_lngamma_complex_e(0.5*(l+q), 0.5*omega, &lnNumAbs, &lnNumArg);
+	gsl_sf_lngamma_complex_e(0.5*(3+l-q), -0.5*omega, &lnDenAbs, &lnDenArg);
+	return exp(0.5*log(M_PI) + (q-2.)*M_LN2 + lnNumAbs.val - lnDenAbs.val) //sqrt(pi) 2^(s-2) Gamma((l+s)/2) / Gamma((3+l-s)/2)
+		* cis(omega*M_LN2 + lnNumArg.val - lnDenArg.val);
+}
+
+bool RadialFunctionR::transformFFTLog(int l, double dG, int nGrid, std::vector<double>& fTilde) const
+{	//Check for a logarithmic grid (ignoring a leading r=0 point, if any):
+	int n = r.size();
+	if(n<3 || nGrid<2 || dG<=0.) return false;
+	int iStart = (r[0]>0. && fabs(log(r[1]*r[1]/(r[0]*r[2]))) < 1e-6) ? 0 : 1;
+	int nLog = n - iStart;
+	double lnrStart = log(r[iStart]), lnrStop = log(r[n-1]);
+	double dlogr = (lnrStop - lnrStart)/(nLog-1);
+	if(!(dlogr > 0.)) return false;
+	for(int i=iStart+1; i<n; i++)
+		if(fabs(log(r[i]/r[i-1]) - dlogr) > 1e-6)
+			return false;
+	
+	//Extend the log grid with zeros well beyond the length scales probed by the G grid (to suppress wrap-around errors):
+	const double q = 0.5; //power-law bias: the FFT is of r^(3-q) f(r) and yields G^q func(G); must lie in (-l,2)
+	double Gmax = (nGrid-1)*dG;
+	double lnrMin = std::min(lnrStart, -log(Gmax) - 20.);
+	double lnrMax = std::max(lnrStop, -log(dG) + 3.);
+	int nPadLo = int(ceil((lnrStart-lnrMin)/dlogr));
+	int nTot = nPadLo + nLog + int(ceil((lnrMax-lnrStop)/dlogr));
+	int N = 2; while(N < nTot) N *= 2;
+	int s = 1; while(dlogr > s*dG/Gmax) s *= 2; //oversample output so that its spacing near Gmax is at most dG
+	int Nout = N*s;
+	if(Nout > (1<<24)) return false; //impractically fine G sampling relative to the r grid
+	double lnr0 = lnrStart - nPadLo*dlogr; //first point of the extended r grid
+	double lnk0 = -lnr0 - (N-1)*dlogr; //first point of the output grid (k grid mirrors the r grid)
+	double dlnk = dlogr/s;
+	
+	//FFT of the biased input:
+	std::vector<double> a(N, 0.), F(Nout);
+	for(int i=0; i<nLog; i++)
+		a[nPadLo+i] = (4*M_PI) * f[iStart+i] * exp((3.-q)*(lnr0 + (nPadLo+i)*dlogr));
+	std::vector<complex> c(N/2+1), d(Nout/2+1);
+	fftw_plan planIn, planOut;
+	{	std::lock_guard<std::mutex> lock(GridInfo::planLock);
+		fftw_plan_with_nthreads(1);
+		planIn = fftw_plan_dft_r2c_1d(N, a.data(), (fftw_complex*)c.data(), FFTW_ESTIMATE);
+		planOut = fftw_plan_dft_c2r_1d(Nout, (fftw_complex*)d.data(), F.data(), FFTW_ESTIMATE);
+	}
+	fftw_execute(planIn);
+	//Multiply by the Mellin transform of j_l and the phase relating the r and k grids:
+	double dOmega = (2*M_PI)/(N*dlogr);
+	for(int m=0; m<=N/2; m++)
+	{	double omega = m*dOmega;
+		complex dm = c[m] * besselMellin(l, q, omega) * cis(omega*(N-1)*dlogr) * (1./N);
+		if(m==N/2 && s>1) dm *= 0.5; //Nyquist component is split between +/- frequencies when oversampled
+		d[m] = dm.conj(); //since c2r computes the transform with the opposite sign
+	}
+	fftw_execute(planOut); //F[j] = k[j]^q func(k[j]) on the log grid k[j] = exp(lnk0 + j*dlnk)
+	{	std::lock_guard<std::mutex> lock(GridInfo::planLock);
+		fftw_destroy_plan(planIn);
+		fftw_destroy_plan(planOut);
+	}
+	
+	//Cubic interpolation in ln(k) to the uniform G grid:
+	fTilde.assign(nGrid, 0.);
+	fTilde[0] = transform(l, 0.);
+	for(int iG=1; iG<nGrid; iG++)
+	{	double x = (log(iG*dG) - lnk0)/dlnk;
+		int j = int(floor(x));
+		if(j<1 || j+2>=Nout) return false; //should not happen given the padding above
+		double t = x - j;
+		double w[4] = { -t*(t-1)*(t-2)/6, (t+1)*(t-1)*(t-2)/2, -(t+1)*t*(t-2)/2, (t+1)*t*(t-1)/6 };
+		for(int o=-1; o<=2; o++)
+			fTilde[iG] += w[o+1] * F[j+o] * exp(-q*(lnk0 + (j+o)*dlnk));
+	}
+	
+	//Validate against the direct sum at G spread logarithmically over the entire returned range:
+	const int nCheck = 12;
+	double errMax = 0., fMax = 0.;
+	int iGprev = 0;
+	for(int iCheck=0; iCheck<nCheck; iCheck++)
+	{	int iG = int(round(pow(nGrid-1, iCheck/(nCheck-1.)))); //from 1 to nGrid-1
+		if(iG == iGprev) continue; //coincident at low G on coarse grids
+		iGprev = iG;
+		double fDirect = transform(l, iG*dG);
+		errMax = std::max(errMax, fabs(fTilde[iG] - fDirect));
+		fMax = std::max(fMax, fabs(fDirect));
+	}
+	fMax = std::max(fMax, fabs(fTilde[0]));
+	return errMax <= 1e-6*fMax;
+}
+
+// Initialize a uniform G radial function from the log-grid function
+void RadialFunctionR::transform(int l, double dG, int nGrid, RadialFunctionG& func) const
+{	static StopWatch watch("RadialFunctionR::transform"); watch.start();
+	//Retrieve samples from persistent cache if available (keyed by the complete radial grid and function content):
+	std::vector<double> fTilde;
+	KernelCacheKey key("radialTransform"); key << string("fftlog-v1") << l << dG << nGrid << r << dr << f; //tag algorithm, so that changes invalidate old entries
+	KernelCache::get(key, fTilde, [&](std::vector<double>& result)
+	{	if(!transformFFTLog(l, dG, nGrid, result))
+			transformDirect(l, dG, nGrid, result);
+	});
 	func.free(this!=func.rFunc);
 	func.init(l, fTilde, dG);
 	if(this!=func.rFunc) func.rFunc = new RadialFunctionR(*this);
 	watch.stop();
 }
-
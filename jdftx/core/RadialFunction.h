@@ -64,7 +64,14 @@ struct RadialFunctionG
 		if(Gindex >= nCoeff-5) return 0.;
 		else return QuinticSpline::value(getCoeff(), Gindex);
 	}
-	
+
+	//! Derivative of blip with respect to G
+	__hostanddev__ double deriv(double G) const
+	{	double Gindex = G * dGinv;
+		if(Gindex >= nCoeff-5) return 0.;
+		else return dGinv * QuinticSpline::deriv(getCoeff(), Gindex);
+	}
+
 	RadialFunctionR* rFunc; //!< copy of the real-space radial version (if created from one)
 	
 	#ifndef __in_a_cu_file__
@@ -122,7 +129,16 @@ struct RadialFunctionR
 	
 	//! Initialize a uniform G radial function from the logPrintf grid function according to
 	//! @$ func(G) = \int dr 4\pi r^2 j_l(G r) f(r) @$
+	//! using transformFFTLog if possible, and transformDirect otherwise
 	void transform(int l, double dG, int nGrid, RadialFunctionG& func) const;
+
+	//! Compute fTilde[i] = func(i*dG) for 0 <= i < nGrid by a logarithmic-grid FFT (Talman / FFTLog algorithm),
+	//! in O(N log N) rather than O(N nGrid) operations, validated against the direct sum at a few G.
+	//! Returns false (leaving fTilde unspecified) if r is not a logarithmic grid or if the validation fails.
+	bool transformFFTLog(int l, double dG, int nGrid, std::vector<double>& fTilde) const;
+
+	//! Compute fTilde[i] = func(i*dG) for 0 <= i < nGrid by a direct sum for each G (threads and MPI parallelized)
+	void transformDirect(int l, double dG, int nGrid, std::vector<double>& fTilde) const;
 };
 
 //! @}
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/GridInfo.h>
 #include <core/Operators.h>
 #include <core/WignerSeitz.h>
+#include <core/H5io.h>
 #include <string.h>
 #include <algorithm>
 
@@ -66,6 +67,51 @@ void saveDX(const ScalarField& X, const char* filenamePrefix)
 	fclose(fp);
 }
 
+#ifdef HDF5_ENABLED
+void saveHDF5(const ScalarField& X, const char* filename)
+{	const GridInfo& g = X->gInfo;
+	//Create MPI file access across all processes:
+	hid_t plid = H5Pcreate(H5P_FILE_ACCESS);
+	H5Pset_fapl_mpio(plid, MPI_COMM_WORLD, MPI_INFO_NULL);
+	hid_t fid = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, plid);
+	if(fid<0) die("Could not open/create output HDF5 file '%s'\n", filename);
+	H5Pclose(plid);
+	//Lattice vectors (in columns, as in the lattice command):
+	hsize_t dimsR[2] = { 3, 3 };
+	h5writeVector(fid, "R", &g.R(0,0), dimsR, 2);
+	//Create chunked dataset for the data:
+	hsize_t dims[3] = { hsize_t(g.S[0]), hsize_t(g.S[1]), hsize_t(g.S[2]) };
+	hsize_t chunk[3] = { 1, dims[1], dims[2] }; //one plane per chunk
+	hid_t sid = H5Screate_simple(3, dims, NULL);
+	hid_t dcplid = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(dcplid, 3, chunk);
+	hid_t did = H5Dcreate(fid, "data", H5T_NATIVE_DOUBLE, sid, H5P_DEFAULT, dcplid, H5P_DEFAULT);
+	H5Pclose(dcplid);
+	if(did<0) die("Could not create dataset 'data' in HDF5 file '%s'.\n", filename);
+	//Select slab of planes for current process:
+	size_t i0start, i0stop; TaskDivision(g.S[0], mpiWorld).myRange(i0start, i0stop);
+	hsize_t offset[3] = { hsize_t(i0start), 0, 0 };
+	hsize_t count[3] = { hsize_t(i0stop-i0start), dims[1], dims[2] };
+	hid_t sidMem = H5Screate_simple(3, count, NULL);
+	if(count[0]) H5Sselect_hyperslab(sid, H5S_SELECT_SET, offset, NULL, count, NULL);
+	else { H5Sselect_none(sid); H5Sselect_none(sidMem); }
+	//Collective write:
+	hid_t xplid = H5Pcreate(H5P_DATASET_XFER);
+	H5Pset_dxpl_mpio(xplid, H5FD_MPIO_COLLECTIVE);
+	H5Dwrite(did, H5T_NATIVE_DOUBLE, sidMem, sid, xplid, X->data() + i0start*g.S[1]*g.S[2]);
+	//Cleanup:
+	H5Pclose(xplid);
+	H5Sclose(sidMem);
+	H5Sclose(sid);
+	H5Dclose(did);
+	H5Fclose(fid);
+}
+#else
+void saveHDF5(const ScalarField& X, const char* filename)
+{	die("HDF5 output of scalar fields requires HDF5 support.\n");
+}
+#endif
+
 
 std::vector< std::vector<double> > sphericalize(const ScalarField* dataR, int nColumns, double drFac, vector3< double >* center)
 {	assert(nColumns > 0); assert(dataR[0]);
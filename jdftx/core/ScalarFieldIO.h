@@ -66,8 +66,51 @@ template<typename T> void loadRawBinary(Tptr& X, const char* filename)
 	fclose(fp);
 }
 
+//! Save the data in raw binary format to file collectively, with each process writing
+//! a contiguous slab of the data using MPI-IO (call from all processes, with identical data).
+//! With MPI_SAFE_WRITE, the head process instead writes the entire file using regular IO.
+template<typename T> void saveRawBinaryCollective(const Tptr& X, const char* filename)
+{
+#if MPI_SAFE_WRITE
+	//MPISafeWrite builds target filesystems (eg. some NFS installations) on which concurrent
+	//MPI-IO writes from several processes can silently corrupt files, so the MPI-IO path below
+	//is compiled out. Every process holds the complete data, so no gather is needed: the head
+	//writes its own copy and the others return immediately. (Reads remain collective.)
+	if(mpiWorld->isHead()) saveRawBinary(X, filename);
+#else
+	size_t iStart, iStop; TaskDivision(X->nElem, mpiWorld).myRange(iStart, iStop);
+	MPIUtil::File fp; mpiWorld->fopenWrite(fp, filename);
+	mpiWorld->fseek(fp, iStart*sizeof(typename T::DataType), SEEK_SET);
+	mpiWorld->fwrite(X->data()+iStart, sizeof(typename T::DataType), iStop-iStart, fp);
+	mpiWorld->fclose(fp);
+#endif
+}
+
+//! Load the data in raw binary format from file collectively, with each process reading
+//! a contiguous slab of the data using MPI-IO and then sharing it with all others (call from all processes)
+template<typename T> void loadRawBinaryCollective(Tptr& X, const char* filename)
+{	typedef typename T::DataType DataType;
+	TaskDivision tDiv(X->nElem, mpiWorld);
+	size_t iStart, iStop; tDiv.myRange(iStart, iStop);
+	MPIUtil::File fp; mpiWorld->fopenRead(fp, filename, X->nElem*sizeof(DataType), "Hint: Are you really reading the correct file?\n");
+	mpiWorld->fseek(fp, iStart*sizeof(DataType), SEEK_SET);
+	mpiWorld->fread(X->data()+iStart, sizeof(DataType), iStop-iStart, fp);
+	mpiWorld->fclose(fp);
+	//Share slabs:
+	for(int jProcess=0; jProcess<mpiWorld->nProcesses(); jProcess++)
+	{	size_t jStart = tDiv.start(jProcess), jStop = tDiv.stop(jProcess);
+		if(jStop > jStart) mpiWorld->bcast(X->data()+jStart, jStop-jStart, jProcess);
+	}
+}
+
 #undef Tptr
 
+//! Collectively save real-space data to a 3D HDF5 dataset "data" (with lattice vectors in dataset "R"),
+//! chunked by planes along the first lattice direction, with each process writing a slab of planes.
+//! The chunking allows post-processing tools to read subsets of the grid efficiently.
+//! (Requires HDF5 support: call from all processes, with identical data.)
+void saveHDF5(const ScalarField&, const char* filename);
+
 /** Save data to a raw binary along with a DataExplorer header
 @param filenamePrefix Binary data is saved to filenamePrefix.bin with DataExplorer header filenamePrefix.dx
 */
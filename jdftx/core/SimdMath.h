@@ -0,0 +1,170 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_SIMDMATH_H
+#define JDFTX_CORE_SIMDMATH_H
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file SimdMath.h Vectorizable elementary functions and CPU-feature dispatch for pointwise kernels
+
+#include <core/scalar.h>
+#include <cstdint>
+#include <cstring>
+
+/**
+Attribute for the CPU loop (the *_sub function passed to threadLaunch) of a pointwise kernel.
+On x86-64 with GCC, this compiles AVX-512, AVX2 and baseline versions of the loop,
+and the version matching the running CPU is selected at load time;
+all calls within the loop are inlined so that the entire kernel is visible to the vectorizer.
+Elsewhere (other compilers / architectures, or device code) it has no effect.
+The body of the loop should be branch-free (with conditionals written as a sequence of
+two-way selects) and should use the simd_* functions below instead of exp / log / pow / atan,
+so that the compiler can vectorize it. (The build uses -fno-trapping-math to allow this.)
+*/
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER) && (__GNUC__ >= 6) \
+	&& defined(__x86_64__) && !defined(__CYGWIN__) && !defined(__in_a_cu_file__)
+	#define __simd_dispatch__ __attribute__((target_clones("avx512f","avx2","default"), flatten))
+#else
+	#define __simd_dispatch__
+#endif
+
+/**
+Place before the loop in a __simd_dispatch__ function to assert that its iterations are independent.
+Needed for kernels with many input and output arrays (such as the FMT weighted densities), for which
+the compiler would otherwise give up on the run-time aliasing checks required to vectorize the loop.
+*/
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+	#define SIMD_IVDEP _Pragma("GCC ivdep")
+#else
+	#define SIMD_IVDEP
+#endif
+
+//! @cond
+namespace SimdMath_internal
+{
+	//Note: integer conversions below avoid the double <-> int64 instructions missing in AVX2,
+	//using the fact that the low mantissa bits of 2^52 + k hold the integer k (for 0 <= k < 2^52)
+	const double twoPow52 = 4503599627370496.;
+	__hostanddev__ double fromBits(uint64_t i) { double d; memcpy(&d, &i, sizeof(double)); return d; }
+	__hostanddev__ uint64_t toBits(double d) { uint64_t i; memcpy(&i, &d, sizeof(double)); return i; }
+	__hostanddev__ double roundNearest(double x) { const double magic = 1.5*twoPow52; return (x + magic) - magic; } //valid for |x| < 2^51
+	__hostanddev__ double exp2int(double n) { return fromBits((toBits(n + (twoPow52+1023.)) - toBits(twoPow52)) << 52); } //2^n for integer n in [-1022,1023]
+}
+//! @endcond
+
+//! Exponential function (within a few ulp of exp) written to be vectorizable on the CPU; exactly exp on the GPU
+__hostanddev__ double simd_exp(double x)
+{
+#ifdef __CUDA_ARCH__
+	return exp(x);
+#else
+	using namespace SimdMath_internal;
+	const double xMax = 709.782712893383973, xMin = -708.396418532264106; //range with normal results (subnormal results are flushed to zero)
+	double xc = x>xMax ? xMax : x;
+	xc = xc<xMin ? xMin : xc;
+	//Range reduction x = n log(2) + r with |r| <= log(2)/2:
+	double n = roundNearest(xc * 1.4426950408889634074);
+	double r = (xc - n*6.93145751953125E-1) - n*1.42860682030941723212E-6;
+	//Pade approximant for exp(r):
+	double rSq = r*r;
+	double p = r*((1.26177193074810590878E-4*rSq + 3.02994407707441961300E-2)*rSq + 9.99999999999999999910E-1);
+	double q = ((3.00198505138664455042E-6*rSq + 2.52448340349684104192E-3)*rSq + 2.27265548208155028766E-1)*rSq + 2.00000000000000000009E0;
+	double expr = 1. + 2.*p/(q-p);
+	//Multiply by 2^n (in two factors so that n=1024 does not overflow the exponent field):
+	double nHalf = roundNearest(0.5*n);
+	double result = (expr * exp2int(nHalf)) * exp2int(n-nHalf);
+	result = x>xMax ? INFINITY : result;
+	result = x<xMin ? 0. : result;
+	return x==x ? result : x;
+#endif
+}
+
+//! Natural logarithm (within a few ulp of log) written to be vectorizable on the CPU; exactly log on the GPU
+__hostanddev__ double simd_log(double x)
+{
+#ifdef __CUDA_ARCH__
+	return log(x);
+#else
+	using namespace SimdMath_internal;
+	//Bring subnormals into the normal range:
+	bool subnormal = (x < 2.2250738585072014E-308);
+	double xs = subnormal ? x*18014398509481984. : x; //scale by 2^54
+	//Split x = m 2^e with m in [sqrt(1/2), sqrt(2)):
+	uint64_t bits = toBits(xs);
+	double e = (fromBits(toBits(twoPow52) | ((bits >> 52) & 0x7ff)) - twoPow52) - (subnormal ? 1077. : 1023.);
+	double m = fromBits((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+	bool mHigh = (m > 1.41421356237309504880);
+	m = mHigh ? 0.5*m : m;
+	e = mHigh ? e+1. : e;
+	//Rational approximation for log(1+f):
+	double f = m - 1.;
+	double fSq = f*f;
+	double p = ((((1.01875663804580931796E-4*f + 4.97494994976747001425E-1)*f + 4.70579119878881725854E0)*f
+		+ 1.44989225341610930846E1)*f + 1.79368678507819816313E1)*f + 7.70838733755885391666E0;
+	double q = ((((f + 1.12873587189167450590E1)*f + 4.52279145837532221105E1)*f
+		+ 8.29875266912776603211E1)*f + 7.11544750618563894466E1)*f + 2.31251620126765340583E1;
+	double y = f*(fSq*p/q) - e*2.121944400546905827679E-4 - 0.5*fSq;
+	double result = (f + y) + e*0.693359375;
+	//Special cases:
+	result = x==INFINITY ? x : result;
+	result = x==0. ? -INFINITY : result;
+	result = x<0. ? NAN : result;
+	return x==x ? result : x;
+#endif
+}
+
+//! Power function x^y for x >= 0 via simd_exp and simd_log (NAN for x < 0 and for x = y = 0); exactly pow on the GPU
+__hostanddev__ double simd_pow(double x, double y)
+{
+#ifdef __CUDA_ARCH__
+	return pow(x, y);
+#else
+	return simd_exp(y * simd_log(x));
+#endif
+}
+
+//! Inverse tangent (within a few ulp of atan) written to be vectorizable on the CPU; exactly atan on the GPU
+__hostanddev__ double simd_atan(double x)
+{
+#ifdef __CUDA_ARCH__
+	return atan(x);
+#else
+	//Range reduction to |xr| <= tan(pi/8), with offset y:
+	double xAbs = fabs(x);
+	bool big = (xAbs > 2.41421356237309504880); //tan(3pi/8)
+	bool mid = (xAbs > 0.66);
+	double xr = mid ? (xAbs-1.)/(xAbs+1.) : xAbs;
+	xr = big ? -1./xAbs : xr;
+	double y = mid ? (M_PI/4 + 0.5*6.123233995736765886130E-17) : 0.;
+	y = big ? (M_PI/2 + 6.123233995736765886130E-17) : y;
+	//Rational approximation in reduced range:
+	double z = xr*xr;
+	double p = (((-8.750608600031904122785E-1*z - 1.615753718733365076637E1)*z - 7.500855792314704667340E1)*z
+		- 1.228866684490136173410E2)*z - 6.485021904942025371773E1;
+	double q = ((((z + 2.485846490142306297962E1)*z + 1.650270098316988542046E2)*z + 4.328810604912902668951E2)*z
+		+ 4.853903996359136964868E2)*z + 1.945506571482613964425E2;
+	double result = y + (xr*(z*p/q) + xr);
+	return x<0. ? -result : result;
+#endif
+}
+
+//! @}
+#endif // JDFTX_CORE_SIMDMATH_H
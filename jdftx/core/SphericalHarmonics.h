@@ -116,6 +116,60 @@ namespace YlmInternal
 	DECLARE_Ylm(48, 0.6831841051919143*(Power(x,6) - 15.*Power(x,4)*Power(y,2) + 15.*Power(x,2)*Power(y,4) - Power(y,6)))
 	#undef DECLARE_Ylm
 	#undef Power
+	
+	template<int lm> __hostanddev__ vector3<> YlmPrime(double x, double y, double z); //gradient of the polynomial forms of Ylm above, flat-indexed by lm
+	#define DECLARE_YlmPrime(lm,codeX,codeY,codeZ) \
+		template<> __hostanddev__ vector3<> YlmPrime<lm>(double x, double y, double z) { return vector3<>(codeX, codeY, codeZ); }
+	DECLARE_YlmPrime(0, 0., 0., 0.)
+	DECLARE_YlmPrime(1, 0., 0.4886025119029199, 0.)
+	DECLARE_YlmPrime(2, 0., 0., 0.4886025119029199)
+	DECLARE_YlmPrime(3, 0.4886025119029199, 0., 0.)
+	DECLARE_YlmPrime(4, 1.0925484305920792*y, 1.0925484305920792*x, 0.)
+	DECLARE_YlmPrime(5, 0., 1.0925484305920792*z, 1.0925484305920792*y)
+	DECLARE_YlmPrime(6, -0.6307831305050401*x, -0.6307831305050401*y, 1.2615662610100802*z)
+	DECLARE_YlmPrime(7, 1.0925484305920792*z, 0., 1.0925484305920792*x)
+	DECLARE_YlmPrime(8, 1.0925484305920792*x, -1.0925484305920792*y, 0.)
+	DECLARE_YlmPrime(9, 3.540261539559861*x*y, 1.7701307697799304*x*x - 1.7701307697799304*y*y, 0.)
+	DECLARE_YlmPrime(10, 2.890611442640554*y*z, 2.890611442640554*x*z, 2.890611442640554*x*y)
+	DECLARE_YlmPrime(11, -0.9140915989289315*x*y, -0.4570457994644658*x*x - 1.3711373983933974*y*y + 1.828183197857863*z*z, 3.656366395715726*y*z)
+	DECLARE_YlmPrime(12, -2.2390579955406924*x*z, -2.2390579955406924*y*z, -1.1195289977703462*x*x - 1.1195289977703462*y*y + 2.2390579955406924*z*z)
+	DECLARE_YlmPrime(13, -1.3711373983933974*x*x - 0.4570457994644658*y*y + 1.828183197857863*z*z, -0.9140915989289315*x*y, 3.656366395715726*x*z)
+	DECLARE_YlmPrime(14, 2.890611442640554*x*z, -2.890611442640554*y*z, 1.445305721320277*x*x - 1.445305721320277*y*y)
+	DECLARE_YlmPrime(15, 1.7701307697799304*x*x - 1.7701307697799304*y*y, -3.540261539559861*x*y, 0.)
+	DECLARE_YlmPrime(16, 7.510028825390114*x*x*y - 2.5033429417967046*y*y*y, 2.5033429417967046*x*x*x - 7.510028825390114*x*y*y, 0.)
+	DECLARE_YlmPrime(17, 10.620784618679583*x*y*z, 5.310392309339791*x*x*z - 5.310392309339791*y*y*z, 5.310392309339791*x*x*y - 1.7701307697799304*y*y*y)
+	DECLARE_YlmPrime(18, -2.8385240872726802*x*x*y - 0.9461746957575601*y*y*y + 5.6770481745453605*y*z*z, -0.9461746957575601*x*x*x - 2.8385240872726802*x*y*y + 5.6770481745453605*x*z*z, 11.354096349090721*x*y*z)
+	DECLARE_YlmPrime(19, -4.014279261343735*x*y*z, -2.0071396306718676*x*x*z - 6.021418892015603*y*y*z + 2.676186174229157*z*z*z, -2.0071396306718676*x*x*y - 2.0071396306718676*y*y*y + 8.02855852268747*y*z*z)
+	DECLARE_YlmPrime(20, 1.2694265629824517*x*x*x + 1.2694265629824517*x*y*y - 5.077706251929807*x*z*z, 1.2694265629824517*x*x*y + 1.2694265629824517*y*y*y - 5.077706251929807*y*z*z, -5.077706251929807*x*x*z - 5.077706251929807*y*y*z + 3.385137501286538*z*z*z)
+	DECLARE_YlmPrime(21, -6.021418892015603*x*x*z - 2.0071396306718676*y*y*z + 2.676186174229157*z*z*z, -4.014279261343735*x*y*z, -2.0071396306718676*x*x*x - 2.0071396306718676*x*y*y + 8.02855852268747*x*z*z)
+	DECLARE_YlmPrime(22, -1.8923493915151202*x*x*x + 5.6770481745453605*x*z*z, 1.8923493915151202*y*y*y - 5.6770481745453605*y*z*z, 5.6770481745453605*x*x*z - 5.6770481745453605*y*y*z)
+	DECLARE_YlmPrime(23, 5.310392309339791*x*x*z - 5.310392309339791*y*y*z, -10.620784618679583*x*y*z, 1.7701307697799304*x*x*x - 5.310392309339791*x*y*y)
+	DECLARE_YlmPrime(24, 2.5033429417967046*x*x*x - 7.510028825390114*x*y*y, -7.510028825390114*x*x*y + 2.5033429417967046*y*y*y, 0.)
+	DECLARE_YlmPrime(25, 13.127641136803403*x*x*x*y - 13.127641136803403*x*y*y*y, 3.2819102842008507*x*x*x*x - 19.691461705205104*x*x*y*y + 3.2819102842008507*y*y*y*y, 0.)
+	DECLARE_YlmPrime(26, 24.9079477785725*x*x*y*z - 8.302649259524166*y*y*y*z, 8.302649259524166*x*x*x*z - 24.9079477785725*x*y*y*z, 8.302649259524166*x*x*x*y - 8.302649259524166*x*y*y*y)
+	DECLARE_YlmPrime(27, -5.870859593223004*x*x*x*y - 1.9569531977410013*x*y*y*y + 23.483438372892017*x*y*z*z, -1.467714898305751*x*x*x*x - 2.935429796611502*x*x*y*y + 11.741719186446009*x*x*z*z + 2.446191497176252*y*y*y*y - 11.741719186446009*y*y*z*z, 23.483438372892017*x*x*y*z - 7.827812790964006*y*y*y*z)
+	DECLARE_YlmPrime(28, -14.380610354919973*x*x*y*z - 4.793536784973324*y*y*y*z + 9.587073569946648*y*z*z*z, -4.793536784973324*x*x*x*z - 14.380610354919973*x*y*y*z + 9.587073569946648*x*z*z*z, -4.793536784973324*x*x*x*y - 4.793536784973324*x*y*y*y + 28.761220709839947*x*y*z*z)
+	DECLARE_YlmPrime(29, 1.8117866047827877*x*x*x*y + 1.8117866047827877*x*y*y*y - 10.870719628696726*x*y*z*z, 0.45294665119569694*x*x*x*x + 2.7176799071741815*x*x*y*y - 5.435359814348363*x*x*z*z + 2.2647332559784847*y*y*y*y - 16.30607944304509*y*y*z*z + 3.6235732095655755*z*z*z*z, -10.870719628696726*x*x*y*z - 10.870719628696726*y*y*y*z + 14.494292838262302*y*z*z*z)
+	DECLARE_YlmPrime(30, 7.017019347205416*x*x*x*z + 7.017019347205416*x*y*y*z - 9.356025796273888*x*z*z*z, 7.017019347205416*x*x*y*z + 7.017019347205416*y*y*y*z - 9.356025796273888*y*z*z*z, 1.754254836801354*x*x*x*x + 3.508509673602708*x*x*y*y - 14.034038694410832*x*x*z*z + 1.754254836801354*y*y*y*y - 14.034038694410832*y*y*z*z + 4.678012898136944*z*z*z*z)
+	DECLARE_YlmPrime(31, 2.2647332559784847*x*x*x*x + 2.7176799071741815*x*x*y*y - 16.30607944304509*x*x*z*z + 0.45294665119569694*y*y*y*y - 5.435359814348363*y*y*z*z + 3.6235732095655755*z*z*z*z, 1.8117866047827877*x*x*x*y + 1.8117866047827877*x*y*y*y - 10.870719628696726*x*y*z*z, -10.870719628696726*x*x*x*z - 10.870719628696726*x*y*y*z + 14.494292838262302*x*z*z*z)
+	DECLARE_YlmPrime(32, -9.587073569946648*x*x*x*z + 9.587073569946648*x*z*z*z, 9.587073569946648*y*y*y*z - 9.587073569946648*y*z*z*z, -2.396768392486662*x*x*x*x + 14.380610354919973*x*x*z*z + 2.396768392486662*y*y*y*y - 14.380610354919973*y*y*z*z)
+	DECLARE_YlmPrime(33, -2.446191497176252*x*x*x*x + 2.935429796611502*x*x*y*y + 11.741719186446009*x*x*z*z + 1.467714898305751*y*y*y*y - 11.741719186446009*y*y*z*z, 1.9569531977410013*x*x*x*y + 5.870859593223004*x*y*y*y - 23.483438372892017*x*y*z*z, 7.827812790964006*x*x*x*z - 23.483438372892017*x*y*y*z)
+	DECLARE_YlmPrime(34, 8.302649259524166*x*x*x*z - 24.9079477785725*x*y*y*z, -24.9079477785725*x*x*y*z + 8.302649259524166*y*y*y*z, 2.0756623148810416*x*x*x*x - 12.45397388928625*x*x*y*y + 2.0756623148810416*y*y*y*y)
+	DECLARE_YlmPrime(35, 3.2819102842008507*x*x*x*x - 19.691461705205104*x*x*y*y + 3.2819102842008507*y*y*y*y, -13.127641136803403*x*x*x*y + 13.127641136803403*x*y*y*y, 0.)
+	DECLARE_YlmPrime(36, 20.495523155757425*x*x*x*x*y - 40.991046311514864*x*x*y*y*y + 4.099104631151485*y*y*y*y*y, 4.099104631151485*x*x*x*x*x - 40.991046311514864*x*x*x*y*y + 20.495523155757425*x*y*y*y*y, 0.)
+	DECLARE_YlmPrime(37, 47.33238324463504*x*x*x*y*z - 47.33238324463504*x*y*y*y*z, 11.83309581115876*x*x*x*x*z - 70.99857486695257*x*x*y*y*z + 11.83309581115876*y*y*y*y*z, 11.83309581115876*x*x*x*x*y - 23.66619162231752*x*x*y*y*y + 2.366619162231752*y*y*y*y*y)
+	DECLARE_YlmPrime(38, -10.091298014574484*x*x*x*x*y + 60.547788087446904*x*x*y*z*z + 2.0182596029148967*y*y*y*y*y - 20.182596029148968*y*y*y*z*z, -2.0182596029148967*x*x*x*x*x + 20.182596029148968*x*x*x*z*z + 10.091298014574484*x*y*y*y*y - 60.547788087446904*x*y*y*z*z, 40.365192058297936*x*x*x*y*z - 40.365192058297936*x*y*y*y*z)
+	DECLARE_YlmPrime(39, -33.16338934253724*x*x*x*y*z - 11.05446311417908*x*y*y*y*z + 44.21785245671633*x*y*z*z*z, -8.29084733563431*x*x*x*x*z - 16.58169467126862*x*x*y*y*z + 22.108926228358165*x*x*z*z*z + 13.818078892723854*y*y*y*y*z - 22.108926228358165*y*y*z*z*z, -8.29084733563431*x*x*x*x*y - 5.52723155708954*x*x*y*y*y + 66.32677868507449*x*x*y*z*z + 2.7636157785447706*y*y*y*y*y - 22.108926228358165*y*y*y*z*z)
+	DECLARE_YlmPrime(40, 4.606026297574618*x*x*x*x*y + 5.527231557089541*x*x*y*y*y - 44.21785245671633*x*x*y*z*z + 0.9212052595149236*y*y*y*y*y - 14.739284152238778*y*y*y*z*z + 14.739284152238778*y*z*z*z*z, 0.9212052595149236*x*x*x*x*x + 5.527231557089541*x*x*x*y*y - 14.739284152238778*x*x*x*z*z + 4.606026297574618*x*y*y*y*y - 44.21785245671633*x*y*y*z*z + 14.739284152238778*x*z*z*z*z, -29.478568304477555*x*x*x*y*z - 29.478568304477555*x*y*y*y*z + 58.95713660895511*x*y*z*z*z)
+	DECLARE_YlmPrime(41, 11.652427250374629*x*x*x*y*z + 11.652427250374629*x*y*y*y*z - 23.304854500749258*x*y*z*z*z, 2.9131068125936572*x*x*x*x*z + 17.478640875561943*x*x*y*y*z - 11.652427250374629*x*x*z*z*z + 14.565534062968286*y*y*y*y*z - 34.95728175112389*y*y*z*z*z + 4.660970900149851*z*z*z*z*z, 2.9131068125936572*x*x*x*x*y + 5.8262136251873144*x*x*y*y*y - 34.95728175112389*x*x*y*z*z + 2.9131068125936572*y*y*y*y*y - 34.95728175112389*y*y*y*z*z + 23.304854500749258*y*z*z*z*z)
+	DECLARE_YlmPrime(42, -1.9070760680288528*x*x*x*x*x - 3.8141521360577055*x*x*x*y*y + 22.884912816346233*x*x*x*z*z - 1.9070760680288528*x*y*y*y*y + 22.884912816346233*x*y*y*z*z - 15.256608544230822*x*z*z*z*z, -1.9070760680288528*x*x*x*x*y - 3.8141521360577055*x*x*y*y*y + 22.884912816346233*x*x*y*z*z - 1.9070760680288528*y*y*y*y*y + 22.884912816346233*y*y*y*z*z - 15.256608544230822*y*z*z*z*z, 11.442456408173117*x*x*x*x*z + 22.884912816346233*x*x*y*y*z - 30.513217088461644*x*x*z*z*z + 11.442456408173117*y*y*y*y*z - 30.513217088461644*y*y*z*z*z + 6.102643417692329*z*z*z*z*z)
+	DECLARE_YlmPrime(43, 14.565534062968286*x*x*x*x*z + 17.478640875561943*x*x*y*y*z - 34.95728175112389*x*x*z*z*z + 2.9131068125936572*y*y*y*y*z - 11.652427250374629*y*y*z*z*z + 4.660970900149851*z*z*z*z*z, 11.652427250374629*x*x*x*y*z + 11.652427250374629*x*y*y*y*z - 23.304854500749258*x*y*z*z*z, 2.9131068125936572*x*x*x*x*x + 5.8262136251873144*x*x*x*y*y - 34.95728175112389*x*x*x*z*z + 2.9131068125936572*x*y*y*y*y - 34.95728175112389*x*y*y*z*z + 23.304854500749258*x*z*z*z*z)
+	DECLARE_YlmPrime(44, 2.7636157785447706*x*x*x*x*x + 1.8424105190298472*x*x*x*y*y - 29.478568304477555*x*x*x*z*z - 0.9212052595149236*x*y*y*y*y + 14.739284152238778*x*z*z*z*z, 0.9212052595149236*x*x*x*x*y - 1.8424105190298472*x*x*y*y*y - 2.7636157785447706*y*y*y*y*y + 29.478568304477555*y*y*y*z*z - 14.739284152238778*y*z*z*z*z, -14.739284152238778*x*x*x*x*z + 29.478568304477555*x*x*z*z*z + 14.739284152238778*y*y*y*y*z - 29.478568304477555*y*y*z*z*z)
+	DECLARE_YlmPrime(45, -13.818078892723854*x*x*x*x*z + 16.58169467126862*x*x*y*y*z + 22.108926228358165*x*x*z*z*z + 8.29084733563431*y*y*y*y*z - 22.108926228358165*y*y*z*z*z, 11.05446311417908*x*x*x*y*z + 33.16338934253724*x*y*y*y*z - 44.21785245671633*x*y*z*z*z, -2.7636157785447706*x*x*x*x*x + 5.52723155708954*x*x*x*y*y + 22.108926228358165*x*x*x*z*z + 8.29084733563431*x*y*y*y*y - 66.32677868507449*x*y*y*z*z)
+	DECLARE_YlmPrime(46, -3.027389404372345*x*x*x*x*x + 10.091298014574482*x*x*x*y*y + 20.182596029148968*x*x*x*z*z + 5.045649007287241*x*y*y*y*y - 60.5477880874469*x*y*y*z*z, 5.045649007287241*x*x*x*x*y + 10.091298014574482*x*x*y*y*y - 60.5477880874469*x*x*y*z*z - 3.027389404372345*y*y*y*y*y + 20.182596029148968*y*y*y*z*z, 10.091298014574484*x*x*x*x*z - 60.5477880874469*x*x*y*y*z + 10.091298014574484*y*y*y*y*z)
+	DECLARE_YlmPrime(47, 11.83309581115876*x*x*x*x*z - 70.99857486695257*x*x*y*y*z + 11.83309581115876*y*y*y*y*z, -47.33238324463504*x*x*x*y*z + 47.33238324463504*x*y*y*y*z, 2.366619162231752*x*x*x*x*x - 23.66619162231752*x*x*x*y*y + 11.83309581115876*x*y*y*y*y)
+	DECLARE_YlmPrime(48, 4.099104631151485*x*x*x*x*x - 40.99104631151486*x*x*x*y*y + 20.49552315575743*x*y*y*y*y, -20.49552315575743*x*x*x*x*y + 40.99104631151486*x*x*y*y*y - 4.099104631151485*y*y*y*y*y, 0.)
+	#undef DECLARE_YlmPrime
 }
 
 //! Index by combined lm := l*(l+1)+m index (useful when static-looping over all l,m)
@@ -128,6 +182,12 @@ template<int l, int m> __hostanddev__ double Ylm(const vector3<>& qhat)
 {	return Ylm<l*(l+1)+m>(qhat);
 }
 
+//! Gradient of Ylm(qhat) with respect to the vector q, evaluated at |q| = 1 (scales as 1/|q| in general);
+//! this is tangential to the unit sphere, i.e. orthogonal to qhat
+template<int l, int m> __hostanddev__ vector3<> YlmPrime(const vector3<>& qhat)
+{	return YlmInternal::YlmPrime<l*(l+1)+m>(qhat[0],qhat[1],qhat[2]) - (l*Ylm<l,m>(qhat)) * qhat;
+}
+
 //! Switch a function templated over l,m for all supported l,m with parenthesis enclosed argument list argList
 #define SwitchTemplate_lm(l,m,fTemplate,argList) \
 	switch(l*(l+1)+m) \
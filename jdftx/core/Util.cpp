@@ -20,6 +20,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Util.h>
 #include <core/Thread.h>
 #include <core/ManagedMemory.h>
+#include <core/Metrics.h>
+#include <core/KernelCache.h>
 #include <core/GpuUtil.h>
 #include <cmath>
 #include <csignal>
@@ -282,6 +284,11 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 			logPrintf("Could not determine memory pool size from JDFTX_MEMPOOL_SIZE=\"%s\".\n", mempoolSizeStr);
 	}
 	
+	//Profiler, metrics stream and kernel cache (runtime configuration):
+	Profiler::init();
+	Metrics::init();
+	KernelCache::init();
+	
 	//Add citations to the code for all calculations:
 	Citations::add("Software package",
 		"R. Sundararaman, K. Letchworth-Weaver, K.A. Schwarz, D. Gunceler, Y. Ozhabes and T.A. Arias, "
@@ -374,18 +381,6 @@ void initSystemCmdline(int argc, char** argv, InitParams& ip)
 	initSystem(argc, argv, &ip);
 }
 
-#ifdef ENABLE_PROFILING
-void stopWatchManager(const StopWatch* addWatch=0, const string* watchName=0)
-{	static std::multimap<string, const StopWatch*> watches; //static array of all watches
-	if(addWatch) watches.insert(std::make_pair(*watchName,addWatch));
-	else //print timings:
-	{	logPrintf("\n");
-		for(const auto& wPair: watches) wPair.second->print();
-	}
-}
-#endif // ENABLE_PROFILING
-
-
 void finalizeSystem(bool successful)
 {
 	time_t endTime = time(0);
@@ -405,8 +400,9 @@ void finalizeSystem(bool successful)
 			fprintf(stderr, "Failed.\n");
 	}
 	
+	Metrics::finalize(successful);
+	Profiler::report();
 	#ifdef ENABLE_PROFILING
-	stopWatchManager();
 	logPrintf("\n");
 	ManagedMemoryBase::reportUsage();
 	#endif
@@ -440,34 +436,6 @@ double clock_sec()
 }
 
 
-#ifdef ENABLE_PROFILING
-StopWatch::StopWatch(string name) : Ttot(0), TsqTot(0), nT(0), name(name) { stopWatchManager(this, &name); }
-void StopWatch::start()
-{
-	#ifdef GPU_ENABLED
-	cudaThreadSynchronize();
-	#endif
-	tPrev = clock_us();
-}
-void StopWatch::stop()
-{
-	#ifdef GPU_ENABLED
-	cudaThreadSynchronize();
-	#endif
-	double T = clock_us()-tPrev;
-	Ttot+=T; TsqTot+=T*T; nT++;
-}
-void StopWatch::print() const
-{	if(nT)
-	{	double meanT = Ttot/nT;
-		double sigmaT = sqrt(TsqTot/nT - meanT*meanT);
-		logPrintf("PROFILER: %30s %12.6lf +/- %12.6lf s, %4d calls, %13.6lf s total\n",
-			name.c_str(), meanT*1e-6, sigmaT*1e-6, nT, Ttot*1e-6);
-	}
-}
-#endif //ENABLE_PROFILING
-
-
 // Print a minimal stack trace (convenient for debugging)
 void printStack(bool detailedStackScript)
 {	const int maxStackLength = 1024;
@@ -84,32 +84,38 @@ Code must be self-contained as a scope, as it will be surrounded by { }, and sho
 	fprintf(fp, "%s took %.2le s.\n", title, runTime*1e-6); \
 }
 
+//! Runtime control of the StopWatch profiler. Profiling is off by default (except in builds with EnableProfiling),
+//! and is enabled by specifying any of the following outputs in environment variable JDFTX_PROFILE (comma-separated):
+//! * summary: print flat and hierarchical timings, call counts and throughputs to the log at exit
+//! * json=<file>: write the call tree (separately for the main thread and worker threads) with all statistics
+//! * trace=<file>: write a timeline of all timed intervals in Chrome trace format (for chrome://tracing or Perfetto)
+//! Files are written per process (as <file>.<iProcess>) when running with more than one process.
+namespace Profiler
+{	extern bool enabled; //!< whether StopWatch timings are currently being recorded (may be toggled at any time)
+	void init(); //!< configure from JDFTX_PROFILE (called from initSystem)
+	void report(); //!< print and write the configured outputs (called from finalizeSystem on all processes)
+}
+
 //! Quick drop-in profiler for any function. Usage:
 //! * Create a static object of this class in the function
 //! * Call start and stop before and after the section to be timed
-//! * Timing statistics of the code block will be printed on exit
-#ifdef ENABLE_PROFILING
+//! * Optionally call addWork between start and stop to record the floating-point operations and memory traffic of the section
+//! * Timing statistics of the code block will be reported on exit, if enabled (see Profiler)
+//! Watches may be nested, and are accumulated by call path separately for each thread.
+//! They cost only a branch each when profiling is disabled.
 class StopWatch
 {
 public:
 	StopWatch(string name);
-	void start();
-	void stop();
-	void print() const;
+	void start() { if(Profiler::enabled) startActive(); }
+	void stop() { if(Profiler::enabled) stopActive(); }
+	void addWork(double flops, double bytes=0.) { if(Profiler::enabled) addWorkActive(flops, bytes); }
 private:
-	double tPrev, Ttot, TsqTot; int nT;
-	string name;
-};
-#else //ENABLE_PROFILING
-//Version which does no profiling for release versions
-class StopWatch
-{
-public:
-	StopWatch(string name) {}
-	void start() {}
-	void stop() {}
+	int id; //!< index into profiler's list of watch names
+	void startActive();
+	void stopActive();
+	void addWorkActive(double flops, double bytes);
 };
-#endif //ENABLE_PROFILING
 
 
 
@@ -169,19 +169,19 @@ template<typename T> vector3<T> gcdReduce(const vector3<T>& d)
 
 
 //! Load vector from a constant vector field
-template<typename scalar> __hostanddev__ vector3<scalar> loadVector(const vector3<const scalar*>& vArr, int i)
+template<typename scalar> __hostanddev__ vector3<scalar> loadVector(const vector3<const scalar*>& vArr, size_t i)
 {	return vector3<scalar>( vArr[0][i], vArr[1][i], vArr[2][i] );
 }
 //! Load vector from a vector field
-template<typename scalar> __hostanddev__ vector3<scalar> loadVector(const vector3<scalar*>& vArr, int i)
+template<typename scalar> __hostanddev__ vector3<scalar> loadVector(const vector3<scalar*>& vArr, size_t i)
 {	return vector3<scalar>( vArr[0][i], vArr[1][i], vArr[2][i] );
 }
 //! Store vector to a vector field
-template<typename scalar> __hostanddev__ void storeVector(const vector3<scalar>& v, vector3<scalar*>& vArr, int i)
+template<typename scalar> __hostanddev__ void storeVector(const vector3<scalar>& v, vector3<scalar*>& vArr, size_t i)
 {	LOOP3( vArr[k][i] = v[k]; )
 }
 //! Accumulate vector onto a vector field
-template<typename scalar> __hostanddev__ void accumVector(const vector3<scalar>& v, vector3<scalar*>& vArr, int i)
+template<typename scalar> __hostanddev__ void accumVector(const vector3<scalar>& v, vector3<scalar*>& vArr, size_t i)
 {	LOOP3( vArr[k][i] += v[k]; )
 }
 
@@ -25,6 +25,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/BlasExtra.h>
 #include <core/ScalarFieldIO.h>
 #include <fftw3.h>
+#ifdef ZLIB_ENABLED
+#include <zlib.h>
+#endif
 
 // Called by other constructors to do the work
 void ColumnBundle::init(int nc, size_t len, const Basis *b, const QuantumNumber* q, bool onGpu)
@@ -182,8 +185,32 @@ void randomize(std::vector<ColumnBundle>& Y, const ElecInfo& eInfo)
 
 //--------- Read/write an array of ColumnBundles from/to a file --------------
 
-void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) const
-{
+//Convert complex data to single precision (real and imaginary parts interleaved) for compact checkpoints:
+inline void convertToSingle(const complex* in, size_t nData, std::vector<float>& out)
+{	out.resize(2*nData);
+	for(size_t i=0; i<nData; i++)
+	{	out[2*i] = float(in[i].real());
+		out[2*i+1] = float(in[i].imag());
+	}
+}
+
+//Convert single-precision data written by convertToSingle back to complex:
+inline void convertFromSingle(const std::vector<float>& in, complex* out)
+{	for(size_t i=0; i<in.size()/2; i++)
+		out[i] = complex(in[2*i], in[2*i+1]);
+}
+
+//Write complex data to a serial file in double or single precision:
+inline void writeWfnsData(const complex* data, size_t nData, FILE* fp, bool singlePrecision)
+{	if(singlePrecision)
+	{	std::vector<float> buf; convertToSingle(data, nData, buf);
+		fwriteLE(buf.data(), sizeof(float), buf.size(), fp);
+	}
+	else fwriteLE(data, sizeof(complex), nData, fp);
+}
+
+void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname, bool singlePrecision) const
+{	size_t bytesPerData = singlePrecision ? 2*sizeof(float) : sizeof(complex); //bytes per complex entry in file
 #if MPI_SAFE_WRITE
 	//Safe mode / write from head:
 	if(mpiWorld->isHead())
@@ -195,9 +222,9 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 				mpiWorld->recv(nData, whose(q), q);
 				ManagedArray<complex> buf; buf.init(nData);
 				buf.recv(whose(q), q);
-				buf.write(fp);
+				writeWfnsData(buf.data(), nData, fp, singlePrecision);
 			}
-			else Y[q].write(fp);
+			else writeWfnsData(Y[q].data(), Y[q].nData(), fp, singlePrecision);
 		}
 		fclose(fp);
 	}
@@ -210,7 +237,7 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 	//Compute output length from each process:
 	std::vector<long> nBytes(mpiWorld->nProcesses(), 0); //total bytes to be written on each process
 	for(int q=qStart; q<qStop; q++)
-		nBytes[mpiWorld->iProcess()] += Y[q].nData()*sizeof(complex);
+		nBytes[mpiWorld->iProcess()] += Y[q].nData()*bytesPerData;
 	//Sync nBytes across processes:
 	if(mpiWorld->nProcesses()>1)
 		for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
@@ -225,7 +252,12 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 	MPIUtil::File fp; mpiWorld->fopenWrite(fp, fname);
 	mpiWorld->fseek(fp, offset, SEEK_SET);
 	for(int q=qStart; q<qStop; q++)
-		mpiWorld->fwrite(Y[q].data(), sizeof(complex), Y[q].nData(), fp);
+	{	if(singlePrecision)
+		{	std::vector<float> buf; convertToSingle(Y[q].data(), Y[q].nData(), buf);
+			mpiWorld->fwrite(buf.data(), sizeof(float), buf.size(), fp);
+		}
+		else mpiWorld->fwrite(Y[q].data(), sizeof(complex), Y[q].nData(), fp);
+	}
 	mpiWorld->fclose(fp);
 #endif
 }
@@ -236,7 +268,7 @@ ElecInfo::ColumnBundleReadConversion::ColumnBundleReadConversion()
 {
 }
 
-void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion) const
+void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion, bool singlePrecision) const
 {	if(conversion && conversion->realSpace)
 	{	if(qStop==qStart) return; //no k-point on this process
 		const GridInfo* gInfoWfns = Y[qStart].basis->gInfo;
@@ -289,6 +321,31 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 			if(needTmp) Ytmp[q].init(nCols, basis->nbasis*nSpinor, basis, Y[q].qnum);
 			nBytes[mpiWorld->iProcess()] += nCols * basis->nbasis*nSpinor * sizeof(complex);
 		}
+		//Conversion (if any) of state q from Ytmp to Y:
+		auto applyConversion = [&](int q)
+		{	if(!Ytmp[q]) return;
+			if(Ytmp[q].basis!=Y[q].basis)
+			{	int nSpinor = Y[q].spinorLength();
+				for(int b=0; b<std::min(Y[q].nCols(), Ytmp[q].nCols()); b++)
+					for(int s=0; s<nSpinor; s++)
+						Y[q].setColumn(b,s, Ytmp[q].getColumn(b,s)); //convert using the full G-space as an intermediate
+			}
+			else
+			{	if(Ytmp[q].nCols()<Y[q].nCols()) Y[q].setSub(0, Ytmp[q]);
+				else Y[q] = Ytmp[q].getSub(0, Y[q].nCols());
+			}
+			Ytmp[q].free();
+		};
+		//Chunked checkpoints (see dump-wfns-chunked) describe their own layout:
+		if(isChunked(fname))
+		{	std::vector<ColumnBundle*> Ycur(qStop);
+			for(int q=qStart; q<qStop; q++)
+				Ycur[q] = Ytmp[q] ? &Ytmp[q] : &Y[q];
+			readChunked(Ycur, fname);
+			for(int q=qStart; q<qStop; q++)
+				applyConversion(q);
+			return;
+		}
 		//Sync nBytes:
 		if(mpiWorld->nProcesses()>1)
 			for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
@@ -299,6 +356,12 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 		{	if(iSrc<mpiWorld->iProcess()) offset += nBytes[iSrc];
 			fsize += nBytes[iSrc];
 		}
+		//Single-precision checkpoints (see dump-wfns-single-precision) have half the length:
+		if(singlePrecision)
+		{	logPrintf("Reading single-precision wavefunctions from '%s'.\n", fname);
+			offset /= 2;
+			fsize /= 2;
+		}
 		//Read data into Ytmp or Y as appropriate, and convert if necessary:
 		MPIUtil::File fp; mpiWorld->fopenRead(fp, fname, fsize,
 			(e->vibrations and qnums.size()>1)
@@ -308,21 +371,275 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 		mpiWorld->fseek(fp, offset, SEEK_SET);
 		for(int q=qStart; q<qStop; q++)
 		{	ColumnBundle& Ycur = Ytmp[q] ? Ytmp[q] : Y[q];
-			mpiWorld->fread(Ycur.data(), sizeof(complex), Ycur.nData(), fp);
-			if(Ytmp[q]) //apply conversions:
-			{	if(Ytmp[q].basis!=Y[q].basis)
-				{	int nSpinor = Y[q].spinorLength();
-					for(int b=0; b<std::min(Y[q].nCols(), Ytmp[q].nCols()); b++)
-						for(int s=0; s<nSpinor; s++)
-							Y[q].setColumn(b,s, Ytmp[q].getColumn(b,s)); //convert using the full G-space as an intermediate
+			if(singlePrecision)
+			{	std::vector<float> buf(2*Ycur.nData());
+				mpiWorld->fread(buf.data(), sizeof(float), buf.size(), fp);
+				convertFromSingle(buf, Ycur.data());
+			}
+			else mpiWorld->fread(Ycur.data(), sizeof(complex), Ycur.nData(), fp);
+			applyConversion(q);
+		}
+		mpiWorld->fclose(fp);
+	}
+}
+
+//--------- Chunked, self-describing wavefunction checkpoints (see dump-wfns-chunked) --------------
+//
+//File layout (all little-endian):
+//	Header: char magic[8] = "JDFTXWFC", int32 version, flags, nStates, nBands, nSpinor, chunkBands
+//	State table (for each state): double k[3], weight; int32 spin, reserved; int64 nbasis
+//	Chunk table (for each state, for each block of chunkBands bands): int64 offset, followed by int64 nBytes of all chunks
+//	Chunks: complex data of each band block (in ColumnBundle order), optionally truncated to single precision,
+//		and then optionally compressed (zlib deflate of the whole chunk)
+
+static const char chunkedMagic[8] = {'J','D','F','T','X','W','F','C'};
+static const int32_t chunkedVersion = 1;
+enum ChunkedFlags { ChunkedSinglePrecision=1, ChunkedCompressed=2 };
+static const size_t chunkedTargetBytes = size_t(32)<<20; //target uncompressed size per chunk
+
+//Append little-endian binary data to a byte buffer:
+template<typename T> void packLE(std::vector<char>& buf, const T* data, size_t n=1)
+{	size_t start = buf.size();
+	buf.resize(start + n*sizeof(T));
+	memcpy(buf.data()+start, data, n*sizeof(T));
+	convertToLE(buf.data()+start, sizeof(T), n);
+}
+
+//Extract little-endian binary data from a byte buffer, advancing ptr:
+template<typename T> void unpackLE(const char*& ptr, T* data, size_t n=1)
+{	memcpy(data, ptr, n*sizeof(T));
+	convertFromLE(data, sizeof(T), n);
+	ptr += n*sizeof(T);
+}
+
+//Bytes in the fixed part of the header, and in the state table:
+static const size_t chunkedFixedBytes = sizeof(chunkedMagic) + 6*sizeof(int32_t);
+static const size_t chunkedStateBytes = 4*sizeof(double) + 2*sizeof(int32_t) + sizeof(int64_t);
+
+//Convert a band block to its stored form:
+static void packChunk(const complex* data, size_t nData, int flags, std::vector<char>& out)
+{	std::vector<char> raw;
+	if(flags & ChunkedSinglePrecision)
+	{	std::vector<float> buf; convertToSingle(data, nData, buf);
+		packLE(raw, buf.data(), buf.size());
+	}
+	else packLE(raw, (const double*)data, 2*nData);
+	if(flags & ChunkedCompressed)
+	{
+		#ifdef ZLIB_ENABLED
+		uLongf nOut = compressBound(raw.size());
+		out.resize(nOut);
+		if(compress2((Bytef*)out.data(), &nOut, (const Bytef*)raw.data(), raw.size(), Z_BEST_SPEED) != Z_OK)
+			die_alone("Error compressing wavefunction chunk.\n");
+		out.resize(nOut);
+		#else
+		die_alone("Compressed wavefunction checkpoints require a build with EnableZlib.\n");
+		#endif
+	}
+	else out.swap(raw);
+}
+
+//Convert a band block from its stored form:
+static void unpackChunk(const std::vector<char>& in, int flags, complex* data, size_t nData, const char* fname)
+{	size_t nBytesRaw = nData * ((flags & ChunkedSinglePrecision) ? 2*sizeof(float) : sizeof(complex));
+	const char* raw = in.data();
+	std::vector<char> rawBuf;
+	if(flags & ChunkedCompressed)
+	{
+		#ifdef ZLIB_ENABLED
+		rawBuf.resize(nBytesRaw);
+		uLongf nOut = nBytesRaw;
+		if(uncompress((Bytef*)rawBuf.data(), &nOut, (const Bytef*)in.data(), in.size()) != Z_OK || nOut != nBytesRaw)
+			die_alone("Error decompressing a chunk of '%s' (file corrupted?).\n", fname);
+		raw = rawBuf.data();
+		#else
+		die_alone("Reading compressed wavefunctions from '%s' requires a build with EnableZlib.\n", fname);
+		#endif
+	}
+	else if(in.size() != nBytesRaw)
+		die_alone("Chunk of '%s' has %zu bytes instead of %zu (file corrupted?).\n", fname, in.size(), nBytesRaw);
+	if(flags & ChunkedSinglePrecision)
+	{	std::vector<float> buf(2*nData);
+		unpackLE(raw, buf.data(), buf.size());
+		convertFromSingle(buf, data);
+	}
+	else unpackLE(raw, (double*)data, 2*nData);
+}
+
+bool ElecInfo::isChunked(const char* fname)
+{	bool result = false;
+	if(mpiWorld->isHead())
+	{	FILE* fp = fopen(fname, "rb");
+		if(fp)
+		{	char magic[sizeof(chunkedMagic)];
+			result = (fread(magic, 1, sizeof(magic), fp) == sizeof(magic)) && !memcmp(magic, chunkedMagic, sizeof(magic));
+			fclose(fp);
+		}
+	}
+	mpiWorld->bcast(result);
+	return result;
+}
+
+void ElecInfo::writeChunked(const std::vector<ColumnBundle>& Y, const char* fname, bool singlePrecision, bool compress) const
+{	int flags = (singlePrecision ? ChunkedSinglePrecision : 0) | (compress ? ChunkedCompressed : 0);
+	size_t bytesPerData = singlePrecision ? 2*sizeof(float) : sizeof(complex);
+	int nSpinor = spinorLength();
+	
+	//Select bands per chunk (common to all states) to approach the target chunk size:
+	std::vector<int64_t> nbasis(nStates, 0);
+	for(int q=qStart; q<qStop; q++)
+		nbasis[q] = Y[q].basis->nbasis;
+	mpiWorld->allReduce(nbasis.data(), nStates, MPIUtil::ReduceMax);
+	int64_t nbasisMax = *std::max_element(nbasis.begin(), nbasis.end());
+	int chunkBands = std::max(1, std::min(nBands, int(chunkedTargetBytes / (nbasisMax*nSpinor*bytesPerData))));
+	int nChunksPerState = ceildiv(nBands, chunkBands);
+	int nChunks = nStates * nChunksPerState;
+	
+	//Determine stored size of each chunk (compressing local chunks up front, since their size is needed for the offsets):
+	std::vector<int64_t> chunkBytes(nChunks, 0);
+	std::vector<std::vector<char>> packed(nChunks);
+	for(int q=qStart; q<qStop; q++)
+		for(int iChunk=0; iChunk<nChunksPerState; iChunk++)
+		{	int iChunkTot = q*nChunksPerState + iChunk;
+			int bStart = iChunk*chunkBands, bStop = std::min(nBands, bStart+chunkBands);
+			size_t nData = (bStop-bStart) * Y[q].colLength();
+			if(compress)
+			{	packChunk(Y[q].data()+Y[q].index(bStart,0), nData, flags, packed[iChunkTot]);
+				chunkBytes[iChunkTot] = packed[iChunkTot].size();
+			}
+			else chunkBytes[iChunkTot] = nData * bytesPerData; //converted while writing below
+		}
+	mpiWorld->allReduce(chunkBytes.data(), nChunks, MPIUtil::ReduceSum);
+	std::vector<int64_t> chunkOffset(nChunks);
+	int64_t offset = chunkedFixedBytes + nStates*chunkedStateBytes + 2*nChunks*sizeof(int64_t);
+	for(int iChunkTot=0; iChunkTot<nChunks; iChunkTot++)
+	{	chunkOffset[iChunkTot] = offset;
+		offset += chunkBytes[iChunkTot];
+	}
+	
+	//Prepare header and tables:
+	std::vector<char> header;
+	if(mpiWorld->isHead())
+	{	header.assign(chunkedMagic, chunkedMagic+sizeof(chunkedMagic));
+		int32_t dims[6] = { chunkedVersion, flags, nStates, nBands, nSpinor, chunkBands };
+		packLE(header, dims, 6);
+		for(int q=0; q<nStates; q++)
+		{	double kw[4] = { qnums[q].k[0], qnums[q].k[1], qnums[q].k[2], qnums[q].weight };
+			int32_t spin[2] = { qnums[q].spin, 0 };
+			packLE(header, kw, 4);
+			packLE(header, spin, 2);
+			packLE(header, &nbasis[q]);
+		}
+		packLE(header, chunkOffset.data(), nChunks);
+		packLE(header, chunkBytes.data(), nChunks);
+	}
+	
+	//Stored form of a local chunk:
+	std::vector<char> buf;
+	auto getChunk = [&](int q, int iChunk) -> const std::vector<char>&
+	{	int iChunkTot = q*nChunksPerState + iChunk;
+		if(compress) return packed[iChunkTot];
+		int bStart = iChunk*chunkBands, bStop = std::min(nBands, bStart+chunkBands);
+		packChunk(Y[q].data()+Y[q].index(bStart,0), (bStop-bStart)*Y[q].colLength(), flags, buf);
+		return buf;
+	};
+	
+#if MPI_SAFE_WRITE
+	//Safe mode / write from head:
+	if(mpiWorld->isHead())
+	{	FILE* fp = fopen(fname, "wb");
+		if(!fp) die_alone("Error opening file '%s' for writing.\n", fname);
+		fwrite(header.data(), 1, header.size(), fp);
+		std::vector<char> recvBuf;
+		for(int q=0; q<nStates; q++)
+			for(int iChunk=0; iChunk<nChunksPerState; iChunk++)
+			{	if(isMine(q))
+				{	const std::vector<char>& chunk = getChunk(q, iChunk);
+					fwrite(chunk.data(), 1, chunk.size(), fp);
 				}
 				else
-				{	if(Ytmp[q].nCols()<Y[q].nCols()) Y[q].setSub(0, Ytmp[q]);
-					else Y[q] = Ytmp[q].getSub(0, Y[q].nCols());
+				{	recvBuf.resize(chunkBytes[q*nChunksPerState + iChunk]);
+					mpiWorld->recv(recvBuf.data(), recvBuf.size(), whose(q), q);
+					fwrite(recvBuf.data(), 1, recvBuf.size(), fp);
 				}
-				Ytmp[q].free();
 			}
+		fclose(fp);
+	}
+	else
+		for(int q=qStart; q<qStop; q++)
+			for(int iChunk=0; iChunk<nChunksPerState; iChunk++)
+			{	const std::vector<char>& chunk = getChunk(q, iChunk);
+				mpiWorld->send(chunk.data(), chunk.size(), 0, q);
+			}
+#else
+	//Each process writes its chunks at their offsets:
+	MPIUtil::File fp; mpiWorld->fopenWrite(fp, fname);
+	if(mpiWorld->isHead()) mpiWorld->fwrite(header.data(), 1, header.size(), fp);
+	for(int q=qStart; q<qStop; q++)
+		for(int iChunk=0; iChunk<nChunksPerState; iChunk++)
+		{	const std::vector<char>& chunk = getChunk(q, iChunk);
+			mpiWorld->fseek(fp, chunkOffset[q*nChunksPerState + iChunk], SEEK_SET);
+			mpiWorld->fwrite(chunk.data(), 1, chunk.size(), fp);
+		}
+	mpiWorld->fclose(fp);
+#endif
+}
+
+void ElecInfo::readChunked(const std::vector<ColumnBundle*>& Y, const char* fname) const
+{	//Read the header and tables (small, so read independently on each process):
+	FILE* fp = fopen(fname, "rb");
+	if(!fp) die("Error opening file '%s' for reading.\n", fname);
+	std::vector<char> buf(chunkedFixedBytes);
+	if(fread(buf.data(), 1, buf.size(), fp) != buf.size()) die("Error reading header of '%s'.\n", fname);
+	const char* ptr = buf.data() + sizeof(chunkedMagic);
+	int32_t dims[6]; unpackLE(ptr, dims, 6);
+	int version = dims[0], flags = dims[1], nStatesIn = dims[2], nBandsIn = dims[3], nSpinorIn = dims[4], chunkBands = dims[5];
+	if(version > chunkedVersion)
+		die("File '%s' has chunked wavefunction version %d, but this build only supports up to version %d.\n", fname, version, chunkedVersion);
+	if(nStatesIn != nStates || nSpinorIn != spinorLength())
+		die("File '%s' has %d states with %d spinor components instead of %d states with %d.\n"
+			"Hint: Did you specify the correct spintype, kpoint-folding and symmetries?\n",
+			fname, nStatesIn, nSpinorIn, nStates, spinorLength());
+	logPrintf("Reading chunked wavefunctions (version %d, %s precision%s) from '%s'.\n", version,
+		(flags & ChunkedSinglePrecision) ? "single" : "double", (flags & ChunkedCompressed) ? ", compressed" : "", fname);
+	int nChunksPerState = ceildiv(nBandsIn, chunkBands);
+	int nChunks = nStates * nChunksPerState;
+	buf.resize(nStates*chunkedStateBytes + 2*nChunks*sizeof(int64_t));
+	if(fread(buf.data(), 1, buf.size(), fp) != buf.size()) die("Error reading tables of '%s' (file truncated?).\n", fname);
+	ptr = buf.data();
+	std::vector<vector3<>> kIn(nStates);
+	std::vector<int> spinIn(nStates);
+	std::vector<int64_t> nbasisIn(nStates);
+	for(int q=0; q<nStates; q++)
+	{	double kw[4]; unpackLE(ptr, kw, 4);
+		int32_t spin[2]; unpackLE(ptr, spin, 2);
+		unpackLE(ptr, &nbasisIn[q]);
+		kIn[q] = vector3<>(kw[0], kw[1], kw[2]);
+		spinIn[q] = spin[0];
+	}
+	std::vector<int64_t> chunkOffset(nChunks), chunkBytes(nChunks);
+	unpackLE(ptr, chunkOffset.data(), nChunks);
+	unpackLE(ptr, chunkBytes.data(), nChunks);
+	
+	//Read chunks of local states:
+	std::vector<char> chunk;
+	for(int q=qStart; q<qStop; q++)
+	{	ColumnBundle& Yq = *Y[q];
+		if((kIn[q] - qnums[q].k).length_squared() > 1e-12 || spinIn[q] != qnums[q].spin)
+			die_alone("State %d of '%s' is at k = [%lg %lg %lg] with spin %d instead of k = [%lg %lg %lg] with spin %d.\n",
+				q, fname, kIn[q][0], kIn[q][1], kIn[q][2], spinIn[q], qnums[q].k[0], qnums[q].k[1], qnums[q].k[2], qnums[q].spin);
+		if(nBandsIn != Yq.nCols() || size_t(nbasisIn[q]*nSpinorIn) != Yq.colLength())
+			die_alone("State %d of '%s' has %d bands with %ld basis functions instead of %d bands with %zu.\n"
+				"Hint: Did you specify the correct nBandsOld and EcutOld?\n",
+				q, fname, nBandsIn, long(nbasisIn[q]), Yq.nCols(), Yq.colLength()/nSpinorIn);
+		for(int iChunk=0; iChunk<nChunksPerState; iChunk++)
+		{	int iChunkTot = q*nChunksPerState + iChunk;
+			int bStart = iChunk*chunkBands, bStop = std::min(nBandsIn, bStart+chunkBands);
+			chunk.resize(chunkBytes[iChunkTot]);
+			if(fseeko(fp, chunkOffset[iChunkTot], SEEK_SET) || fread(chunk.data(), 1, chunk.size(), fp) != chunk.size())
+				die_alone("Error reading state %d from '%s' (file truncated?).\n", q, fname);
+			unpackChunk(chunk, flags, Yq.data()+Yq.index(bStart,0), (bStop-bStart)*Yq.colLength(), fname);
 		}
-		mpiWorld->fclose(fp);
 	}
+	fclose(fp);
 }
@@ -0,0 +1,90 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/ColumnBundleFile.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Util.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+ColumnBundleFile::ColumnBundleFile(const char* fname, const std::vector<const Basis*>& basisArr, int nBands, int nSpinor, bool singlePrecision)
+: basisArr(basisArr), nBands(nBands), nSpinor(nSpinor), singlePrecision(singlePrecision), offset(basisArr.size()), fd(-1)
+{
+	//Determine required file length:
+	size_t nDataTot = 0;
+	for(const Basis* basis: basisArr)
+		nDataTot += size_t(nBands) * basis->nbasis * nSpinor;
+	off_t fsize = fileSize(fname);
+	if(fsize < 0) die("\nFile '%s' does not exist.\n", fname);
+	size_t bytesRequired = nDataTot * (singlePrecision ? 2*sizeof(float) : sizeof(complex));
+	if(size_t(fsize) < bytesRequired)
+		die("\nFile '%s' is too short: %ld bytes instead of at least %zu bytes.\n", fname, long(fsize), bytesRequired);
+	
+	//Compute state offsets:
+	size_t curOffset = 0;
+	for(size_t q=0; q<basisArr.size(); q++)
+	{	offset[q] = curOffset;
+		curOffset += nBands * bytesPerBand(q);
+	}
+	
+	//Open file:
+	fd = open(fname, O_RDONLY);
+	if(fd < 0) die("\nError opening file '%s' for reading.\n", fname);
+}
+
+ColumnBundleFile::~ColumnBundleFile()
+{	if(fd >= 0) close(fd);
+}
+
+size_t ColumnBundleFile::bytesPerBand(int q) const
+{	return basisArr[q]->nbasis * nSpinor * (singlePrecision ? 2*sizeof(float) : sizeof(complex));
+}
+
+void ColumnBundleFile::read(int q, int bStart, int bStop, ColumnBundle& Y, int bYstart) const
+{	assert(q>=0 && q<nStates());
+	assert(bStart>=0 && bStart<=bStop && bStop<=nBands);
+	assert(Y.colLength() == basisArr[q]->nbasis * nSpinor);
+	assert(bYstart>=0 && bYstart + (bStop-bStart) <= Y.nCols());
+	size_t colLength = Y.colLength();
+	off_t start = offset[q] + bStart*bytesPerBand(q);
+	complex* dest = Y.data() + Y.index(bYstart, 0);
+	size_t nData = (bStop-bStart) * colLength;
+	if(singlePrecision)
+	{	std::vector<float> buf(2*nData);
+		readAt((char*)buf.data(), buf.size()*sizeof(float), start);
+		convertFromLE(buf.data(), sizeof(float), buf.size());
+		for(size_t i=0; i<nData; i++)
+			dest[i] = complex(buf[2*i], buf[2*i+1]);
+	}
+	else
+	{	readAt((char*)dest, nData*sizeof(complex), start);
+		convertFromLE(dest, sizeof(complex), nData);
+	}
+}
+
+void ColumnBundleFile::readAt(char* buf, size_t nBytes, off_t start) const
+{	while(nBytes)
+	{	ssize_t nRead = pread(fd, buf, nBytes, start);
+		if(nRead <= 0) die_alone("\nError reading wavefunction file at offset %ld.\n", long(start));
+		buf += nRead;
+		nBytes -= nRead;
+		start += nRead;
+	}
+}
@@ -0,0 +1,66 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_COLUMNBUNDLEFILE_H
+#define JDFTX_ELECTRONIC_COLUMNBUNDLEFILE_H
+
+#include <electronic/Basis.h>
+
+class ColumnBundle;
+
+//! @addtogroup Output
+//! @{
+//! @file ColumnBundleFile.h Random-access read-only access to wavefunction files
+
+//! Read-only wavefunction file in the format written by ElecInfo::write, from which selected
+//! bands of selected states are read on demand, rather than reading the entire file up front.
+//! This allows post-processing wavefunctions that are larger than the available memory.
+class ColumnBundleFile
+{
+public:
+	//! Open file fname containing nBands bands for each basis in basisArr (in order), with nSpinor components per band.
+	//! The file may contain additional data at the end (eg. more bands for the final state), which will be ignored.
+	//! If singlePrecision, the file is a single-precision checkpoint (see dump-wfns-single-precision).
+	ColumnBundleFile(const char* fname, const std::vector<const Basis*>& basisArr, int nBands, int nSpinor, bool singlePrecision=false);
+	~ColumnBundleFile();
+	
+	//Non-copyable:
+	ColumnBundleFile(const ColumnBundleFile&)=delete;
+	ColumnBundleFile& operator=(const ColumnBundleFile&)=delete;
+	
+	int nStates() const { return basisArr.size(); } //!< number of states (k-points and spins) in file
+	
+	//! Read bands [bStart,bStop) of state q into columns of Y starting at bYstart (Y must have the basis of state q).
+	//! This may be called from several threads simultaneously.
+	void read(int q, int bStart, int bStop, ColumnBundle& Y, int bYstart=0) const;
+	
+private:
+	std::vector<const Basis*> basisArr; //!< basis for each state
+	int nBands, nSpinor;
+	bool singlePrecision; //!< whether data is stored as single-precision complex numbers
+	std::vector<size_t> offset; //!< byte offset of each state in file
+	int fd; //!< file descriptor (read using pread, which does not share a file position between threads)
+	
+	size_t bytesPerBand(int q) const; //!< bytes per band (all spinor components) of state q in file
+	void readAt(char* buf, size_t nBytes, off_t start) const; //!< read nBytes starting at byte offset start into buf
+};
+
+//! @}
+#endif //JDFTX_ELECTRONIC_COLUMNBUNDLEFILE_H
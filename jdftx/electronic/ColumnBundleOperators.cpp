@@ -80,6 +80,7 @@ void ColumnBundleMatrixProduct::scaleAccumulate(double alpha, double beta, Colum
 	callPref(eblas_zgemm)(CblasNoTrans, Mop, Y.colLength(), M->nCols(), Y.nCols(),
 		scaleFac, Y.dataPref(), Y.colLength(), M->dataPref(), M->nRows(),
 		beta, YM.dataPref(), Y.colLength());
+	watch.addWork(8.*Y.colLength()*M->nCols()*Y.nCols(), 16.*(double(Y.colLength())*(Y.nCols()+M->nCols()) + M->nData()));
 	watch.stop();
 }
 
@@ -139,6 +140,7 @@ matrix operator^(const scaled<ColumnBundle> &sY1, const scaled<ColumnBundle> &sY
 	callPref(eblas_zgemm)(CblasConjTrans, CblasNoTrans, nCols1, nCols2, colLength,
 		scaleFac, Y1.dataPref(), colLength, Y2.dataPref(), colLength,
 		0.0, Y1dY2.dataPref(), Y1dY2.nRows());
+	watch.addWork(8.*nCols1*nCols2*colLength, 16.*(double(colLength)*(Y1.nCols()+Y2.nCols()) + Y1dY2.nData()));
 	watch.stop();
 	//If one of the columnbundles was spinor, shape the matrix as if the non-spinor columnbundle had consecutive spinor columns with identical pure up and down spinors
 	if(Y1.nCols() != nCols1) //Y1 is spinor, so double the dimension of output along Y2
@@ -22,7 +22,10 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <core/LatticeUtils.h>
 #include <core/BlasExtra.h>
+#include <core/Thread.h>
 #include <algorithm>
+#include <array>
+#include <map>
 
 ColumnBundleTransform::BasisWrapper::BasisWrapper(const Basis& basis) : basis(basis)
 {	//Determine bounds on iG:
@@ -40,6 +43,75 @@ ColumnBundleTransform::BasisWrapper::BasisWrapper(const Basis& basis) : basis(ba
 		table[dot(pitch,iG+iGbox)] = n++; //valid parts of box will contain corresponding index in basis
 }
 
+//Compute index map for a range of basisC entries:
+void initIndex_sub(size_t iStart, size_t iStop, const vector3<int>* iG_C, const ColumnBundleTransform::BasisWrapper* basisDwrapper,
+	const matrix3<int> affine, const vector3<int> offset, int* index)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	vector3<int> iG_D = iG_C[i] * affine + offset; //corresponding D recip lattice coords
+		index[i] = basisDwrapper->table[dot(basisDwrapper->pitch, iG_D + basisDwrapper->iGbox)]; //use lookup table to get D index
+	}
+}
+
+//Compute translation phases for a range of basisC entries:
+void initPhase_sub(size_t iStart, size_t iStop, const vector3<int>* iG_C, const vector3<> kC, const vector3<> a, complex* phase)
+{	for(size_t i=iStart; i<iStop; i++)
+		phase[i] = cis((2*M_PI)*dot(iG_C[i] + kC, a));
+}
+
+std::shared_ptr<const IndexArray> ColumnBundleTransform::getIndex(const Basis& basisC, const BasisWrapper& basisDwrapper,
+	const matrix3<int>& affine, const vector3<int>& offset)
+{	//Registry key: bases (pointers and sizes, to guard against address reuse) and the affine map
+	typedef std::array<int,14> Transformation;
+	typedef std::pair<std::pair<const Basis*,const Basis*>, Transformation> Key;
+	static std::map<Key, std::weak_ptr<const IndexArray> > registry; //weak references, so that maps are freed with the last transform using them
+	static std::mutex registryLock;
+	static size_t registrySizePurged = 0; //size of registry after the latest purge of expired entries
+	Transformation t;
+	for(int i=0; i<3; i++)
+	{	for(int j=0; j<3; j++) t[3*i+j] = affine(i,j);
+		t[9+i] = offset[i];
+	}
+	t[12] = basisC.nbasis;
+	t[13] = basisDwrapper.basis.nbasis;
+	Key key(std::make_pair(&basisC, &basisDwrapper.basis), t);
+	
+	//Check for an existing map:
+	std::shared_ptr<const IndexArray> result;
+	registryLock.lock();
+	auto iter = registry.find(key);
+	if(iter != registry.end())
+	{	result = iter->second.lock();
+		if(!result) registry.erase(iter); //expired: drop stale entry
+	}
+	registryLock.unlock();
+	if(result) return result;
+	
+	//Otherwise build map:
+	std::shared_ptr<IndexArray> index = std::make_shared<IndexArray>();
+	index->init(basisC.nbasis);
+	threadLaunch(initIndex_sub, basisC.nbasis, basisC.iGarr.data(), &basisDwrapper, affine, offset, index->data());
+	assert(*std::min_element(index->begin(), index->end()) >= 0); //make sure all entries were found
+	
+	//Register (unless an identical map was registered concurrently):
+	registryLock.lock();
+	std::weak_ptr<const IndexArray>& entry = registry[key];
+	result = entry.lock();
+	if(!result)
+	{	result = index;
+		entry = result;
+	}
+	//Purge expired entries of other keys whenever the registry doubles in size (amortized constant cost per lookup):
+	if(registry.size() > 2*registrySizePurged)
+	{	for(auto iter=registry.begin(); iter!=registry.end();)
+		{	if(iter->second.expired()) iter = registry.erase(iter);
+			else iter++;
+		}
+		registrySizePurged = registry.size();
+	}
+	registryLock.unlock();
+	return result;
+}
+
 ColumnBundleTransform::ColumnBundleTransform(const vector3<>& kC, const Basis& basisC, const vector3<>& kD,
 	const ColumnBundleTransform::BasisWrapper& basisDwrapper, int nSpinor, const SpaceGroupOp& sym, int invert, const matrix3<int>& super)
 : basisC(basisC), basisD(basisDwrapper.basis), nSpinor(nSpinor), invert(invert), kC(kC), kD(kD), sym(sym)
@@ -55,20 +127,12 @@ ColumnBundleTransform::ColumnBundleTransform(const vector3<>& kC, const Basis& b
 	assert(offsetErr < symmThreshold);
 	
 	//Initialize index map:
-	index.init(basisC.nbasis);
-	int* indexPtr = index.data();
-	for(const vector3<int>& iG_C: basisC.iGarr) //for each C recip lattice coords
-	{	vector3<int> iG_D = iG_C * affine + offset; //corresponding D recip lattice coords
-		*(indexPtr++) = basisDwrapper.table[dot(basisDwrapper.pitch, iG_D + basisDwrapper.iGbox)]; //use lookup table to get D index
-	}
-	assert(*std::min_element(index.begin(), index.end()) >= 0); //make sure all entries were found
+	index = getIndex(basisC, basisDwrapper, affine, offset);
 	
 	//Initialize translation phase (if necessary)
 	if(sym.a.length_squared())
 	{	phase.init(basisC.nbasis);
-		complex* phasePtr = phase.data();
-		for(const vector3<int>& iG_C: basisC.iGarr)
-			*(phasePtr++) = cis((2*M_PI)*dot(iG_C + kC, sym.a));
+		threadLaunch(initPhase_sub, basisC.nbasis, basisC.iGarr.data(), kC, sym.a, phase.data());
 	}
 	
 	//Initialize spinor transformation:
@@ -95,7 +159,7 @@ void ColumnBundleTransform::scatterAxpy(complex alpha, const ColumnBundle& C_C,
 	//Scatter:
 	for(int sD=0; sD<nSpinor; sD++)
 		for(int sC=0; sC<nSpinor; sC++)
-			callPref(eblas_scatter_zaxpy)(index.nData(), alpha*spinorRot(sD,sC), index.dataPref(),
+			callPref(eblas_scatter_zaxpy)(index->nData(), alpha*spinorRot(sD,sC), index->dataPref(),
 				C_C.dataPref() + C_C.index(bC, sC*C_C.basis->nbasis),
 				C_D.dataPref() + C_D.index(bD, sD*C_D.basis->nbasis), invert<0,
 				phase.dataPref(), invert<0);
@@ -109,7 +173,7 @@ void ColumnBundleTransform::gatherAxpy(complex alpha, const ColumnBundle& C_D, i
 	matrix spinorRotInv = (invert<0) ? transpose(spinorRot) : dagger(spinorRot);
 	for(int sD=0; sD<nSpinor; sD++)
 		for(int sC=0; sC<nSpinor; sC++)
-			callPref(eblas_gather_zaxpy)(index.nData(), alpha*spinorRotInv(sC,sD), index.dataPref(),
+			callPref(eblas_gather_zaxpy)(index->nData(), alpha*spinorRotInv(sC,sD), index->dataPref(),
 				C_D.dataPref() + C_D.index(bD, sD*C_D.basis->nbasis),
 				C_C.dataPref() + C_C.index(bC, sC*C_C.basis->nbasis), invert<0,
 				phase.dataPref(), true);
@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <electronic/Basis.h>
 #include <core/matrix.h>
+#include <memory>
 
 class ColumnBundle;
 
@@ -77,9 +78,14 @@ private:
 	const vector3<> kC, kD;
 	const SpaceGroupOp& sym;
 	
-	//Index array:
-	IndexArray index;
+	//Index array (shared between all transforms with identical index maps, see getIndex):
+	std::shared_ptr<const IndexArray> index;
 	ManagedArray<complex> phase; //Bloch phase for space-group translation
+	
+	//! Retrieve index map for iG_D = iG_C * affine + offset from a registry of currently
+	//! allocated maps, and build it (multi-threaded) only if not already present
+	static std::shared_ptr<const IndexArray> getIndex(const Basis& basisC, const BasisWrapper& basisDwrapper,
+		const matrix3<int>& affine, const vector3<int>& offset);
 
 	matrix spinorRot; //spinor space rotation
 	friend class WannierMinimizer;
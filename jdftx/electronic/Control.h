@@ -34,6 +34,17 @@ static EnumStringMap<BasisKdep> kdepMap(BasisKpointDep, "kpoint-dependent", Basi
 //! Electronic eigenvalue method
 enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson };
 
+//! Method for computing the stress tensor
+enum StressMethod
+{	StressAuto, //!< analytic when supported (IonInfo::hasAnalyticStress), finite differences otherwise
+	StressFiniteDifference, //!< always use finite differences of the energy along strains
+	StressCheck //!< compute both (when analytic is supported), report their difference and use the analytic result
+};
+static EnumStringMap<StressMethod> stressMethodMap(
+	StressAuto, "Auto",
+	StressFiniteDifference, "FiniteDifference",
+	StressCheck, "Check" );
+
 //! Miscellaneous flags controlling electronic DFT
 class Control
 {
@@ -41,6 +52,7 @@ public:
 	bool fixed_H; //!< fixed Hamiltonian (band structure) mode for electronic sector
 	bool cacheProjectors; //!< whether to cache nonlocal projectors
 	double davidsonBandRatio; //!< ratio of number of Davidson working bands to actual bands in system (>= 1)
+	double exxBlockMemory; //!< memory (in bytes) for pair densities, potentials and orbitals of band blocks in exact exchange
 	
 	ElecEigenAlgo elecEigenAlgo; //!< Eigenvalue algorithm
 	BasisKdep basisKdep; //!< k-dependence of basis
@@ -48,6 +60,7 @@ public:
 	
 	bool dragWavefunctions; //!< whether to drag wavefunctions using atomic orbital projections on ionic steps
 	vector3<> lattMoveScale; //!< preconditioning factor for each lattice vector during lattice minimization
+	StressMethod stressMethod; //!< method for computing the stress tensor
 	
 	int fluidGummel_nIterations; //!< max iterations of the fluid<->electron self-consistency loop
 	double fluidGummel_Atol; //!< stopping free-energy tolerance for the fluid<->electron self-consistency loop
@@ -66,8 +79,8 @@ public:
 	
 	Control()
 	:	fixed_H(false),
-		cacheProjectors(true), davidsonBandRatio(1.1),
-		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
+		cacheProjectors(true), davidsonBandRatio(1.1), exxBlockMemory(256e6),
+		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true), stressMethod(StressAuto),
 		fluidGummel_nIterations(10), fluidGummel_Atol(1e-5),
 		shouldPrintEigsFillings(false), shouldPrintEcomponents(false), shouldPrintMuSearch(false), shouldPrintKpointsBasis(false),
 		subspaceRotationFactor(1.), subspaceRotationAdjust(true), scf(false), convergeEmptyStates(false), dumpOnly(false)
@@ -31,9 +31,10 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
 #include <ctime>
+#include <unistd.h>
 
 Dump::Dump()
-: potentialSubtraction(true), curIter(0)
+: potentialSubtraction(true), wfnsSinglePrecision(false), wfnsChunked(false), wfnsCompress(false), fieldsHDF5(false), curIter(0)
 {
 }
 
@@ -41,6 +42,20 @@ void Dump::setup(const Everything& everything)
 {	e = &everything;
 	if(dos) dos->setup(everything);
 	
+	//Background writing of scalar fields (if buffer size specified):
+	const char* bufferSizeStr = getenv("JDFTX_DUMP_BUFFER_SIZE");
+	if(bufferSizeStr)
+	{	int bufferSizeMB;
+		if(sscanf(bufferSizeStr, "%d", &bufferSizeMB)==1 && bufferSizeMB>=0)
+		{	if(bufferSizeMB)
+			{	writer = std::make_shared<DumpWriter>(((size_t)bufferSizeMB) << 20); //convert to bytes
+				logPrintf("Writing scalar field dumps in the background with %d MB buffer.\n", bufferSizeMB);
+			}
+		}
+		else
+			logPrintf("Could not determine dump buffer size from JDFTX_DUMP_BUFFER_SIZE=\"%s\".\n", bufferSizeStr);
+	}
+	
 	//Add some citations here so that they are included in a dry run:
 	for(auto dumpPair: *this)
 		switch(dumpPair.second)
@@ -97,8 +112,12 @@ void Dump::operator()(DumpFrequency freq, int iter)
 		logPrintf("done\n"); logFlush();
 
 	#define DUMP_nocheck(object, prefix) \
-		{	StartDump(prefix) \
-			if(mpiWorld->isHead()) saveRawBinary(object, fname.c_str()); \
+		{	StartDump(string(prefix) + (fieldsHDF5 ? ".h5" : "")) \
+			if(fieldsHDF5) saveHDF5(object, fname.c_str()); \
+			else if(writer) \
+			{	if(mpiWorld->isHead()) writer->queue(object, fname); \
+			} \
+			else saveRawBinaryCollective(object, fname.c_str()); \
 			EndDump \
 		}
 	
@@ -139,10 +158,17 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	
 	if(ShouldDump(State))
 	{
-		//Dump wave functions
-		StartDump("wfns")
-		eInfo.write(eVars.C, fname.c_str());
-		EndDump
+		//Dump wave functions (with a distinct variable name in single precision, so that readers know the format):
+		if(wfnsChunked)
+		{	StartDump("wfnsChunked") //self-describing, so a single variable name for all formats
+			eInfo.writeChunked(eVars.C, fname.c_str(), wfnsSinglePrecision, wfnsCompress);
+			EndDump
+		}
+		else
+		{	StartDump(wfnsSinglePrecision ? "wfnsSingle" : "wfns")
+			eInfo.write(eVars.C, fname.c_str(), wfnsSinglePrecision);
+			EndDump
+		}
 		
 		if(hasFluid)
 		{	//Dump state of fluid:
@@ -605,6 +631,9 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	if(freq==DumpFreq_End && ShouldDump(ElectronScattering))
 	{	electronScattering->dump(*e);
 	}
+	
+	//Make sure all outputs are on disk at the end of the calculation:
+	if(freq==DumpFreq_End && writer) writer->wait();
 }
 
 bool Dump::checkInterval(DumpFrequency freq, int iter) const
@@ -641,3 +670,66 @@ string Dump::getFilename(string varName) const
 	}
 	return fname;
 }
+
+
+//---------------------- class DumpWriter -----------------------------
+
+DumpWriter::DumpWriter(size_t bufferSize)
+: bufferSize(bufferSize), pendingSize(0), stop(false), writer(0)
+{
+}
+
+DumpWriter::~DumpWriter()
+{	if(writer)
+	{	{	std::unique_lock<std::mutex> lock(m);
+			stop = true;
+		}
+		cv.notify_all();
+		writer->join(); //writer thread exits only after emptying the queue
+		delete writer;
+	}
+}
+
+void DumpWriter::queue(const ScalarField& X, string fname)
+{	//Snapshot data (on the main thread, since it may need to be moved from the GPU):
+	ScalarField Xcopy = X->clone();
+	Xcopy->data(); //ensures data is on the CPU
+	size_t size = Xcopy->nElem * sizeof(double);
+	//Wait till there is space in the buffer (a single over-sized entry is allowed if the queue is empty):
+	std::unique_lock<std::mutex> lock(m);
+	cv.wait(lock, [&]{ return pendingSize==0 || pendingSize+size <= bufferSize; });
+	//Add to queue, starting writer if necessary:
+	pending.push_back(std::make_pair(Xcopy, fname));
+	pendingSize += size;
+	if(!writer) writer = new std::thread(&DumpWriter::run, this);
+	lock.unlock();
+	cv.notify_all();
+}
+
+void DumpWriter::wait()
+{	std::unique_lock<std::mutex> lock(m);
+	cv.wait(lock, [&]{ return pending.empty(); });
+}
+
+void DumpWriter::run()
+{	std::unique_lock<std::mutex> lock(m);
+	while(true)
+	{	cv.wait(lock, [&]{ return stop || pending.size(); });
+		if(pending.empty()) break; //stop requested and nothing left to write
+		//Write front of queue without holding the lock:
+		const ScalarField& X = pending.front().first;
+		const string& fname = pending.front().second;
+		lock.unlock();
+		FILE* fp = fopen(fname.c_str(), "wb");
+		if(!fp) die_alone("Could not open '%s' for writing.\n", fname.c_str())
+		saveRawBinary(X, fp);
+		fflush(fp);
+		fsync(fileno(fp)); //make sure the data is on disk before releasing the snapshot
+		fclose(fp);
+		lock.lock();
+		//Release snapshot and notify waiting producers:
+		pendingSize -= X->nElem * sizeof(double);
+		pending.pop_front();
+		cv.notify_all();
+	}
+}
@@ -82,7 +82,12 @@ public:
 	std::shared_ptr<struct BulkEpsilon> bulkEpsilon; //!< bulk dielectric constant calculator
 	std::shared_ptr<struct ChargedDefect> chargedDefect; //!< charged defect correction calculator
 	bool potentialSubtraction; //!< whether to subtract neutral-atom potentials in Dvac and Dtot output
+	bool wfnsSinglePrecision; //!< whether to write wavefunctions in single precision (restart-only checkpoints)
+	bool wfnsChunked; //!< whether to write wavefunctions as chunked, self-describing checkpoints (see dump-wfns-chunked)
+	bool wfnsCompress; //!< whether to compress chunked wavefunction checkpoints (requires zlib)
+	bool fieldsHDF5; //!< whether to write scalar fields (densities, potentials etc.) in chunked HDF5 format
 private:
+	std::shared_ptr<class DumpWriter> writer; //!< background writer for scalar field dumps (if enabled by JDFTX_DUMP_BUFFER_SIZE)
 	const Everything* e;
 	string format; //!< Filename format containing $VAR, $STAMP, $FREQ etc.
 	string stamp; //!< timestamp for current dump
@@ -22,6 +22,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/ScalarFieldArray.h>
 #include <core/Coulomb.h>
+#include <condition_variable>
+#include <thread>
+#include <list>
 
 class Everything;
 class ColumnBundle;
@@ -30,6 +33,29 @@ class ColumnBundle;
 //! @{
 //! @file Dump_internal.h Implementation internals for output modules
 
+//-------------------- Implemented in Dump.cpp ---------------------------
+
+//! Background writer for raw binary scalar field dumps on the head process.
+//! Fields are snapshot when queued, so that the calculation proceeds while they are written out;
+//! queueing blocks while the pending snapshots would exceed the buffer size.
+class DumpWriter
+{
+public:
+	DumpWriter(size_t bufferSize); //!< bufferSize in bytes
+	~DumpWriter(); //!< waits for all pending writes to complete
+	void queue(const ScalarField& X, string fname); //!< write X to fname in the background (call from head process only)
+	void wait(); //!< wait for all pending writes to complete
+private:
+	size_t bufferSize; //!< maximum total size of pending snapshots (bytes)
+	size_t pendingSize; //!< total size of current pending snapshots (bytes)
+	std::list<std::pair<ScalarField,string> > pending; //!< snapshots and filenames queued for writing (in order; front removed after writing)
+	bool stop; //!< signal writer thread to exit
+	std::mutex m;
+	std::condition_variable cv;
+	std::thread* writer; //!< writer thread (started on first use)
+	void run(); //!< writer thread main loop
+};
+
 //-------------------- Implemented in DumpSIC.cpp ---------------------------
 
 //! Output self-interaction correction for the KS eigenvalues
@@ -145,12 +145,19 @@ public:
 		vector3<int> S_old; //!< fftbox size for the input wavefunction in double space
 		ColumnBundleReadConversion();
 	};
-	void read(std::vector<class ColumnBundle>&, const char *fname, const ColumnBundleReadConversion* conversion=0) const; //!< Read array of columnbundles, optionally with conversion
-	void write(const std::vector<class ColumnBundle>&, const char *fname) const; //!< write an array of columnbundles to file
+	void read(std::vector<class ColumnBundle>&, const char *fname, const ColumnBundleReadConversion* conversion=0, bool singlePrecision=false) const; //!< Read array of columnbundles, optionally with conversion (from a single-precision file, if specified)
+	void write(const std::vector<class ColumnBundle>&, const char *fname, bool singlePrecision=false) const; //!< write an array of columnbundles to file, optionally truncated to single precision
+	
+	//! Write an array of columnbundles to a chunked, self-describing checkpoint (see dump-wfns-chunked), with a versioned header
+	//! and a table of states (k-point, spin, basis size) and band-block chunks, optionally in single precision and/or compressed.
+	//! read() recognizes such files by their header, and applies the same conversions as for raw files.
+	void writeChunked(const std::vector<class ColumnBundle>&, const char *fname, bool singlePrecision=false, bool compress=false) const;
+	static bool isChunked(const char* fname); //!< whether fname is a chunked wavefunction checkpoint (call from all processes)
 
 private:
 	const Everything* e;
 	TaskDivision qDivision; //!< MPI division of k-points
+	void readChunked(const std::vector<class ColumnBundle*>& Y, const char *fname) const; //!< read local states of a chunked checkpoint into *Y[q]
 	
 	//Initial fillings:
 	int nBandsOld; //!<number of bands in file being read
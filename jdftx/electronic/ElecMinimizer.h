@@ -60,6 +60,7 @@ public:
 	bool report(int iter);
 	void constrain(ElecGradient&);
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
+	const MPIUtil* metricsComm() const { return mpiWorld; } //!< All processes minimize together
 	
 private:
 	Everything& e;
@@ -32,7 +32,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <limits.h>
 
 ElecVars::ElecVars()
-: isRandom(true), initLCAO(true), skipWfnsInit(false), HauxInitialized(false), lcaoIter(-1), lcaoTol(1e-6)
+: wfnsSinglePrecision(false), isRandom(true), initLCAO(true), skipWfnsInit(false), HauxInitialized(false), lcaoIter(-1), lcaoTol(1e-6)
 {
 }
 
@@ -134,7 +134,7 @@ void ElecVars::setup(const Everything &everything)
 			fname.replace(pos,4, suffix); \
 			logPrintf("Reading " #suffix " from file '%s' ... ", fname.c_str()); logFlush(); \
 			nullToZero(var, e->gInfo); \
-			loadRawBinary(var, fname.c_str()); \
+			loadRawBinaryCollective(var, fname.c_str()); \
 			logPrintf("done\n"); logFlush(); \
 		}
 		#define READ(var) \
@@ -194,7 +194,7 @@ void ElecVars::setup(const Everything &everything)
 		if(wfnsFilename.length())
 		{	logPrintf("reading from '%s'\n", wfnsFilename.c_str()); logFlush();
 			if(readConversion) readConversion->Ecut = e->cntrl.Ecut;
-			eInfo.read(C, wfnsFilename.c_str(), readConversion.get());
+			eInfo.read(C, wfnsFilename.c_str(), readConversion.get(), wfnsSinglePrecision);
 			nBandsInited = (readConversion && readConversion->nBandsOld) ? readConversion->nBandsOld : eInfo.nBands;
 			isRandom = (nBandsInited<eInfo.nBands);
 		}
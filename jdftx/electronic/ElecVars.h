@@ -82,6 +82,7 @@ public:
 
 	//Wavefunction initialization:
 	string wfnsFilename; //!< file to read wavefunctions from
+	bool wfnsSinglePrecision; //!< whether wfnsFilename is in single precision (see dump-wfns-single-precision)
 	std::shared_ptr<struct ElecInfo::ColumnBundleReadConversion> readConversion; //!< ColumnBundle conversion
 	bool isRandom; //!< indicates whether the electronic state is random (not yet minimized)
 	bool initLCAO; //!< initialize wave functions using linear combinations of atomic orbitals
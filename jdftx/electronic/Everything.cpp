@@ -115,6 +115,9 @@ void Everything::setup()
 	updateSupercell();
 	coulomb = coulombParams.createCoulomb(gInfo);
 	
+	//Estimate memory requirements (and reduce them to fit budget if necessary) before the large allocations below:
+	memoryPlan.setup(*this);
+	
 	//Exact exchange (if required)
 	if(exxPresent)
 		exx = std::make_shared<ExactExchange>(*this);
@@ -35,6 +35,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Dump.h>
 #include <electronic/SCFparams.h>
 #include <electronic/IonDynamicsParams.h>
+#include <electronic/MemoryPlan.h>
 #include <memory>
 
 //! @addtogroup ElectronicDFT
@@ -72,6 +73,7 @@ public:
 
 	std::shared_ptr<VanDerWaals> vanDerWaals; //! Pair potential for vdw correction
 	std::shared_ptr<class Vibrations> vibrations; //! Vibrational mode calculator
+	MemoryPlan memoryPlan; //!< Peak memory estimate and optional memory budget
 
 	//! Call the setup/initialize routines of all the above in the necessray order
 	void setup();
@@ -579,7 +579,7 @@ template<typename Func> bool shouldInclude(const std::shared_ptr<Func>& function
 }
 
 double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, IncludeTXC includeTXC,
-		const ScalarFieldArray* tauPtr, ScalarFieldArray* Vtau) const
+		const ScalarFieldArray* tauPtr, ScalarFieldArray* Vtau, matrix3<>* Exc_RRT) const
 {
 	static StopWatch watch("ExCorrTotal"), watchComm("ExCorrCommunication"), watchFunc("ExCorrFunctional");
 	watch.start();
@@ -617,9 +617,14 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 			needsTau |= func->needsTau();
 		}
 	#endif
+	if(Exc_RRT)
+	{	assert(Vxc); //lattice derivative requires the partial derivatives computed for the potential
+		if(nCount != nInCount) die("Lattice derivative of exchange-correlation not implemented for noncollinear magnetism.\n");
+		if(needsLap || needsTau) die("Lattice derivative of exchange-correlation not implemented for meta-GGAs.\n");
+	}
 	
 	//Calculate spatial gradients for GGA (if needed)
-	std::vector<VectorField> Dn(nInCount);
+	std::vector<VectorField> Dn(nInCount), DnAll(Exc_RRT ? nInCount : 0);
 	int iDirStart, iDirStop;
 	TaskDivision(3, mpiWorld).myRange(iDirStart, iDirStop);
 	if(needsSigma)
@@ -628,6 +633,9 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 		{	const ScalarFieldTilde Jn = J(n[s]);
 			for(int i=iDirStart; i<iDirStop; i++)
 				Dn[s][i] = I(D(Jn,i));
+			if(Exc_RRT) //lattice derivative needs all directions on each process
+				for(int i=0; i<3; i++)
+					DnAll[s][i] = Dn[s][i] ? Dn[s][i] : I(D(Jn,i));
 		}
 	}
 	
@@ -770,10 +778,18 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 			func->evaluateSub(gInfo.irStart, gInfo.irStop,
 				constDataPref(nCapped), constDataPref(sigma), constDataPref(lap), constDataPref(tau),
 				E->dataPref(), dataPref(E_n), dataPref(E_sigma), dataPref(E_lap), dataPref(E_tau));
+	if(Profiler::enabled)
+	{	int nInputs = nCount + (needsSigma ? sigmaCount : 0) + (needsLap ? nCount : 0) + (needsTau ? nCount : 0);
+		watchFunc.addWork(0., 8.*(gInfo.irStop-gInfo.irStart)*(2*nInputs+1)); //memory-bound: read inputs, accumulate energy and gradients
+	}
 	watchFunc.stop();
 	
 	//Cleanup unneeded derived quantities (free memory before starting communications and gradient propagation)
 	double Exc = integral(E); E = 0; //note Exc accumulated over processes below in communication block
+	double Exc_nE_n = 0.; //integral of n E_n (for the lattice derivative), similarly accumulated below
+	if(Exc_RRT)
+		for(int s=0; s<nCount; s++)
+			Exc_nE_n += integral(nCapped[s] * E_n[s]);
 	nCapped.clear();
 	sigma.clear();
 	lap.clear();
@@ -782,6 +798,7 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	//---------------- Collect results over processes ----------------
 	watchComm.start();
 	mpiWorld->allReduce(Exc, MPIUtil::ReduceSum);
+	if(Exc_RRT) mpiWorld->allReduce(Exc_nE_n, MPIUtil::ReduceSum);
 	for(ScalarField& x: E_n) if(x) x->allReduce(MPIUtil::ReduceSum);
 	for(ScalarField& x: E_sigma) if(x) x->allReduce(MPIUtil::ReduceSum);
 	for(ScalarField& x: E_lap) if(x) x->allReduce(MPIUtil::ReduceSum);
@@ -821,6 +838,7 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 		}
 
 		//Propagate spatial gradient contribution to density
+		matrix3<> E_DnDn; //sum_s integral(E_Dn_s,i Dn_s,j) (for the lattice derivative)
 		if(needsSigma)
 		{	ScalarFieldTildeArray E_nTilde(nInCount); //contribution to the potential in fourier space
 			for(int i=iDirStart; i<iDirStop; i++)
@@ -843,7 +861,13 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 				//Propagate to E_nTilde:
 				for(int s=0; s<nInCount; s++)
 					E_nTilde[s] -= D(Idag(E_Dni[s]), i);
+				//Contract with gradients for lattice derivative:
+				if(Exc_RRT)
+					for(int s=0; s<nCount; s++)
+						for(int j=0; j<3; j++)
+							E_DnDn(i,j) += integral(E_Dni[s] * DnAll[s][j]);
 			}
+			if(Exc_RRT) mpiWorld->allReduce(&E_DnDn(0,0), 9, MPIUtil::ReduceSum);
 			//Accumulate over processes:
 			for(int s=0; s<nInCount; s++)
 			{	watchComm.start();
@@ -853,6 +877,10 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 				E_n[s] += Jdag(E_nTilde[s],true);
 			}
 		}
+		
+		//Lattice derivative: volume scaling of n and Dn, and change of metric in Dn:
+		if(Exc_RRT)
+			*Exc_RRT += (Exc - Exc_nE_n - trace(E_DnDn)) * matrix3<>(1,1,1) - E_DnDn;
 	}
 	
 	if(Vxc) *Vxc = E_n;
@@ -863,11 +891,11 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 
 //Unpolarized wrapper to above function:
 double ExCorr::operator()(const ScalarField& n, ScalarField* Vxc, IncludeTXC includeTXC,
-		const ScalarField* tau, ScalarField* Vtau) const
+		const ScalarField* tau, ScalarField* Vtau, matrix3<>* Exc_RRT) const
 {	ScalarFieldArray VxcArr(1), tauArr(1), VtauArr(1);
 	if(tau) tauArr[0] = *tau;
 	double Exc =  (*this)(ScalarFieldArray(1, n), Vxc ? &VxcArr : 0, includeTXC,
-		tau ? &tauArr :0, Vtau ? &VtauArr : 0);
+		tau ? &tauArr :0, Vtau ? &VtauArr : 0, Exc_RRT);
 	if(Vxc) *Vxc = VxcArr[0];
 	if(Vtau) *Vtau = VtauArr[0];
 	return Exc;
@@ -45,10 +45,12 @@ private:
 	int nSpins;
 	int nSpinor;
 	int qCount; //!< number of states of each spin
+	int bqBlockSize; //!< number of bands whose pair densities are processed together (see Coulomb::operator() for batches)
 	//Symmetry rotation map:
 	struct KmapEntry
 	{	vector3<> k;
-		Basis basis;
+		std::shared_ptr<Basis> basis; //shared between entries with the same k
+		std::shared_ptr<ColumnBundleTransform::BasisWrapper> basisWrapper; //look-up table for transforms (shared along with basis)
 		std::shared_ptr<ColumnBundleTransform> transform; //wavefunction transformation from reduced set
 	};
 	std::vector<KmapEntry> kmap;
@@ -104,6 +106,10 @@ ExactExchangeEval::ExactExchangeEval(const Everything& e)
 	qCount(e.eInfo.nStates/nSpins),
 	kmap(qCount * invertList.size() * sym.size())
 {
+	//Block size for batched kernel application (limited to cntrl.exxBlockMemory of pair densities, potentials and orbitals per block):
+	double bytesPerBand = (2+nSpinor) * e.gInfo.nr * sizeof(complex);
+	bqBlockSize = std::max(1, std::min(16, int(e.cntrl.exxBlockMemory / bytesPerBand)));
+	
 	//Print cost estimate to give the user some idea of how long it might take!
 	double costFFT = e.eInfo.nStates * e.eInfo.nBands * 9.*e.gInfo.nr*log(e.gInfo.nr);
 	double costBLAS3 = e.eInfo.nStates * pow(e.eInfo.nBands,2) * e.basis[0].nbasis;
@@ -123,11 +129,29 @@ ExactExchangeEval::ExactExchangeEval(const Everything& e)
 	for(unsigned iSym=0; iSym<sym.size(); iSym++)
 	{	KmapEntry& ki = kmap[kmapIndex(iReduced, iInvert, iSym)];
 		ki.k = e.eInfo.qnums[iReduced].k * sym[iSym].rot * invertList[iInvert];
-		ki.basis.setup(e.gInfo, e.iInfo, e.cntrl.Ecut, ki.k);
-		if(e.eInfo.isMine(iReduced) || e.eInfo.isMine(iReduced + qCount))
+		bool needTransform = e.eInfo.isMine(iReduced) || e.eInfo.isMine(iReduced + qCount);
+		//Reuse basis from a previous entry of the same orbit with identical k (if any):
+		for(int iPrev=kmapIndex(iReduced,0,0); iPrev<kmapIndex(iReduced, iInvert, iSym); iPrev++)
+		{	const KmapEntry& kPrev = kmap[iPrev];
+			if((ki.k - kPrev.k).length_squared() < symmThresholdSq)
+			{	ki.basis = kPrev.basis;
+				ki.basisWrapper = kPrev.basisWrapper;
+				break;
+			}
+		}
+		if(!ki.basis)
+		{	ki.basis = std::make_shared<Basis>();
+			ki.basis->setup(e.gInfo, e.iInfo, e.cntrl.Ecut, ki.k);
+		}
+		if(needTransform)
+		{	if(!ki.basisWrapper) ki.basisWrapper = std::make_shared<ColumnBundleTransform::BasisWrapper>(*ki.basis);
 			ki.transform = std::make_shared<ColumnBundleTransform>(e.eInfo.qnums[iReduced].k, e.basis[iReduced],
-				ki.k, ki.basis, nSpinor, sym[iSym], invertList[iInvert]);
+				ki.k, *ki.basisWrapper, nSpinor, sym[iSym], invertList[iInvert]);
+		}
 	}
+	//Drop look-up tables (not needed after transform setup):
+	for(KmapEntry& ki: kmap)
+		ki.basisWrapper = 0;
 	logResume();
 }
 
@@ -137,7 +161,7 @@ double ExactExchangeEval::calc(int iSpin, unsigned iReduced, unsigned iInvert, u
 	//Prepare ik state and gradient on all processes:
 	const KmapEntry& ki = kmap[kmapIndex(iReduced, iInvert, iSym)];
 	int ikSrc = iReduced + iSpin*qCount; //source state number
-	const Basis& basis_k = ki.basis;
+	const Basis& basis_k = *ki.basis;
 	QuantumNumber qnum_k = e.eInfo.qnums[ikSrc]; qnum_k.k =  ki.k;
 	ColumnBundle Ck(e.eInfo.nBands, basis_k.nbasis*nSpinor, &basis_k, &qnum_k, isGpuEnabled()), HCk;
 	diagMatrix Fk(e.eInfo.nBands);
@@ -164,25 +188,45 @@ double ExactExchangeEval::calc(int iSpin, unsigned iReduced, unsigned iInvert, u
 		for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 		{	const QuantumNumber& qnum_q = e.eInfo.qnums[q];
 			if(qnum_k.spin != qnum_q.spin) continue;
-			for(int bq=0; bq<e.eInfo.nBands; bq++)
-			{	double wFq = qnum_q.weight * F[q][bq];
-				if(!wFk && !wFq) continue; //at least one of the orbitals must be occupied
-				
-				std::vector<complexScalarField> Ipsiq(nSpinor);
-				complexScalarField In; //state pair density
-				for(int s=0; s<nSpinor; s++)
-				{	Ipsiq[s] = I(C[q].getColumn(bq,s));
-					In += conj(Ipsik[s]) * Ipsiq[s];
+			//Process bands of q in blocks, applying the exchange kernel to the pair densities of each block together:
+			for(int bqStart=0; bqStart<e.eInfo.nBands; bqStart+=bqBlockSize)
+			{	int bqStop = std::min(bqStart+bqBlockSize, e.eInfo.nBands);
+				std::vector<int> bqArr; //bands in block with non-zero contributions
+				std::vector< std::vector<complexScalarField> > IpsiqArr;
+				std::vector<complexScalarFieldTilde> nArr, KnArr; //state pair densities and their potentials
+				for(int bq=bqStart; bq<bqStop; bq++)
+				{	double wFq = qnum_q.weight * F[q][bq];
+					if(!wFk && !wFq) continue; //at least one of the orbitals must be occupied
+					
+					std::vector<complexScalarField> Ipsiq(nSpinor);
+					complexScalarField In; //state pair density
+					for(int s=0; s<nSpinor; s++)
+					{	Ipsiq[s] = I(C[q].getColumn(bq,s));
+						In += conj(Ipsik[s]) * Ipsiq[s];
+					}
+					bqArr.push_back(bq);
+					if(HC) IpsiqArr.push_back(Ipsiq);
+					nArr.push_back(J(In));
+					KnArr.push_back(nArr.back()->clone());
 				}
-				complexScalarFieldTilde n = J(In);
-				complexScalarFieldTilde Kn = O((*e.coulomb)(n, qnum_q.k-qnum_k.k, omega)); //Electrostatic potential due to n
-				EXX += (prefac*wFk*wFq) * dot(n,Kn).real();
+				(*e.coulomb)(KnArr, qnum_q.k-qnum_k.k, omega); //Electrostatic potential due to each n
 				
-				if(HC)
-				{	complexScalarField E_In = Jdag(Kn);
-					for(int s=0; s<nSpinor; s++)
-					{	grad_Ipsik[s] += (prefac*wFq) * conj(E_In) * Ipsiq[s];
-						(*HC)[q].accumColumn(bq,s, Idag((prefac*wFk) * E_In * Ipsik[s]));
+				for(size_t iBlock=0; iBlock<bqArr.size(); iBlock++)
+				{	int bq = bqArr[iBlock];
+					double wFq = qnum_q.weight * F[q][bq];
+					complexScalarFieldTilde Kn = O(KnArr[iBlock]);
+					KnArr[iBlock] = 0; //free memory as soon as possible
+					EXX += (prefac*wFk*wFq) * dot(nArr[iBlock],Kn).real();
+					nArr[iBlock] = 0;
+					
+					if(HC)
+					{	complexScalarField E_In = Jdag(Kn);
+						const std::vector<complexScalarField>& Ipsiq = IpsiqArr[iBlock];
+						for(int s=0; s<nSpinor; s++)
+						{	grad_Ipsik[s] += (prefac*wFq) * conj(E_In) * Ipsiq[s];
+							(*HC)[q].accumColumn(bq,s, Idag((prefac*wFk) * E_In * Ipsik[s]));
+						}
+						IpsiqArr[iBlock].clear();
 					}
 				}
 			}
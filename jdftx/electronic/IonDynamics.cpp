@@ -209,6 +209,7 @@ void IonDynamics::computeKineticEnergy()
 void IonDynamics::computePressure() // <!  A very similar code can be found in LatticeMinimize.cpp
 {	double h = 1.0e-5; //Magic number from LatticeMinimize
 	matrix3<> Rorig = e.gInfo.R;
+	std::shared_ptr<Coulomb> coulombOrig = e.coulomb; //reused when restoring R below
 	double V_0 = e.gInfo.detR;
 	matrix3<> direction(1.0,1.0,1.0); // identity
 	e.gInfo.R = Rorig + Rorig*(-2*h*direction);
@@ -243,7 +244,7 @@ void IonDynamics::computePressure() // <!  A very similar code can be found in L
 	*/
 	pressure = -centralDifference/(3*V_0);
 	e.gInfo.R = Rorig; // Reset R
-	LatticeMinimizer::updateLatticeDependent(e);
+	LatticeMinimizer::updateLatticeDependent(e, false, coulombOrig);
 }
 
 bool IonDynamics::report(double t)
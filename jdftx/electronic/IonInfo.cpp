@@ -28,6 +28,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/SphericalHarmonics.h>
 #include <core/Units.h>
 #include <cstdio>
+#include <set>
 #include <cmath>
 
 #define MIN_ION_DISTANCE 1e-10
@@ -85,40 +86,59 @@ void IonInfo::printPositions(FILE* fp) const
 // Check for overlapping atoms, returns true if okay
 bool IonInfo::checkPositions() const
 {	bool okay = true;
-	double sizetest = 0;
-	vector3<> vtest[2];
-
-	for(auto sp: species)
-		for(unsigned n=0; n < sp->atpos.size(); n++)
-		{	if(sp->coreRadius == 0.) continue;
-			vtest[0] = sp->atpos[n];
-			for(auto sp1: species)
-			{	if(sp1->coreRadius == 0.) continue;
-				for (unsigned n1 = ((sp1==sp) ? (n+1) : 0); n1 < sp1->atpos.size(); n1++)
-				{	vtest[1] = vtest[0] - sp1->atpos[n1];
-					for(int i=0; i<3; i++) // Get periodic distance
-						vtest[1][i] = vtest[1][i] - floor(vtest[1][i] + 0.5);
-					sizetest = sqrt(dot(e->gInfo.R*vtest[1], e->gInfo.R*vtest[1]));
-					if (coreOverlapCondition==additive and (sizetest < (sp->coreRadius + sp1->coreRadius)))
-					{	logPrintf("\nWARNING: %s #%d and %s #%d are closer than the sum of their core radii.",
-							sp->name.c_str(), n, sp1->name.c_str(), n1);
-						okay = false;
-					}
-					else if (coreOverlapCondition==vector and (sizetest < sqrt(pow(sp->coreRadius, 2) + pow(sp1->coreRadius, 2))))
-					{	logPrintf("\nWARNING: %s #%d and %s #%d are closer than the vector-sum of their core radii.",
-							sp->name.c_str(), n, sp1->name.c_str(), n1);
-						okay = false;
-					}
-					else if(sizetest < MIN_ION_DISTANCE)
-					{	die("\nERROR: Ions %s #%d and %s #%d are on top of eachother.\n\n", sp->name.c_str(), n, sp1->name.c_str(), n1);
-					}
+	
+	//List atoms with non-zero core radii:
+	std::vector< vector3<> > pos;
+	std::vector< std::pair<int,int> > atomIndex; //species and atom index within species
+	double coreRadiusMax = 0.;
+	for(unsigned sp=0; sp<species.size(); sp++)
+	{	if(species[sp]->coreRadius == 0.) continue;
+		coreRadiusMax = std::max(coreRadiusMax, species[sp]->coreRadius);
+		for(unsigned n=0; n<species[sp]->atpos.size(); n++)
+		{	pos.push_back(species[sp]->atpos[n]);
+			atomIndex.push_back(std::make_pair(sp, n));
+		}
+	}
+	
+	//Check pairs within twice the largest core radius (or only for coincident atoms if overlap checks are disabled):
+	double rCut = (coreOverlapCondition==none) ? MIN_ION_DISTANCE : std::max(2.*coreRadiusMax, MIN_ION_DISTANCE);
+	if(!coreNeighborList || coreNeighborList->getCutoff() != rCut)
+		coreNeighborList = std::make_shared<NeighborList>(rCut, 0.5*rCut);
+	coreNeighborList->update(e->gInfo.R, pos); //cores overlap through all periodic images of the grid (even with truncated Coulomb)
+	string overlapFirst; //description of the first overlapping pair
+	std::set< std::pair<size_t,size_t> > overlapPairs; //distinct overlapping atom pairs (counting each pair once over periodic images)
+	for(size_t i=0; i<pos.size(); i++)
+		for(const NeighborList::Neighbor& nbr: (*coreNeighborList)[i])
+		{	if(size_t(nbr.j) == i) continue; //overlap with own images not checked
+			const SpeciesInfo& sp = *species[atomIndex[i].first]; int n = atomIndex[i].second;
+			const SpeciesInfo& sp1 = *species[atomIndex[nbr.j].first]; int n1 = atomIndex[nbr.j].second;
+			double sizetest = sqrt(e->gInfo.RTR.metric_length_squared(coreNeighborList->separation(i, nbr)));
+			const char* overlapType = 0;
+			if (coreOverlapCondition==additive and (sizetest < (sp.coreRadius + sp1.coreRadius)))
+				overlapType = "sum";
+			else if (coreOverlapCondition==vector and (sizetest < sqrt(pow(sp.coreRadius, 2) + pow(sp1.coreRadius, 2))))
+				overlapType = "vector-sum";
+			if(overlapType)
+			{	if(!overlapPairs.size())
+				{	char buf[256];
+					snprintf(buf, sizeof(buf), "%s #%d and %s #%d are closer than the %s of their core radii",
+						sp.name.c_str(), n, sp1.name.c_str(), n1, overlapType);
+					overlapFirst = buf;
 				}
+				overlapPairs.insert(std::make_pair(std::min(i,size_t(nbr.j)), std::max(i,size_t(nbr.j))));
+				okay = false;
+			}
+			else if(sizetest < MIN_ION_DISTANCE)
+			{	die("\nERROR: Ions %s #%d and %s #%d are on top of eachother.\n\n", sp.name.c_str(), n, sp1.name.c_str(), n1);
 			}
 		}
-		
-	if(not okay) // Add another line after printing core overlap warnings
-		logPrintf("\n");
-		
+	
+	if(not okay) //Warn once per check (rather than once per pair and periodic image)
+	{	logPrintf("\nWARNING: %s", overlapFirst.c_str());
+		if(overlapPairs.size() > 1) logPrintf(" (and %lu other pairs of atoms overlap similarly)", overlapPairs.size()-1);
+		logPrintf(".\n");
+	}
+	
 	return okay;
 }
 
@@ -245,6 +265,104 @@ double IonInfo::ionicEnergyAndGrad(IonicGradient& forces) const
 	return relevantFreeEnergy(*e);
 }
 
+bool IonInfo::hasAnalyticStress() const
+{
+	#ifdef GPU_ENABLED
+	return false; //stress kernels only implemented on the CPU
+	#endif
+	const ElecVars& eVars = e->eVars;
+	if(e->coulombParams.geometry != CoulombParams::Periodic || e->coulombParams.embed) return false;
+	if(eVars.fluidParams.fluidType != FluidNone || eVars.rhoExternal || eVars.Vexternal.size()) return false;
+	if(e->exCorr.exxFactor() || e->exCorr.orbitalDep || e->exCorr.needsKEdensity()) return false;
+	if(e->eInfo.hasU || e->eInfo.nDensities > 2 || e->cntrl.fixed_H) return false;
+	if(e->eInfo.spinorLength() > 1) return false; //spinor contraction of the nonlocal term not yet validated against finite differences
+	for(auto sp: species)
+		if(sp->QintAll) return false; //ultrasoft
+	return true;
+}
+
+matrix3<> IonInfo::latticeGradient() const
+{	static StopWatch watch("latticeGradient"); watch.start();
+	assert(hasAnalyticStress());
+	const GridInfo& gInfo = e->gInfo;
+	const ElecInfo& eInfo = e->eInfo;
+	const ElecVars& eVars = e->eVars;
+	const Energies& ener = e->ener;
+	const matrix3<> identity(1,1,1);
+	
+	//Terms that scale inversely with volume at fixed wavefunctions (in addition to the |G| dependence below):
+	matrix3<> E_RRT = -(ener.E["Eloc"] + ener.E["Enl"]) * identity;
+	
+	//Pair potentials (Ewald, vdW):
+	pairPotentialsAndGrad(0, 0, &E_RRT);
+	
+	//Hartree (with the Fourier coefficients of n scaling inversely with volume):
+	ScalarFieldTilde nTilde = J(eVars.get_nTot());
+	E_RRT += 0.5 * e->coulomb->latticeGradient(nTilde, nTilde) - (2*ener.E["EH"]) * identity;
+	
+	//Exchange-correlation (including partial cores):
+	ScalarFieldArray Vxc;
+	e->exCorr(eVars.get_nXC(), &Vxc, false, 0, 0, &E_RRT);
+	ScalarFieldTilde ccgrad_nCore;
+	if(nCore)
+	{	ScalarField VxcCore;
+		matrix3<> ExcCore_RRT;
+		e->exCorr(nCore, &VxcCore, false, 0, 0, &ExcCore_RRT);
+		E_RRT -= ExcCore_RRT;
+		ScalarField VxcAvg = (Vxc.size()==1) ? Vxc[0] : 0.5*(Vxc[0]+Vxc[1]); //spin-avgd potential
+		ccgrad_nCore = J(VxcAvg - VxcCore);
+	}
+	
+	//Local pseudopotential and partial core radial functions:
+	for(auto sp: species)
+		E_RRT += sp->getLocalStress(nTilde, ccgrad_nCore);
+	
+	//Pulay correction (actual number of basis functions per unit volume):
+	double dEtot_dnG = 0.0;
+	for(auto sp: species)
+		dEtot_dnG += sp->atpos.size() * sp->dE_dnG;
+	double nbasisAvg = 0.0;
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+		nbasisAvg += 0.5*eInfo.qnums[q].weight * e->basis[q].nbasis;
+	mpiWorld->allReduce(nbasisAvg, MPIUtil::ReduceSum);
+	E_RRT += (dEtot_dnG * nbasisAvg / gInfo.detR) * identity;
+	
+	//Kinetic and nonlocal terms:
+	matrix3<> Eq_RRT; //contributions from this process's states
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	const QuantumNumber& qnum = eInfo.qnums[q];
+		const ColumnBundle& Cq = eVars.C[q];
+		const diagMatrix& Fq = eVars.F[q];
+		//Kinetic:
+		ColumnBundle DC[3];
+		for(int k=0; k<3; k++) DC[k] = D(Cq, k);
+		for(int k1=0; k1<3; k1++)
+			for(int k2=0; k2<=k1; k2++)
+			{	double KE_k1k2 = -qnum.weight * gInfo.detR * traceinner(Fq, DC[k1], DC[k2]).real();
+				Eq_RRT(k1,k2) += KE_k1k2;
+				if(k2 < k1) Eq_RRT(k2,k1) += KE_k1k2;
+			}
+		//Nonlocal:
+		std::vector<matrix> HVdagCq(species.size());
+		EnlAndGrad(qnum, Fq, eVars.VdagC[q], HVdagCq);
+		for(unsigned sp=0; sp<species.size(); sp++)
+			if(HVdagCq[sp]) species[sp]->accumNonlocalStress(Cq, HVdagCq[sp]*Fq, Eq_RRT);
+	}
+	mpiWorld->allReduce(&Eq_RRT(0,0), 9, MPIUtil::ReduceSum);
+	E_RRT += Eq_RRT;
+	
+	//Symmetrize (state sums are over the reduced k-point set):
+	const std::vector<SpaceGroupOp>& sym = e->symm.getMatrices();
+	matrix3<> E_RRTsym;
+	for(const SpaceGroupOp& op: sym)
+	{	matrix3<> rotCart = gInfo.R * matrix3<>(op.rot) * gInfo.invR;
+		E_RRTsym += rotCart * E_RRT * (~rotCart);
+	}
+	E_RRTsym *= (1./sym.size());
+	watch.stop();
+	return 0.5*(E_RRTsym + (~E_RRTsym));
+}
+
 double IonInfo::EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const std::vector<matrix>& VdagCq, std::vector<matrix>& HVdagCq) const
 {	double Enlq = 0.0;
 	for(unsigned sp=0; sp<species.size(); sp++)
@@ -440,7 +558,7 @@ ColumnBundle IonInfo::getAtomicOrbitals(int q, bool applyO, int extraCols) const
 }
 
 
-void IonInfo::pairPotentialsAndGrad(Energies* ener, IonicGradient* forces) const
+void IonInfo::pairPotentialsAndGrad(Energies* ener, IonicGradient* forces, matrix3<>* E_RRT) const
 {
 	//Obtain the list of atomic positions and charges:
 	std::vector<Atom> atoms;
@@ -450,12 +568,14 @@ void IonInfo::pairPotentialsAndGrad(Energies* ener, IonicGradient* forces) const
 			atoms.push_back(Atom(sp.Z, pos, vector3<>(0.,0.,0.), sp.atomicNumber, spIndex));
 	}
 	//Compute Ewald sum and gradients (this also moves each Atom::pos into fundamental zone)
-	double Eewald = e->coulomb->energyAndGrad(atoms);
+	double Eewald = e->coulomb->energyAndGrad(atoms, E_RRT);
 	//Compute optional pair-potential terms:
 	double EvdW = 0.;
 	if(vdWenable)
 	{	double scaleFac = e->vanDerWaals->getScaleFactor(e->exCorr.getName(), vdWscale);
-		EvdW = e->vanDerWaals->energyAndGrad(atoms, scaleFac); //vanDerWaals energy+force
+		matrix3<> EvdW_strain; //derivative w.r.t strain in lattice coordinates
+		EvdW = e->vanDerWaals->energyAndGrad(atoms, scaleFac, E_RRT ? &EvdW_strain : 0); //vanDerWaals energy+force
+		if(E_RRT) *E_RRT += e->gInfo.invRT * EvdW_strain * e->gInfo.RT; //convert to Cartesian
 	}
 	//Store energies and/or forces if requested:
 	if(ener)
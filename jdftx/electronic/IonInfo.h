@@ -26,6 +26,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/matrix.h>
 #include <core/ScalarField.h>
 #include <core/Thread.h>
+#include <core/NeighborList.h>
 
 //! @addtogroup IonicSystem
 //! @{
@@ -79,6 +80,14 @@ public:
 
 	//! Return the total (free) energy and calculate the ionic gradient (forces)
 	double ionicEnergyAndGrad(IonicGradient& forces) const;
+	
+	//! Whether latticeGradient() supports the current calculation (3D periodic, norm-conserving, collinear LDA/GGA,
+	//! without fluids, external potentials, exact exchange or DFT+U, and on the CPU)
+	bool hasAnalyticStress() const;
+	
+	//! Return the symmetrized lattice derivative (dE/dR) R^T of the total energy with the wavefunctions frozen
+	//! in lattice coordinates (normalized), equal to detR times the stress tensor (requires hasAnalyticStress())
+	matrix3<> latticeGradient() const;
 
 	//! Return the non-local pseudopotential energy due to a single state.
 	//! Optionally accumulate the corresponding electronic gradient in HCq and ionic gradient in forces
@@ -124,9 +133,11 @@ public:
 
 private:
 	const Everything* e;
+	mutable std::shared_ptr<NeighborList> coreNeighborList; //!< neighbour list for checkPositions() (reused between ionic steps)
 	
 	//! Compute all pair-potential terms in the energy or forces (electrostatic, and optionally vdW)
-	void pairPotentialsAndGrad(class Energies* ener=0, IonicGradient* forces=0) const;
+	//! and optionally accumulate their lattice derivative (dE/dR) R^T to E_RRT
+	void pairPotentialsAndGrad(class Energies* ener=0, IonicGradient* forces=0, matrix3<>* E_RRT=0) const;
 };
 
 //! @}
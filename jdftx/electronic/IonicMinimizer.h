@@ -66,6 +66,7 @@ public:
 	static const double maxWfnsDragDisplacement; //!< maximum atom displacement for which wavefunction drag is allowed
 	double safeStepSize(const IonicGradient& dir) const; //!< enforces IonicMinimizer::maxAtomTestDisplacement on test step size
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
+	const MPIUtil* metricsComm() const { return mpiWorld; } //!< All processes minimize together
 	
 	double minimize(const MinimizeParams& params); //!< minor addition to Minimizable::minimize to invoke charge analysis at final positions
 private:
@@ -150,7 +150,7 @@ void LatticeMinimizer::step(const LatticeGradient& dir, double alpha)
 	strain += alpha * dir.lattice;
 	e.gInfo.R = Rorig + Rorig*strain; // Updates the lattice vectors to current strain
 	bcast(e.gInfo.R); //ensure consistency to numerical precision
-	updateLatticeDependent(e, true); // Updates lattice information but does not touch electronic state / calc electronic energy
+	updateLatticeDependent(e, true, alpha ? std::shared_ptr<Coulomb>() : e.coulomb); // Updates lattice information but does not touch electronic state / calc electronic energy (lattice, and hence Coulomb interaction, unchanged if alpha=0)
 
 	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 	{	//Restore wavefunctions from atomic orbitals:
@@ -200,11 +200,41 @@ double LatticeMinimizer::compute(LatticeGradient* grad, LatticeGradient* Kgrad)
 }
 
 void LatticeMinimizer::calculateStress()
-{	matrix3<> E_strain;
-	for(size_t i=0; i<strainBasis.size(); i++)
-		E_strain += strainBasis[i]*centralDifference(strainBasis[i]);
-	e.gInfo.R = Rorig + Rorig*strain;
-	updateLatticeDependent(e);
+{	StressMethod method = e.cntrl.stressMethod;
+	bool analytic = (method != StressFiniteDifference) && e.iInfo.hasAnalyticStress();
+	bool finiteDifference = (!analytic) || (method == StressCheck);
+	if(method==StressCheck && !analytic)
+		logPrintf("\nstress-method Check: analytic stress not supported for this calculation; using finite differences.\n");
+	
+	matrix3<> E_strain, E_strainFD;
+	if(analytic)
+	{	//Convert analytic (dE/dR) R^T to derivative w.r.t strain relative to Rorig, and project to strain basis:
+		matrix3<> E_strainAll = (~Rorig) * e.iInfo.latticeGradient() * e.gInfo.invRT;
+		for(const matrix3<>& s: strainBasis)
+			E_strain += s * dot(s, E_strainAll);
+	}
+	if(finiteDifference)
+	{	std::shared_ptr<Coulomb> coulomb = e.coulomb; //interaction at the current lattice vectors, restored below without recomputing kernels
+		for(size_t i=0; i<strainBasis.size(); i++)
+			E_strainFD += strainBasis[i]*centralDifference(strainBasis[i]);
+		e.gInfo.R = Rorig + Rorig*strain;
+		updateLatticeDependent(e, false, coulomb);
+	}
+	
+	if(!analytic) E_strain = E_strainFD;
+	else if(finiteDifference) //compare analytic and finite-difference results:
+	{	matrix3<> stress = E_strain * (1./e.gInfo.detR);
+		matrix3<> stressFD = E_strainFD * (1./e.gInfo.detR);
+		double maxDev = 0., maxStress = 0.;
+		for(int i=0; i<3; i++)
+			for(int j=0; j<3; j++)
+			{	maxDev = std::max(maxDev, fabs(stress(i,j) - stressFD(i,j)));
+				maxStress = std::max(maxStress, fabs(stressFD(i,j)));
+			}
+		logPrintf("\n# Analytic stress tensor [Eh/a0^3]:\n"); stress.print(globalLog, "%14.7le ");
+		logPrintf("# Finite-difference stress tensor [Eh/a0^3]:\n"); stressFD.print(globalLog, "%14.7le ");
+		logPrintf("StressCheck: maxDeviation %le maxStress %le [Eh/a0^3]\n", maxDev, maxStress);
+	}
 	e.iInfo.stress = E_strain * (1./e.gInfo.detR);
 }
 
@@ -273,15 +303,16 @@ double LatticeMinimizer::sync(double x) const
 	return x;
 }
 
-void LatticeMinimizer::updateLatticeDependent(Everything& e, bool ignoreElectronic)
+void LatticeMinimizer::updateLatticeDependent(Everything& e, bool ignoreElectronic, std::shared_ptr<Coulomb> coulomb)
 {	logSuspend();
+	//Grid metric only (S and hence the FFT plans and basis index sets are unchanged by strain):
 	e.gInfo.update();
 	if(e.gInfoWfns)
 	{	e.gInfoWfns->R = e.gInfo.R;
 		e.gInfoWfns->update();
 	}
 	e.updateSupercell();
-	e.coulomb = e.coulombParams.createCoulomb(e.gInfo);
+	e.coulomb = coulomb ? coulomb : e.coulombParams.createCoulomb(e.gInfo);
 	e.iInfo.update(e.ener);
 	if(!ignoreElectronic)
 	{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
@@ -53,8 +53,9 @@ public:
 	void constrain(LatticeGradient&);
 	double safeStepSize(const LatticeGradient& dir) const;
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
+	const MPIUtil* metricsComm() const { return mpiWorld; } //!< All processes minimize together
 
-	void calculateStress(); //!< calculate current stress (in Eh/a0^3 units) and store to IonInfo::stress
+	void calculateStress(); //!< calculate current stress (in Eh/a0^3 units) and store to IonInfo::stress (by the method selected in Control::stressMethod)
 	double minimize(const MinimizeParams& params); //!< minor addition to Minimizable::minimize to invoke charge analysis at final positions
 private:
 	Everything& e;
@@ -72,8 +73,10 @@ private:
 	double centralDifference(matrix3<> direction);  //! Returns the numerical derivative along the given strain
 	
 	//! Updates lattice dependent quantities, but does not
-	//! reconverge ionic positions or wavefunctions
-	static void updateLatticeDependent(Everything& e, bool ignoreElectronic=false);
+	//! reconverge ionic positions or wavefunctions.
+	//! If coulomb is specified, it is reused instead of recreating the Coulomb interaction
+	//! (and its kernels); it must have been created for exactly the current lattice vectors.
+	static void updateLatticeDependent(Everything& e, bool ignoreElectronic=false, std::shared_ptr<class Coulomb> coulomb=0);
 	
 	friend class IonDynamics;
 };
@@ -0,0 +1,187 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/MemoryPlan.h>
+#include <electronic/Everything.h>
+#include <electronic/SpeciesInfo.h>
+#include <core/ManagedMemory.h>
+#include <core/Metrics.h>
+#include <core/Thread.h>
+#include <functional>
+
+static const double bytesToGB = 1./pow(1024.,3);
+
+std::map<string,double> MemoryPlan::getEstimate(const Everything& e)
+{	const ElecInfo& eInfo = e.eInfo;
+	const Control& cntrl = e.cntrl;
+	const GridInfo& gInfoWfns = e.gInfoWfns ? *e.gInfoWfns : e.gInfo;
+	int nSpinor = eInfo.spinorLength();
+	int nBands = eInfo.nBands;
+	int nStatesMine = eInfo.qStop - eInfo.qStart;
+
+	//Wavefunction and projector sizes:
+	int nProjTot = 0; //projectors of all species (per spinor component)
+	for(const auto& sp: e.iInfo.species)
+		nProjTot += sp->nProjectors() / nSpinor;
+	double bytesC = 0., bytesCmax = 0.; //wavefunctions of all local states, and of the largest one
+	double bytesV = 0., bytesVmax = 0.; //projectors of all local states, and of the largest one
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	double bytesPerColumn = sizeof(complex) * e.basis[q].nbasis;
+		bytesC += bytesPerColumn * nSpinor * nBands;
+		bytesCmax = std::max(bytesCmax, bytesPerColumn * nSpinor * nBands);
+		bytesV += bytesPerColumn * nProjTot;
+		bytesVmax = std::max(bytesVmax, bytesPerColumn * nProjTot);
+	}
+	bool exxPresent = e.exCorr.exxFactor();
+
+	std::map<string,double> est;
+	//--- Wavefunctions, minimizer / eigensolver working set and projectors:
+	bool bandwise = cntrl.scf || cntrl.fixed_H; //eigenvalue problem solved one state at a time
+	int nHistory = (e.elecMinParams.dirUpdateScheme==MinimizeParams::LBFGS) ? e.elecMinParams.history : 0;
+	double bytesWork = 0.;
+	if(bandwise)
+	{	if(cntrl.elecEigenAlgo==ElecEigenDavidson)
+			bytesWork = (6.*cntrl.davidsonBandRatio - 1.) * bytesCmax; //HC, expansion vectors and their images, and rotated outputs at the full working set
+		else
+			bytesWork = (4. + 2.*nHistory) * bytesCmax; //gradient, preconditioned gradient, direction and HC (and L-BFGS history)
+	}
+	else bytesWork = (4. + 2.*nHistory) * bytesC + bytesCmax; //same for all states together, and per-state temporaries
+	if(exxPresent) bytesWork += bytesC + 2.*bytesCmax; //exchange gradient of all states, and transformed orbitals and gradient of one state
+	est["ColumnBundle"] = bytesC + bytesWork + (cntrl.cacheProjectors ? bytesV : bytesVmax);
+
+	//--- Subspace matrices (Hsub, its eigenvectors, auxiliary Hamiltonian and gradients) and projections:
+	double bandRatio = (bandwise && cntrl.elecEigenAlgo==ElecEigenDavidson) ? 2.*cntrl.davidsonBandRatio : 1.;
+	est["matrix"] = sizeof(complex) * nStatesMine * (8.*nBands*nBands + 3.*nProjTot*nSpinor*nBands)
+		+ sizeof(complex) * 6. * std::pow(bandRatio*nBands, 2);
+
+	//--- Basis index arrays (for all states):
+	double bytesBasis = 0.;
+	for(const Basis& basis: e.basis)
+		bytesBasis += basis.nbasis * (sizeof(vector3<int>) + sizeof(int));
+	est["IndexArrays"] = bytesBasis;
+
+	//--- Densities, potentials and their mixing history:
+	int nDensities = eInfo.nDensities;
+	bool needTau = e.exCorr.needsKEdensity();
+	double nFields = (needTau ? 12 : 8) * nDensities + 8;
+	switch(e.eVars.fluidParams.fluidType)
+	{	case FluidNone: break;
+		case FluidLinearPCM: case FluidSaLSA: nFields += 8; break;
+		case FluidNonlinearPCM: nFields += 16; break;
+		case FluidClassicalDFT: nFields += 32; break;
+	}
+	if(cntrl.scf)
+	{	const SCFparams& sp = e.scfParams;
+		int nHistoryMem = sp.historyOnDisk ? 2 : sp.history; //at most the two latest entries are in memory if history is on disk
+		nFields += 2 * nHistoryMem * nDensities * (needTau ? 2 : 1); //past variables and residuals
+	}
+	est["ScalarField"] = sizeof(double) * e.gInfo.nr * nFields;
+	est["ScalarFieldTilde"] = sizeof(complex) * e.gInfo.nG * (10. + 2.*e.iInfo.species.size() + 2.*nDensities);
+
+	//--- Complex real-space fields of orbitals (per thread) and of exact-exchange band blocks:
+	double bytesGridWfns = sizeof(complex) * gInfoWfns.nr;
+	est["complexScalarField"] = bytesGridWfns * nProcsAvailable * (1 + nSpinor);
+	est["complexScalarFieldTilde"] = 0.;
+	if(exxPresent)
+	{	double bytesGrid = sizeof(complex) * e.gInfo.nr;
+		int bqBlockSize = std::max(1, std::min(16, int(cntrl.exxBlockMemory / ((2+nSpinor) * bytesGrid)))); //see ExactExchangeEval
+		est["complexScalarField"] += bytesGrid * nSpinor * (bqBlockSize + 2); //orbitals of block, and of current band and its gradient
+		est["complexScalarFieldTilde"] += bytesGrid * 2 * bqBlockSize; //pair densities and their potentials
+	}
+
+	//Maximum over processes (so that all processes make the same choices below):
+	double total = 0.;
+	for(auto& entry: est)
+	{	mpiWorld->allReduce(entry.second, MPIUtil::ReduceMax);
+		total += entry.second;
+	}
+	est["Total"] = total;
+	return est;
+}
+
+void MemoryPlan::setup(Everything& e)
+{	logPrintf("\n---------- Planning memory usage ----------\n");
+	estimate = getEstimate(e);
+
+	//Select memory-saving options in order of increasing computational cost, till estimate fits within budget:
+	if(budget && estimate["Total"] > budget)
+	{	logPrintf("Estimated peak memory %.3lf GB exceeds budget %.3lf GB per process; selecting:\n",
+			estimate["Total"]*bytesToGB, budget*bytesToGB);
+		Control& cntrl = e.cntrl;
+		bool bandwise = cntrl.scf || cntrl.fixed_H;
+		struct Option
+		{	bool applicable;
+			const char* description;
+			std::function<void()> apply;
+		};
+		std::vector<Option> options = {
+			{ cntrl.scf && !e.scfParams.historyOnDisk,
+				"electronic-scf historyOnDisk yes", [&](){ e.scfParams.historyOnDisk = true; } },
+			{ e.exCorr.exxFactor() && cntrl.exxBlockMemory > 0.,
+				"exact exchange one band at a time", [&](){ cntrl.exxBlockMemory = 0.; } },
+			{ bandwise && cntrl.elecEigenAlgo==ElecEigenDavidson && cntrl.davidsonBandRatio > 1.,
+				"davidson-band-ratio 1", [&](){ cntrl.davidsonBandRatio = 1.; } },
+			{ !(bandwise && cntrl.elecEigenAlgo==ElecEigenDavidson) && e.elecMinParams.dirUpdateScheme==MinimizeParams::LBFGS && e.elecMinParams.history > 3,
+				"electronic-minimize history 3", [&](){ e.elecMinParams.history = 3; } },
+			{ cntrl.cacheProjectors,
+				"cache-projectors no", [&](){ cntrl.cacheProjectors = false; } }
+		};
+		for(const Option& option: options)
+		{	if(!option.applicable) continue;
+			option.apply();
+			double totalPrev = estimate["Total"];
+			estimate = getEstimate(e);
+			logPrintf("\t%-40s (saves %.3lf GB)\n", option.description, (totalPrev-estimate["Total"])*bytesToGB);
+			if(estimate["Total"] <= budget) break;
+		}
+		if(estimate["Total"] > budget)
+			logPrintf("WARNING: estimated peak memory exceeds budget even with all memory-saving options.\n"
+				"Consider more processes (to divide k-points), fewer bands or a lower cutoff.\n");
+	}
+
+	//Report estimate:
+	logPrintf("Estimated peak memory per process:\n");
+	for(const auto& entry: estimate)
+		if(entry.first != "Total")
+			logPrintf("\t%24s %10.3lf GB\n", entry.first.c_str(), entry.second*bytesToGB);
+	logPrintf("\t%24s %10.3lf GB", "Total", estimate["Total"]*bytesToGB);
+	if(budget) logPrintf("  (budget: %.3lf GB)", budget*bytesToGB);
+	logPrintf("\n");
+	Metrics::Record("memoryPlan").add("estimate", estimate["Total"]).add("budget", budget).emit();
+	logFlush();
+}
+
+void MemoryPlan::report() const
+{	std::map<string,ManagedMemoryBase::Usage> usage = ManagedMemoryBase::getUsage();
+	bool tracking = usage.size();
+	mpiWorld->allReduce(tracking, MPIUtil::ReduceLAnd);
+	if(!tracking) return;
+	logPrintf("\nPeak memory per process (maximum over processes), compared to the estimate:\n");
+	std::vector<string> categories;
+	for(const auto& entry: estimate)
+		if(entry.first != "Total")
+			categories.push_back(entry.first);
+	categories.push_back("Total"); //report last
+	for(const string& category: categories)
+	{	double peak = usage[category].peak;
+		mpiWorld->allReduce(peak, MPIUtil::ReduceMax);
+		logPrintf("\t%24s %10.3lf GB  (estimated %.3lf GB)\n", category.c_str(), peak*bytesToGB, estimate.at(category)*bytesToGB);
+	}
+	logFlush();
+}
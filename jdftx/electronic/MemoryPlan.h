@@ -0,0 +1,54 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_MEMORYPLAN_H
+#define JDFTX_ELECTRONIC_MEMORYPLAN_H
+
+#include <core/string.h>
+#include <map>
+
+class Everything;
+
+//! @addtogroup ElectronicDFT
+//! @{
+
+//! Upfront estimate of peak memory per process, by the categories of ManagedMemoryBase::reportUsage,
+//! and selection of memory-saving options to fit the calculation within a budget
+class MemoryPlan
+{
+public:
+	double budget; //!< memory budget per process in bytes (if non-zero, select memory-saving options to fit within it)
+
+	MemoryPlan() : budget(0.) {}
+
+	//! Estimate peak memory and apply memory-saving options if needed to fit within budget.
+	//! Called from Everything::setup once the bases are known, before wavefunctions and other large arrays are allocated.
+	void setup(Everything& e);
+
+	//! Compare the estimate to the actual peak usage by category (no-op unless memory usage tracking is enabled,
+	//! which happens upon processing the memory-budget command, so that all setup allocations are counted)
+	void report() const;
+
+private:
+	std::map<string,double> estimate; //!< estimated peak bytes by category (maximum over processes), including "Total"
+	static std::map<string,double> getEstimate(const Everything& e); //!< compute estimate for the current options
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_MEMORYPLAN_H
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/ColumnBundleTransform.h>
+#include <electronic/ColumnBundleFile.h>
 #include <core/LatticeUtils.h>
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
@@ -41,7 +42,9 @@ class PairDensityCalculator
 		
 		void setup(const Everything& e, vector3<> k, const Supercell::KmeshTransform& kTransform)
 		{	//Get the columnbundle and eigenvalues:
+			nSpinor = e.eInfo.spinorLength();
 			C = &(e.eVars.C[kTransform.iReduced]);
+			bOffset = 0;
 			eig = &(e.eVars.Hsub_eigs[kTransform.iReduced]);
 			//Compute the index array
 			logSuspend();
@@ -51,8 +54,9 @@ class PairDensityCalculator
 				e.eInfo.spinorLength(), e.symm.getMatrices()[kTransform.iSym], kTransform.invert);
 		}
 		
-		void setup(const Everything& e, vector3<> k, string fnameWfns, string fnameEig)
-		{	//Wrap k point to (-0.5,0.5] (consistent with ElecInfo):
+		void setup(const Everything& e, vector3<> k, string fnameWfns, bool singlePrecision, string fnameEig)
+		{	nSpinor = e.eInfo.spinorLength();
+			//Wrap k point to (-0.5,0.5] (consistent with ElecInfo):
 			vector3<> kWrapped = k;
 			for(int j=0; j<3; j++)
 				kWrapped[j] -= ceil(kWrapped[j]-0.5);
@@ -60,14 +64,14 @@ class PairDensityCalculator
 			logSuspend();
 			basisExt.setup(e.gInfo, e.iInfo, e.cntrl.Ecut, kWrapped);
 			logResume();
-			//Read wavefunctions:
-			Cext.init(e.eInfo.nBands, basisExt.nbasis*e.eInfo.spinorLength(), &basisExt, 0);
+			//Open wavefunctions (the required bands are read in by loadBands):
 			off_t flen = fileSize(fnameWfns.c_str());
-			int nBytesPerBand = basisExt.nbasis*sizeof(complex);
-			if(flen < long(Cext.nData()*sizeof(complex))) die("\nFile '%s' does not exist or is too short.\n", fnameWfns.c_str());
+			int nBytesPerBand = basisExt.nbasis * (singlePrecision ? 2*sizeof(float) : sizeof(complex));
 			if(flen % nBytesPerBand) die("\nFile '%s' is not a multiple of %d bytes per band (basis mismatch?).\n", fnameWfns.c_str(), nBytesPerBand);
-			((ManagedMemory<complex>&)Cext).read(fnameWfns.c_str());
-			C = &Cext;
+			wfnsFile = std::make_shared<ColumnBundleFile>(fnameWfns.c_str(), std::vector<const Basis*>(1, &basisExt),
+				e.eInfo.nBands, e.eInfo.spinorLength(), singlePrecision);
+			C = 0;
+			bOffset = 0;
 			//Read eigenvalues:
 			eigExt.resize(e.eInfo.nBands);
 			if(fileSize(fnameEig.c_str()) < 0) die("\nFile '%s' does not exist.\n", fnameEig.c_str());
@@ -86,14 +90,26 @@ class PairDensityCalculator
 		
 		//ColumnBundle::getColumn, but with custom index array:
 		complexScalarFieldTilde getColumn(int col) const
-		{	ColumnBundle Cout(1, C->colLength(), &basisOut, 0, isGpuEnabled());
+		{	ColumnBundle Cout(1, basisOut.nbasis*nSpinor, &basisOut, 0, isGpuEnabled());
 			Cout.zero();
-			transform->scatterAxpy(1., *C,col, Cout,0);
+			assert(C && col>=bOffset && col-bOffset<C->nCols()); //external wavefunctions must be loaded by loadBands
+			transform->scatterAxpy(1., *C,col-bOffset, Cout,0);
 			return Cout.getColumn(0,0);
 		}
 		
+		//Read bands [bStart,bStop) once for use by getColumn (only needed for external wavefunctions):
+		void loadBands(int bStart, int bStop)
+		{	if(!wfnsFile) return;
+			Cext.init(bStop-bStart, basisExt.nbasis*nSpinor, &basisExt, 0);
+			wfnsFile->read(0, bStart, bStop, Cext);
+			C = &Cext;
+			bOffset = bStart;
+		}
+		
 	private:
-		ColumnBundle Cext; diagMatrix eigExt; Basis basisExt, basisOut; //Externally read-in wavefunction, corresponding basis and eigenvalues
+		std::shared_ptr<ColumnBundleFile> wfnsFile; ColumnBundle Cext; diagMatrix eigExt; Basis basisExt, basisOut; //Externally read wavefunctions, bands in use, corresponding basis and eigenvalues
+		int nSpinor;
+		int bOffset; //band index of the first column of C
 	}
 	state1, state2;
 
@@ -110,8 +126,9 @@ public:
 		state1.setup(e, kmesh[ik], kmeshTransform[ik]); //setup first state (always from current system's kmesh)
 		
 		if(e.dump.polarizability->dkFilenamePattern.length()) //get second state from external data
-		{	state2.setup(e, k2,
-				e.dump.polarizability->dkFilename(ik,"wfns"),
+		{	bool singlePrecision;
+			string fnameWfns = e.dump.polarizability->dkWfnsFilename(ik, singlePrecision);
+			state2.setup(e, k2, fnameWfns, singlePrecision,
 				e.dump.polarizability->dkFilename(ik,"eigenvals") );
 		}
 		else //get second state from current system's kmesh as well
@@ -133,8 +150,10 @@ public:
 
 	//Store resulting pair densities scaled by 2*invsqrt(eigenvalue differences) in rho,
 	//so that the non-interacting susceptibility is negative identity in this basis.
-	void compute(int nV, int nC, ColumnBundle& rho, int kOffset) const
-	{	threadLaunch(isGpuEnabled() ? 1 : 0, compute_thread, nV*nC, nV, nC, &rho, kOffset, this);
+	void compute(int nV, int nC, ColumnBundle& rho, int kOffset)
+	{	state1.loadBands(0, nV); //only valence bands of first state
+		state2.loadBands(nV, nV+nC); //only conduction bands of second state
+		threadLaunch(isGpuEnabled() ? 1 : 0, compute_thread, nV*nC, nV, nC, &rho, kOffset, this);
 	}
 	
 	//Accumulate contribution from currentkpoint pair to negative of noninteracting susceptibility in plane-wave basis:
@@ -273,7 +292,8 @@ void Polarizability::dump(const Everything& e)
 	const std::vector< vector3<> >& kmesh = e.coulombParams.supercell->kmesh;
 	if(dkFilenamePattern.length())
 	{	//Check if the required files seem to exist - if not print the required info for someone to generate them:
-		if(fileSize(dkFilename(0,"wfns").c_str()) <= 0)
+		bool singlePrecision;
+		if(fileSize(dkWfnsFilename(0, singlePrecision).c_str()) <= 0)
 		{	logPrintf("\tSave band structure states for the following k-points in the indicated locations:\n");
 			for(unsigned ik=0; ik<kmesh.size(); ik++)
 			{	vector3<> k2 = kmesh[ik] + dk;
@@ -428,3 +448,10 @@ string Polarizability::dkFilename(int ik, string varName) const
 	}
 	return fname;
 }
+
+string Polarizability::dkWfnsFilename(int ik, bool& singlePrecision) const
+{	string fname = dkFilename(ik, "wfns");
+	singlePrecision = (fileSize(fname.c_str()) < 0);
+	if(singlePrecision) fname = dkFilename(ik, "wfnsSingle"); //single-precision checkpoint (see dump-wfns-single-precision)
+	return fname;
+}
@@ -49,6 +49,7 @@ struct Polarizability
 	
 private:
 	string dkFilename(int ik, string varName) const; //!< get the filename to read specified variable for specified k-point
+	string dkWfnsFilename(int ik, bool& singlePrecision) const; //!< get the wavefunction filename for specified k-point (wfns, or else wfnsSingle in single precision)
 	friend class PairDensityCalculator;
 };
 
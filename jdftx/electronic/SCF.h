@@ -49,6 +49,7 @@ public:
 protected:
 	//---- Interface to Pulay ----
 	double sync(double x) const;
+	const MPIUtil* metricsComm() const { return mpiWorld; }
 	double cycle(double dEprev, std::vector<double>& extraValues);
 	void report(int iter);
 	void axpy(double alpha, const SCFvariable& X, SCFvariable& Y) const;
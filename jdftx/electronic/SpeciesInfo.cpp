@@ -387,28 +387,35 @@ void SpeciesInfo::updateLatticeDependent()
 	bool Rchanged = (Rprev != gInfo.R);
 	Rprev = gInfo.R;
 
-	//Change radial function extents if R has changed:
+	//Change radial function extents if R has changed (only grows functions whose current extent is insufficient):
+	bool QradialChanged = !QradialMat;
 	if(Rchanged)
 	{	int nGridLoc = int(ceil(gInfo.GmaxGrid/gInfo.dGradial))+5;
 		VlocRadial.updateGmax(0, nGridLoc);
 		nCoreRadial.updateGmax(0, nGridLoc);
 		tauCoreRadial.updateGmax(0, nGridLoc);
-		for(auto& Qijl: Qradial) Qijl.second.updateGmax(Qijl.first.l, nGridLoc);
+		for(auto& Qijl: Qradial)
+		{	int nCoeffPrev = Qijl.second.nCoeff;
+			Qijl.second.updateGmax(Qijl.first.l, nGridLoc);
+			if(Qijl.second.nCoeff != nCoeffPrev) QradialChanged = true;
+		}
 		cachedV.clear(); //clear any cached projectors
 	}
 	
-	//Update Qradial indices, matrix and nagIndex if not previously init'd, or if R has changed:
-	if(Qint.size() && (Rchanged || !QradialMat))
+	//Update Qradial indices and matrix if not previously init'd, or if their extent has changed,
+	//and nagIndex if R has changed (which reorders the G-vector magnitudes):
+	if(Qint.size() && (Rchanged || QradialChanged))
 	{	int nCoeffHlf = (Qradial.cbegin()->second.nCoeff+1)/2; //pack real radial functions into complex numbers
 		int nCoeff = 2*nCoeffHlf;
-		//Qradial:
-		QradialMat = zeroes(nCoeffHlf, Qradial.size());
-		double* QradialMatData = (double*)QradialMat.dataPref();
-		int index=0;
-		for(auto& Qijl: Qradial)
-		{	((QijIndex&)Qijl.first).index = index;
-			callPref(eblas_copy)(QradialMatData+index*nCoeff, Qijl.second.coeffPref(), Qijl.second.nCoeff);
-			index++;
+		if(QradialChanged)
+		{	QradialMat = zeroes(nCoeffHlf, Qradial.size());
+			double* QradialMatData = (double*)QradialMat.dataPref();
+			int index=0;
+			for(auto& Qijl: Qradial)
+			{	((QijIndex&)Qijl.first).index = index;
+				callPref(eblas_copy)(QradialMatData+index*nCoeff, Qijl.second.coeffPref(), Qijl.second.nCoeff);
+				index++;
+			}
 		}
 		//nagIndex:
 		nagIndex.init(gInfo.iGstop-gInfo.iGstart);
@@ -508,6 +515,20 @@ void SpeciesInfo::setPsi(std::vector<std::vector<RadialFunctionR> >& psiArr)
 	}
 }
 
+std::vector<std::pair<int,const RadialFunctionG*> > SpeciesInfo::getRadialFunctions() const
+{	std::vector<std::pair<int,const RadialFunctionG*> > result;
+	auto add = [&](int l, const RadialFunctionG& func) { if(func.rFunc) result.push_back(std::make_pair(l, &func)); };
+	add(0, VlocRadial);
+	add(0, nCoreRadial);
+	add(0, tauCoreRadial);
+	for(unsigned l=0; l<VnlRadial.size(); l++)
+		for(const RadialFunctionG& func: VnlRadial[l]) add(l, func);
+	for(const auto& entry: Qradial) add(entry.first.l, entry.second);
+	for(unsigned l=0; l<psiRadial.size(); l++)
+		for(const RadialFunctionG& func: psiRadial[l]) add(l, func);
+	return result;
+}
+
 //---------- Spin-angle helper functions ------------
 
 matrix SpeciesInfo::getYlmToSpinAngleMatrix(int l, int j2)
@@ -144,9 +144,19 @@ public:
 	//! Propagate gradient with respect to atomic projections (in E_VdagC, along with additional overlap contributions from grad_CdagOC) to forces:
 	void accumNonlocalForces(const ColumnBundle& Cq, const matrix& VdagC, const matrix& E_VdagC, const matrix& grad_CdagOCq, std::vector<vector3<> >& forces) const;
 	
+	//! Return the strain derivative (dE/dR) R^T of the local energies due to the |G|-dependence of Vlocps and nCore (norm-conserving only)
+	matrix3<> getLocalStress(const ScalarFieldTilde& ccgrad_Vlocps, const ScalarFieldTilde& ccgrad_nCore) const;
+	
+	//! Accumulate the strain derivative (dE/dR) R^T of the nonlocal energy due to the q-dependence of the projectors,
+	//! given the gradient with respect to atomic projections in E_VdagC (norm-conserving only)
+	void accumNonlocalStress(const ColumnBundle& Cq, const matrix& E_VdagC, matrix3<>& E_RRT) const;
+	
 	//! Spin-angle helper functions:
 	static matrix getYlmToSpinAngleMatrix(int l, int j2); //!< Get the ((2l+1)*2)x(j2+1) matrix that transforms the Ylm+spin to the spin-angle functions, where j2=2*j with j = l+/-0.5
 	static matrix getYlmOverlapMatrix(int l, int j2); //!< Get the ((2l+1)*2)x((2l+1)*2) overlap matrix of the spin-spherical harmonics for total angular momentum j (note j2=2*j)
+	
+	//! Get all radial functions of this species that were transformed from real space, along with their angular momentum and uniform G grid (eg. for benchmarking transforms)
+	std::vector<std::pair<int,const RadialFunctionG*> > getRadialFunctions() const;
 private:
 	matrix3<> Rprev; void updateLatticeDependent(); //!< If Rprev differs from gInfo.R, update the lattice dependent quantities (such as the radial functions)
 
@@ -28,9 +28,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 //Return non-local energy and optionally accumulate its electronic and/or ionic gradients for a given quantum number
 double SpeciesInfo::EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const matrix& VdagCq, matrix& HVdagCq) const
-{	static StopWatch watch("EnlAndGrad"); watch.start();
-	if(!atpos.size()) return 0.; //unused species
+{	if(!atpos.size()) return 0.; //unused species
 	if(!MnlAll) return 0.; //purely local psp
+	static StopWatch watch("EnlAndGrad"); watch.start();
 	int nProj = MnlAll.nRows();
 	
 	matrix MVdagC = zeroes(VdagCq.nRows(), VdagCq.nCols());
@@ -42,6 +42,7 @@ double SpeciesInfo::EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq,
 		Enlq += trace(Fq * dagger(atomVdagC) * MatomVdagC).real();
 	}
 	HVdagCq += MVdagC;
+	watch.addWork(16.*atpos.size()*nProj*nProj*VdagCq.nCols(), 16.*(MnlAll.nData() + 3*VdagCq.nData()));
 	watch.stop();
 	return Enlq;
 }
@@ -253,6 +254,46 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 	}
 }
 
+matrix3<> SpeciesInfo::getLocalStress(const ScalarFieldTilde& ccgrad_Vlocps, const ScalarFieldTilde& ccgrad_nCore) const
+{	matrix3<> E_RRT;
+	if(!atpos.size()) return E_RRT; //unused species
+	const GridInfo& gInfo = e->gInfo;
+	::localStress(gInfo.S, gInfo.G, ccgrad_Vlocps->data(), nCoreRadial ? ccgrad_nCore->data() : 0,
+		atpos.size(), atpos.data(), VlocRadial, Z, nCoreRadial, E_RRT);
+	return E_RRT;
+}
+
+void SpeciesInfo::accumNonlocalStress(const ColumnBundle& Cq, const matrix& E_VdagC, matrix3<>& E_RRT) const
+{	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
+	int nProj = MnlAll.nRows() / e->eInfo.spinorLength();
+	if(!nProj) return; //purely local psp
+	//Strain derivatives of the projectors (same layout as getV; operator^ expands them to the spinor layout of E_VdagC):
+	std::vector<ColumnBundle> dV(6);
+	complex* dVdata[6];
+	for(int c=0; c<6; c++)
+	{	dV[c].init(nProj*atpos.size(), basis.nbasis, &basis, &qnum, false);
+		dVdata[c] = dV[c].data();
+	}
+	int iProj = 0;
+	for(int l=0; l<int(VnlRadial.size()); l++)
+		for(unsigned p=0; p<VnlRadial[l].size(); p++)
+			for(int m=-l; m<=l; m++)
+			{	size_t offs = iProj * basis.nbasis;
+				size_t atomStride = nProj * basis.nbasis;
+				complex* dVoffs[6]; for(int c=0; c<6; c++) dVoffs[c] = dVdata[c] + offs;
+				::VnlStress(basis.nbasis, atomStride, atpos.size(), l, m, qnum.k, basis.iGarr.data(), basis.gInfo->G, atpos.data(), VnlRadial[l][p], dVoffs);
+				iProj++;
+			}
+	//Contract with gradient:
+	const int a[6] = {0,1,2,1,2,0}, b[6] = {0,1,2,2,0,1};
+	for(int c=0; c<6; c++)
+	{	double E_c = 2.*qnum.weight * trace(E_VdagC * dagger(dV[c]^Cq)).real();
+		E_RRT(a[c],b[c]) += E_c;
+		if(a[c] != b[c]) E_RRT(b[c],a[c]) += E_c;
+	}
+}
+
 std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq) const
 {	const QuantumNumber& qnum = *(Cq.qnum);
 	const Basis& basis = *(Cq.basis);
@@ -36,6 +36,17 @@ void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k
 {	SwitchTemplate_lm(l,m, Vnl, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V) )
 }
 
+//Strain derivatives of non-local projector from a radial function at a particular l,m
+template<int l, int m>
+void VnlStress(int nbasis, int atomStride, int nAtoms, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* const* dV)
+{	threadedLoop(VnlStress_calc<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, dV);
+}
+void VnlStress(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* const* dV)
+{	SwitchTemplate_lm(l,m, VnlStress, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, dV) )
+}
+
 //Augment electron density by spherical functions
 template<int Nlm> void nAugment_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
@@ -167,6 +178,26 @@ void gradLocalToSG(const vector3<int> S, const matrix3<> GGT,
 }
 
 //Gradient w.r.t structure factor -> gradient w.r.t atom positions
+void localStress_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, double Z, const RadialFunctionG& nCoreRadial, matrix3<>* E_RRT, std::mutex* m)
+{	matrix3<> E_RRTsub;
+	THREAD_halfGspaceLoop(
+		double weight = (iG[2]==0 || 2*iG[2]==S[2]) ? 1. : 2.; //account for real symmetry
+		E_RRTsub += weight * localStress_calc(i, iG, G, ccgrad_Vlocps, ccgrad_nCore, nAtoms, atpos, VlocRadial, Z, nCoreRadial);
+	)
+	m->lock();
+	*E_RRT += E_RRTsub;
+	m->unlock();
+}
+void localStress(const vector3<int> S, const matrix3<> G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, double Z, const RadialFunctionG& nCoreRadial, matrix3<>& E_RRT)
+{	std::mutex m;
+	threadLaunch(localStress_sub, S[0]*S[1]*(S[2]/2+1), S, G, ccgrad_Vlocps, ccgrad_nCore, nAtoms, atpos,
+		VlocRadial, Z, nCoreRadial, &E_RRT, &m);
+}
+
 void gradSGtoAtpos_sub(size_t iStart, size_t iStop, const vector3<int> S, const vector3<> atpos,
 	const complex* ccgrad_SG, vector3<complex*> grad_atpos)
 {	THREAD_halfGspaceLoop( gradSGtoAtpos_calc(i, iG, atpos, ccgrad_SG, grad_atpos); )
@@ -51,6 +51,30 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3
 	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* Vnl);
 #endif
 
+//! Compute the strain derivatives of Vnl, -(d Vnl/d q_a) q_b symmetrized in a,b (Cartesian),
+//! for the six components (a,b) = (0,0), (1,1), (2,2), (1,2), (2,0), (0,1) in dV[0] to dV[5]
+template<int l, int m> __hostanddev__
+void VnlStress_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* const* dV)
+{
+	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
+	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
+	double q = qvec.length();
+	vector3<> qhat = qvec * (q ? 1.0/q : 0.0); //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
+	vector3<> YlmPrime_q = YlmPrime<l,m>(qhat); //q * gradient of Ylm w.r.t q
+	matrix3<> prefac = (-VnlRadial.deriv(q) * q * Ylm<l,m>(qhat)) * outer(qhat,qhat)
+		- (0.5*VnlRadial(q)) * (outer(qhat,YlmPrime_q) + outer(YlmPrime_q,qhat));
+	const int a[6] = {0,1,2,1,2,0}, b[6] = {0,1,2,2,0,1};
+	//Loop over columns (multiple atoms at same l,m):
+	for(int atom=0; atom<nAtoms; atom++)
+	{	complex phase = cis((-2*M_PI)*dot(pos[atom],kpG));
+		for(int c=0; c<6; c++)
+			dV[c][atom*atomStride+n] = prefac(a[c],b[c]) * phase;
+	}
+}
+void VnlStress(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* const* dV);
+
 
 //! Perform the loop:
 //!   for(lm=0; lm < Nlm; lm++) (*f)(tag< lm >);
@@ -284,6 +308,27 @@ void gradLocalToSG_gpu(const vector3<int> S, const matrix3<> GGT,
 #endif
 
 
+//! Strain derivative (Cartesian, (dE/dR) R^T) of the local pseudopotential and partial-core energies at a given G-vector,
+//! due to the change in |G| at fixed structure factor (the volume factors are handled separately in IonInfo)
+__hostanddev__ matrix3<> localStress_calc(int i, const vector3<int>& iG, const matrix3<>& G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, double Z, const RadialFunctionG& nCoreRadial)
+{
+	vector3<> Gvec = iG * G;
+	double Gsq = Gvec.length_squared();
+	if(!Gsq) return matrix3<>(); //no |G| dependence
+	double Gmag = sqrt(Gsq);
+	complex SG = getSG_calc(iG, nAtoms, atpos);
+	//Derivative w.r.t |G| (local potential includes long-ranged part -4 pi Z/G^2):
+	double E_G = (ccgrad_Vlocps[i].conj() * SG).real() * (VlocRadial.deriv(Gmag) + 8*M_PI*Z/(Gsq*Gmag));
+	if(ccgrad_nCore) E_G += (ccgrad_nCore[i].conj() * SG).real() * nCoreRadial.deriv(Gmag);
+	return (-E_G/Gmag) * outer(Gvec,Gvec); //since strain changes G by -strain^T G
+}
+void localStress(const vector3<int> S, const matrix3<> G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, double Z, const RadialFunctionG& nCoreRadial, matrix3<>& E_RRT);
+
+
 //! Propagate the complex conjugate gradient w.r.t the structure factor to the given atomic position
 //! this is still per G-vector, need to sum grad_atpos over G to get the force on that atom
 __hostanddev__ void gradSGtoAtpos_calc(int i, const vector3<int> iG, const vector3<> atpos,
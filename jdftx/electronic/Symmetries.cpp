@@ -59,7 +59,7 @@ void Symmetries::setup(const Everything& everything)
 
 void Symmetries::setupMesh()
 {	checkFFTbox(); //Check that the FFT box is commensurate with the symmetries and initialize mesh matrices
-	initSymmIndex(); //Initialize the equivalence classes for scalar field symmetrization (using mesh matrices)
+	initOrbits(); //Initialize the equivalence classes for scalar field symmetrization (using mesh matrices)
 }
 
 //Pack and unpack kpoint map entry to a single 64-bit integer
@@ -70,6 +70,30 @@ inline void kmapUnpack(unsigned long long kmap, size_t& iSrc, int& invert, int&
 	iSym = int(0x7F & kmap);
 }
 
+//Find the preferred source k-point and symmetry operation (see reduceKmesh) for a range of destination k-points.
+//Each destination entry is written only by one thread, and the symmetry-commensurate flags are combined under a lock.
+void reduceKmesh_sub(size_t iStart, size_t iStop, size_t iDestOffset, const std::vector<QuantumNumber>* qnums,
+	const PeriodicLookup<QuantumNumber>* plook, const std::vector<int>* invertList, const std::vector<matrix3<>>* rotInv,
+	unsigned long long* kmap, std::vector<int>* isSymKmesh, std::mutex* m)
+{	std::vector<int> isSymKmeshLocal(rotInv->size(), true);
+	for(size_t iDest=iStart+iDestOffset; iDest<iStop+iDestOffset; iDest++)
+	{	const vector3<>& kDest = qnums->at(iDest).k;
+		for(int invert: *invertList)
+			for(int iSym=0; iSym<int(rotInv->size()); iSym++)
+			{	size_t iSrc = plook->find(invert * kDest * rotInv->at(iSym)); //source k-point which maps to kDest
+				if(iSrc != string::npos)
+					kmap[iDest] = std::min(kmap[iDest], kmapPack(iSrc, invert, iSym));
+				else
+				{	if(invert>0) isSymKmeshLocal[iSym] = false; //(symmetry maps mesh into itself iff every point has a pre-image)
+				}
+			}
+	}
+	m->lock();
+	for(size_t iSym=0; iSym<isSymKmeshLocal.size(); iSym++)
+		if(!isSymKmeshLocal[iSym]) isSymKmesh->at(iSym) = false;
+	m->unlock();
+}
+
 std::vector<QuantumNumber> Symmetries::reduceKmesh(const std::vector<QuantumNumber>& qnums) const
 {	static StopWatch watch("reduceKmesh"); watch.start();
 	if(mode == SymmetriesNone)
@@ -90,19 +114,14 @@ std::vector<QuantumNumber> Symmetries::reduceKmesh(const std::vector<QuantumNumb
 	std::vector<unsigned long long>& kmap = ((Symmetries*)this)->kmap;
 	kmap.assign(qnums.size(), ~0ULL); //list of source k-point and symmetry operation (ordered to prefer no inversion, earliest k-point and then earliest symmetry matrix)
 	std::vector<int> isSymKmesh(sym.size(), true); //whether each symmetry matrix leaves the k-mesh invariant
-	size_t iSrcStart, iSrcStop;
-	TaskDivision(qnums.size(), mpiWorld).myRange(iSrcStart, iSrcStop);
+	std::vector<matrix3<>> rotInv(sym.size()); //inverse rotations to look up the source of each destination k-point
+	for(size_t iSym=0; iSym<sym.size(); iSym++)
+		rotInv[iSym] = inv(matrix3<>(sym[iSym].rot));
+	size_t iDestStart, iDestStop;
+	TaskDivision(qnums.size(), mpiWorld).myRange(iDestStart, iDestStop);
 	PeriodicLookup<QuantumNumber> plook(qnums, e->gInfo.GGT);
-	for(size_t iSrc=iSrcStart; iSrc<iSrcStop; iSrc++)
-		for(int invert: invertList)
-			for(int iSym=0; iSym<int(sym.size()); iSym++)
-			{	size_t iDest = plook.find(invert * qnums[iSrc].k * sym[iSym].rot);
-				if(iDest != string::npos)
-					kmap[iDest] = std::min(kmap[iDest], kmapPack(iSrc, invert, iSym));
-				else
-				{	if(invert>0) isSymKmesh[iSym] = false;
-				}
-			}
+	std::mutex m;
+	threadLaunch(reduceKmesh_sub, iDestStop-iDestStart, iDestStart, &qnums, &plook, &invertList, &rotInv, kmap.data(), &isSymKmesh, &m);
 	//Sync map across processes
 	mpiWorld->allReduce(kmap.data(), kmap.size(), MPIUtil::ReduceMin);
 	mpiWorld->allReduce(isSymKmesh.data(), isSymKmesh.size(), MPIUtil::ReduceLAnd);
@@ -123,21 +142,26 @@ std::vector<QuantumNumber> Symmetries::reduceKmesh(const std::vector<QuantumNumb
 	}
 	//Compile set of source k-points and whether inversion is necessary:
 	bool usedInversion = false;
-	std::map<size_t,size_t> iSrcMap; //map from original to reduced kpoints
+	std::vector<size_t> iSrcMap(qnums.size(), string::npos); //map from original to reduced kpoints
 	for(unsigned long long kmapEntry: kmap)
 	{	size_t iSrc; int invert, iSym;
 		kmapUnpack(kmapEntry, iSrc, invert, iSym);
 		iSrcMap[iSrc] = 0;
 		if(invert<0) usedInversion = true;
 	}
-	size_t iReduced=0; for(auto& mapEntry: iSrcMap) mapEntry.second = (iReduced++);
+	size_t nReduced=0;
+	for(size_t& iReduced: iSrcMap)
+		if(iReduced != string::npos)
+			iReduced = (nReduced++);
 	//Set invertList:
 	if(usedInversion) logPrintf("Adding inversion symmetry to k-mesh for non-inversion-symmetric unit cell.\n");
 	else invertList.resize(1); //drop explicit inversion if not required
 	((Symmetries*)this)->kpointInvertList = invertList; //Set kpointInvertList
 	//Compile list of reduced kpoints:
-	std::vector<QuantumNumber> qRed(iSrcMap.size());
-	for(const auto& mapEntry: iSrcMap) qRed[mapEntry.second] = qnums[mapEntry.first];
+	std::vector<QuantumNumber> qRed(nReduced);
+	for(size_t iSrc=0; iSrc<qnums.size(); iSrc++)
+		if(iSrcMap[iSrc] != string::npos)
+			qRed[iSrcMap[iSrc]] = qnums[iSrc];
 	//Update iSrc in map with the reduced value, and accumulate weights:
 	for(size_t iDest=0; iDest<qnums.size(); iDest++)
 	{	unsigned long long& kmapEntry = kmap[iDest];
@@ -154,20 +178,58 @@ std::vector<QuantumNumber> Symmetries::reduceKmesh(const std::vector<QuantumNumb
 //Symmetrize scalar fields:
 void Symmetries::symmetrize(ScalarField& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
-	complexScalarFieldTilde xTilde = J(Complex(x));
+	ScalarFieldTilde xTilde = J(x);
 	symmetrize(xTilde);
-	x = Real(I(xTilde));
+	x = I((ScalarFieldTilde&&)xTilde);
+}
+//Index into half-reduced G-space of the point with full G-space index i (returns true if this is stored as the conjugate of the negative point):
+inline bool halfIndex(int i, const vector3<int>& S, int& iHalf)
+{	int i2 = i % S[2], i01 = i / S[2];
+	if(2*i2 <= S[2])
+	{	iHalf = i2 + (S[2]/2+1)*i01;
+		return false;
+	}
+	int i1 = i01 % S[1], i0 = i01 / S[1];
+	iHalf = (S[2]-i2) + (S[2]/2+1)*((S[1]-i1)%S[1] + S[1]*((S[0]-i0)%S[0]));
+	return true;
+}
+//Symmetrize orbits realOrbits[iStart] to realOrbits[iStop-1] of a real scalar field in half-reduced G-space
+//(each orbit also sets the points of its negative orbit, which is excluded from realOrbits):
+void symmetrizeReal_sub(size_t iStart, size_t iStop, vector3<int> S, int nSym, const int* realOrbits,
+	const int* orbitStart, const int* orbitIndex, const complex* orbitPhase, complex* x)
+{	double nSymSqInv = 1./(nSym*nSym);
+	for(size_t j=iStart; j<iStop; j++)
+	{	int o = realOrbits[j];
+		int eStart = orbitStart[o], eStop = orbitStart[o+1];
+		complex xSum = 0.;
+		for(int e=eStart; e<eStop; e++)
+		{	int iHalf; bool conj = halfIndex(orbitIndex[e], S, iHalf);
+			xSum += (conj ? x[iHalf].conj() : x[iHalf]) * orbitPhase[e];
+		}
+		xSum *= (eStop-eStart) * nSymSqInv; //average over orbit (with multiplicity nSym/orbitSize accounted for in orbitPhase)
+		for(int e=eStart; e<eStop; e++)
+		{	int iHalf; bool conj = halfIndex(orbitIndex[e], S, iHalf);
+			complex xCur = xSum * orbitPhase[e].conj();
+			x[iHalf] = conj ? xCur.conj() : xCur;
+		}
+	}
 }
 void Symmetries::symmetrize(ScalarFieldTilde& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
+	#ifdef GPU_ENABLED
 	complexScalarFieldTilde xComplex = Complex(x);
 	symmetrize(xComplex);
 	x = Real(xComplex);
+	#else
+	threadLaunch((orbitIndex.nData()<20000) ? 1 : 0, //force single threaded for small problem sizes
+		symmetrizeReal_sub, realOrbits.size(), e->gInfo.S, sym.size(), realOrbits.data(),
+		orbitStart.data(), orbitIndex.data(), orbitPhase.data(), x->data());
+	#endif
 }
 void Symmetries::symmetrize(complexScalarFieldTilde& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
-	int nSymmClasses = symmIndex.nData() / sym.size(); //number of equivalence classes
-	callPref(eblas_symmetrize)(nSymmClasses, sym.size(), symmIndex.dataPref(), symmMult.dataPref(), symmIndexPhase.dataPref(), x->dataPref());
+	int nOrbits = orbitStart.nData() - 1;
+	callPref(eblas_symmetrize)(nOrbits, sym.size(), orbitStart.dataPref(), orbitIndex.dataPref(), orbitPhase.dataPref(), x->dataPref());
 }
 
 //Symmetrize forces:
@@ -435,55 +497,98 @@ std::vector<SpaceGroupOp> Symmetries::findSpaceGroup(const std::vector< matrix3<
 	return spaceGroup;
 }
 
-void Symmetries::initSymmIndex()
+//Find the smallest full G-space index in the orbit of each point in the mesh:
+void initOrbits_rep_sub(size_t iStart, size_t iStop, const GridInfo* gInfo, const std::vector<SpaceGroupOp>* sym, int* rep)
+{	const vector3<int>& S = gInfo->S;
+	THREAD_fullGspaceLoop
+	(	int iMin = i;
+		for(const SpaceGroupOp& op: *sym)
+		{	vector3<int> iG2 = iG * op.rot;
+			for(int k=0; k<3; k++) iG2[k] = positiveRemainder(iG2[k], S[k]);
+			iMin = std::min(iMin, gInfo->fullRindex(iG2));
+		}
+		rep[i] = iMin;
+	)
+}
+
+//Accumulate the net phase factor of each point in orbits iStart to iStop-1, and check closure (valid[o] = false otherwise):
+void initOrbits_phase_sub(size_t iStart, size_t iStop, const GridInfo* gInfo, const std::vector<SpaceGroupOp>* sym,
+	const int* orbitStart, const int* orbitIndex, complex* orbitPhase, bool* valid)
+{	const vector3<int>& S = gInfo->S;
+	for(size_t o=iStart; o<iStop; o++)
+	{	int eStart = orbitStart[o], eStop = orbitStart[o+1];
+		//G-vector of the first point (in centered coordinates):
+		int i = orbitIndex[eStart];
+		vector3<int> iG( i / (S[2]*S[1]), (i/S[2]) % S[1], i % S[2] );
+		for(int k=0; k<3; k++) if(2*iG[k]>S[k]) iG[k]-=S[k];
+		//Loop over symmetry operations:
+		for(int e=eStart; e<eStop; e++) orbitPhase[e] = 0.;
+		valid[o] = (sym->size() % (eStop-eStart) == 0); //multiplicity must be integral
+		for(const SpaceGroupOp& op: *sym)
+		{	vector3<int> iG2 = iG * op.rot;
+			for(int k=0; k<3; k++) iG2[k] = positiveRemainder(iG2[k], S[k]);
+			int i2 = gInfo->fullRindex(iG2);
+			const int* ePtr = std::lower_bound(orbitIndex+eStart, orbitIndex+eStop, i2);
+			if(ePtr==orbitIndex+eStop || *ePtr!=i2) { valid[o] = false; break; } //image not in orbit
+			orbitPhase[ePtr-orbitIndex] += cis((-2*M_PI)*dot(iG,op.a));
+		}
+	}
+}
+
+void Symmetries::initOrbits()
 {	const GridInfo& gInfo = e->gInfo;
 	if(sym.size()==1) return;
-
-	std::vector<int> symmIndexVec, symmMultVec;
-	std::vector<complex> symmIndexPhaseVec;
-	symmIndexVec.reserve(gInfo.nr);
-	symmMultVec.reserve(gInfo.nr / sym.size());
-	symmIndexPhaseVec.reserve(gInfo.nr);
-	std::vector<bool> done(gInfo.nr, false); //use full G-space for symmetrization
-	//Loop over all points not already handled as an image of a previous one:
-	{	const vector3<int>& S = gInfo.S;
-		size_t iStart = 0, iStop = gInfo.nr;
-		THREAD_fullGspaceLoop
-		(	if(!done[i])
-			{	std::set<int> orbit;
-				//Loop over symmetry matrices:
-				for(const SpaceGroupOp& op: sym)
-				{	vector3<int> iG2 = iG * op.rot;
-					complex phase = cis((-2*M_PI)*dot(iG,op.a));
-					//project back into range:
-					for(int k=0; k<3; k++)
-					{	iG2[k] = positiveRemainder(iG2[k], S[k]);
-						if(2*iG2[k]>S[k]) iG2[k]-=S[k];
-					}
-					int i2 = gInfo.fullGindex(iG2);
-					symmIndexPhaseVec.push_back(phase);
-					symmIndexVec.push_back(i2);
-					done[i2] = true;
-					orbit.insert(i2);
-				}
-				int multiplicity = sym.size()/orbit.size(); //number of times each point in orbit is covered
-				if(multiplicity * orbit.size() != sym.size())
-				{	die("\nSymmetry operations do not seem to form a group.\n"
-						"This is most likely because the geometry has some border-line symmetries.\n"
-						"Try either tightening or loosening the symmetry-threshold parameter.\n\n");
-				}
-				symmMultVec.push_back(multiplicity);
-			}
-		)
+	
+	//Identify orbits by their smallest member:
+	std::vector<int> orbitOf(gInfo.nr);
+	threadLaunch(initOrbits_rep_sub, gInfo.nr, &gInfo, &sym, orbitOf.data());
+	//--- number orbits in order of their smallest member, and count their sizes:
+	std::vector<int> orbitStartVec(1, 0);
+	for(int i=0; i<gInfo.nr; i++)
+	{	int r = orbitOf[i];
+		if(r == i)
+		{	orbitOf[i] = orbitStartVec.size()-1;
+			orbitStartVec.push_back(0);
+		}
+		else orbitOf[i] = orbitOf[r]; //smallest member r < i has already been numbered
+		orbitStartVec[orbitOf[i]+1]++;
+	}
+	int nOrbits = orbitStartVec.size()-1;
+	for(int o=0; o<nOrbits; o++)
+		orbitStartVec[o+1] += orbitStartVec[o];
+	orbitStart.init(nOrbits+1);
+	memcpy(orbitStart.data(), orbitStartVec.data(), (nOrbits+1)*sizeof(int));
+	//--- list members of each orbit in ascending order:
+	orbitIndex.init(gInfo.nr);
+	{	int* orbitIndexData = orbitIndex.data();
+		std::vector<int>& orbitNext = orbitStartVec; //reuse as running position within each orbit
+		for(int i=0; i<gInfo.nr; i++)
+			orbitIndexData[orbitNext[orbitOf[i]]++] = i;
+	}
+	
+	//Net phase factors (and check that the symmetry operations form a group):
+	orbitPhase.init(gInfo.nr);
+	std::unique_ptr<bool[]> valid(new bool[nOrbits]); //(not std::vector<bool>, which is unsafe for concurrent writes to neighbouring entries)
+	threadLaunch(initOrbits_phase_sub, nOrbits, &gInfo, &sym, orbitStart.data(), orbitIndex.data(), orbitPhase.data(), valid.get());
+	for(int o=0; o<nOrbits; o++)
+		if(!valid[o])
+		{	die("\nSymmetry operations do not seem to form a group.\n"
+				"This is most likely because the geometry has some border-line symmetries.\n"
+				"Try either tightening or loosening the symmetry-threshold parameter.\n\n");
+		}
+	
+	#ifndef GPU_ENABLED
+	//Select one of each +/- pair of orbits for real scalar fields:
+	const vector3<int>& S = gInfo.S;
+	realOrbits.clear();
+	for(int o=0; o<nOrbits; o++)
+	{	int i = orbitIndex.data()[orbitStart.data()[o]];
+		vector3<int> iGneg( i / (S[2]*S[1]), (i/S[2]) % S[1], i % S[2] );
+		for(int k=0; k<3; k++) iGneg[k] = (S[k] - iGneg[k]) % S[k];
+		if(o <= orbitOf[gInfo.fullRindex(iGneg)])
+			realOrbits.push_back(o);
 	}
-	//Set the final pointers:
-	int nSymmIndex = symmIndexVec.size();
-	symmIndex.init(nSymmIndex);
-	symmMult.init(symmMultVec.size());
-	symmIndexPhase.init(nSymmIndex);
-	memcpy(symmIndex.data(), &symmIndexVec[0], nSymmIndex*sizeof(int));
-	memcpy(symmMult.data(), &symmMultVec[0], symmMultVec.size()*sizeof(int));
-	memcpy(symmIndexPhase.data(), &symmIndexPhaseVec[0], nSymmIndex*sizeof(complex));
+	#endif
 }
 
 void Symmetries::sortSymmetries()
@@ -47,7 +47,7 @@ public:
 	std::vector<QuantumNumber> reduceKmesh(const std::vector<QuantumNumber>& qnums) const;
 	
 	void symmetrize(ScalarField&) const; //!< symmetrize a scalar field
-	void symmetrize(ScalarFieldTilde&) const; //!< symmetrize a scalar field
+	void symmetrize(ScalarFieldTilde&) const; //!< symmetrize a scalar field directly in reciprocal space (avoids Fourier transforms when already available)
 	void symmetrize(complexScalarFieldTilde&) const; //!< symmetrize a scalar field
 	void symmetrize(struct IonicGradient&) const; //!< symmetrize forces
 	void symmetrizeSpherical(matrix&, const class SpeciesInfo* specie) const; //!< symmetrize matrices in Ylm basis per atom of species sp (accounting for atom maps)
@@ -82,11 +82,12 @@ private:
 	void checkFFTbox(); //!< verify that the sampled mesh is commensurate with symmetries
 	void checkSymmetries(); //!< check validity of manually specified symmetry matrices
 	
-	//Index map for scalar field (electron density, potential) symmetrization in reciprocal space
-	IndexArray symmIndex; //negative index corresponds to real-symmetry-folded part of G-space (which will be complex conjugated)
-	ManagedArray<complex> symmIndexPhase; //phase factor for entry at each index
-	IndexArray symmMult; //multiplicity (how many times each element is repeated) in each equivalence class
-	void initSymmIndex();
+	//Orbits (equivalence classes) of G-vectors for scalar field (electron density, potential) symmetrization in reciprocal space
+	IndexArray orbitStart; //entries of orbit o are [orbitStart[o],orbitStart[o+1]) in the arrays below
+	IndexArray orbitIndex; //full G-space index of each distinct point in each orbit (in ascending order within each orbit)
+	ManagedArray<complex> orbitPhase; //net phase factor of each entry (summed over symmetry operations that map to it)
+	std::vector<int> realOrbits; //one of each +/- pair of orbits, for symmetrizing real scalar fields in half-reduced G-space (CPU only)
+	void initOrbits();
 	
 	//Atom maps:
 	std::vector<std::vector<std::vector<int> > > atomMap;
@@ -22,10 +22,13 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/SpeciesInfo_internal.h>
 #include <core/VectorField.h>
 #include <core/Units.h>
+#include <core/Thread.h>
+#include <mutex>
 
 const static int atomicNumberMaxGrimme = 54;
 const static int atomicNumberMax = 118;
 const int VanDerWaals::unitParticle;
+const double VanDerWaals::rCut = 100.; //Truncate summation at 1/r^6 < 10^-12
 
 //vdW correction energy upto a factor of -s6 (where s6 is the ExCorr dependnet scale)
 //for a pair of atoms separated by r, given the C6 and R0 parameters for pair.
@@ -52,7 +55,7 @@ inline double vdwPairEnergyAndGrad(double r, double C6, double R0, double& E_r)
 	return C6invr6 * fdamp;
 }
 
-VanDerWaals::VanDerWaals(const Everything& everything)
+VanDerWaals::VanDerWaals(const Everything& everything) : neighborList(rCut, 2.)
 {
 	logPrintf("\nInitializing van der Waals corrections\n");
 	e = &everything;
@@ -134,35 +137,56 @@ VanDerWaals::VanDerWaals(const Everything& everything)
 	}
 }
 
-double VanDerWaals::energyAndGrad(std::vector<Atom>& atoms, const double scaleFac) const
+//Energy, forces and strain derivative from the pairs in nl listed under atoms iStart to iStop-1
+void VanDerWaals_energyAndGrad_sub(size_t iStart, size_t iStop, const NeighborList* nl, const matrix3<>* RTR,
+	const double* sqrtC6, const double* R0, double scaleFac, double rCut, double* Etot, vector3<>* forces, matrix3<>* E_strain, std::mutex* m)
+{	double E = 0.;
+	std::vector< vector3<> > F(nl->nAtoms());
+	matrix3<> Es;
+	double rCutSq = rCut*rCut;
+	for(size_t i=iStart; i<iStop; i++)
+		for(const NeighborList::Neighbor& n: (*nl)[i])
+		{	vector3<> x = nl->separation(i, n);
+			double rSq = RTR->metric_length_squared(x);
+			if(rSq > rCutSq) continue; //within the neighbour list skin
+			double r = sqrt(rSq);
+			double E_r; E -= scaleFac * vdwPairEnergyAndGrad(r, sqrtC6[i]*sqrtC6[n.j], R0[i]+R0[n.j], E_r);
+			vector3<> E_x = (-scaleFac*E_r/r) * ((*RTR) * x); //derivative w.r.t separation in lattice coordinates
+			F[i] -= E_x;
+			F[n.j] += E_x;
+			if(E_strain) Es += outer(E_x, x);
+		}
+	//Accumulate:
+	m->lock();
+	*Etot += E;
+	for(size_t i=0; i<F.size(); i++) forces[i] += F[i];
+	if(E_strain) *E_strain += Es;
+	m->unlock();
+}
+
+double VanDerWaals::energyAndGrad(std::vector<Atom>& atoms, const double scaleFac, matrix3<>* E_strain) const
 {
-	//Truncate summation at 1/r^6 < 10^-16 => r ~ 100 bohrs
-	vector3<bool> isTruncated = e->coulombParams.isTruncated();
-	vector3<int> n;
-	for(int k=0; k<3; k++)
-		n[k] = isTruncated[k] ? 0 : (int)ceil(200. / e->gInfo.R.column(k).length());
+	//Update neighbour list:
+	std::vector< vector3<> > pos(atoms.size());
+	for(size_t i=0; i<atoms.size(); i++) pos[i] = atoms[i].pos;
+	neighborList.update(e->gInfo.R, pos, e->coulombParams.isTruncated());
 	
-	double Etot = 0.;  //Total VDW Energy
-	for(int c1=0; c1<int(atoms.size()); c1++)
-	{	const AtomParams& c1params = getParams(atoms[c1].atomicNumber, atoms[c1].sp);
-		for(int c2=0; c2<int(atoms.size()); c2++)
-		{	const AtomParams& c2params = getParams(atoms[c2].atomicNumber, atoms[c2].sp);
-			double C6 = sqrt(c1params.C6 * c2params.C6);
-			double R0 = c1params.R0 + c2params.R0;
-			vector3<int> iR;
-			for(iR[0] = -n[0]; iR[0]<=n[0]; iR[0]++)
-			for(iR[1] = -n[1]; iR[1]<=n[1]; iR[1]++)
-			for(iR[2] = -n[2]; iR[2]<=n[2]; iR[2]++)
-			{	vector3<> x = iR + (atoms[c1].pos - atoms[c2].pos);
-				double rSq = e->gInfo.RTR.metric_length_squared(x);
-				if(!rSq) continue; //exclude self-interaction
-				double r = sqrt(rSq);
-				double E_r, E = vdwPairEnergyAndGrad(r, C6, R0, E_r);
-				Etot -= 0.5 * scaleFac * E;
-				atoms[c1].force += scaleFac * E_r * (e->gInfo.RTR * x)/r;
-			}
-		}
+	//Per-atom parameters (combined for each pair as C6 = sqrt(C6_1 C6_2) and R0 = R0_1 + R0_2):
+	std::vector<double> sqrtC6(atoms.size()), R0(atoms.size());
+	for(size_t i=0; i<atoms.size(); i++)
+	{	const AtomParams& params = getParams(atoms[i].atomicNumber, atoms[i].sp);
+		sqrtC6[i] = sqrt(params.C6);
+		R0[i] = params.R0;
 	}
+	
+	//Sum over pairs:
+	double Etot = 0.;  //Total VDW Energy
+	std::vector< vector3<> > forces(atoms.size());
+	std::mutex m;
+	threadLaunch(VanDerWaals_energyAndGrad_sub, atoms.size(), &neighborList, &(e->gInfo.RTR),
+		sqrtC6.data(), R0.data(), scaleFac, rCut, &Etot, forces.data(), E_strain, &m);
+	for(size_t i=0; i<atoms.size(); i++)
+		atoms[i].force += forces[i];
 	return Etot;
 }
 
@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/RadialFunction.h>
 #include <core/ScalarFieldArray.h>
 #include <core/Coulomb.h>
+#include <core/NeighborList.h>
 
 //! @addtogroup LongRange
 //! @{
@@ -37,8 +38,11 @@ public:
 	const static int unitParticle = -1; //!< special atomic number used by some fluids: point particle with C6=1 J-nm^6/mol and R0=0
 	
 	//! Van der Waal correction energy for a collection of discrete atoms at fixed locations
-	//! Corresponding forces are accumulated to Atom::force for each atom
-	double energyAndGrad(std::vector<Atom>& atoms, const double scaleFac) const;
+	//! Corresponding forces are accumulated to Atom::force for each atom, and the derivative
+	//! with respect to lattice strain (R -> R(1+strain)) is accumulated to E_strain, if non-null.
+	//! Pairs are summed within rCut (where C6/r^6 < 10^-12, so no tail correction is needed)
+	//! using a neighbour list that is reused between calls when possible.
+	double energyAndGrad(std::vector<Atom>& atoms, const double scaleFac, matrix3<>* E_strain=0) const;
 	
 	//! Van der Waal correction to the interaction energy between the explicit atoms
 	//! (from IonInfo) and the continuous fields Ntilde with specified atomic numbers.
@@ -74,6 +78,9 @@ private:
 	const RadialFunctionG& getRadialFunction(int Z1, int Z2, int sp1, int sp2) const;
 	
 	std::map<std::pair<int,int>,RadialFunctionG> radialFunctions;
+	
+	static const double rCut; //!< cutoff radius for pair interactions between discrete atoms
+	mutable NeighborList neighborList; //!< neighbour list for pair interactions between discrete atoms (reused between ionic steps)
 };
 
 //! @}
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/Fex_H2O_FittedCorrelations.h>
 #include <core/Units.h>
 #include <core/Operators.h>
+#include <core/SimdMath.h>
 
 inline double COO_calc(double G)
 {	static const double COO_A[6] = {-0.0271153, -0.0795576, 0.096648, -0.0291517, 0.0227052, -0.0109078};
@@ -77,6 +78,15 @@ Fex_H2O_FittedCorrelations::~Fex_H2O_FittedCorrelations()
 	fex_gauss.free();
 }
 
+__simd_dispatch__ void Fex_H20_FittedCorrelations_sub(size_t iStart, size_t iStop, const double* NObar, const double* NHbar,
+	double* Fex, double* Phi_NObar, double* Phi_NHbar)
+{	for(size_t i=iStart; i<iStop; i++)
+		Fex[i] = Fex_H2O_FittedCorrelations_calc(i, NObar, NHbar, Phi_NObar, Phi_NHbar);
+}
+void Fex_H20_FittedCorrelations(int nr, const double* NObar, const double* NHbar,
+	double* Fex, double* Phi_NObar, double* Phi_NHbar)
+{	threadLaunch(Fex_H20_FittedCorrelations_sub, nr, NObar, NHbar, Fex, Phi_NObar, Phi_NHbar);
+}
 #ifdef GPU_ENABLED
 void Fex_H20_FittedCorrelations_gpu(int nr, const double* NObar, const double* NHbar,
 	double* Fex, double* Phi_NObar, double* Phi_NHbar);
@@ -92,15 +102,10 @@ double Fex_H2O_FittedCorrelations::compute(const ScalarFieldTilde* Ntilde, Scala
 	ScalarField NObar = I(fex_gauss*Ntilde[0]), Phi_NObar; nullToZero(Phi_NObar, gInfo);
 	ScalarField NHbar = I(fex_gauss*Ntilde[1]), Phi_NHbar; nullToZero(Phi_NHbar, gInfo);
 	//Evaluated weighted density functional:
-	#ifdef GPU_ENABLED
 	ScalarField fex(ScalarFieldData::alloc(gInfo,isGpuEnabled()));
-	Fex_H20_FittedCorrelations_gpu(gInfo.nr, NObar->dataGpu(), NHbar->dataGpu(),
-		 fex->dataGpu(), Phi_NObar->dataGpu(), Phi_NHbar->dataGpu());
+	callPref(Fex_H20_FittedCorrelations)(gInfo.nr, NObar->dataPref(), NHbar->dataPref(),
+		 fex->dataPref(), Phi_NObar->dataPref(), Phi_NHbar->dataPref());
 	PhiEx += integral(fex);
-	#else
-	PhiEx += gInfo.dV*threadedAccumulate(Fex_H2O_FittedCorrelations_calc, gInfo.nr,
-		 NObar->data(), NHbar->data(), Phi_NObar->data(), Phi_NHbar->data());
-	#endif
 	//Convert gradients:
 	Phi_Ntilde[0] += fex_gauss*Idag(Phi_NObar);
 	Phi_Ntilde[1] += fex_gauss*Idag(Phi_NHbar);
@@ -45,7 +45,7 @@ namespace Fex_H2O_FittedCorrelations_internal
 }
 //Compute the gaussian weighted density energy and gradients
 __hostanddev__
-double Fex_H2O_FittedCorrelations_calc(int i, const double* NObar, const double* NHbar, double* Phi_NObar, double* Phi_NHbar)
+double Fex_H2O_FittedCorrelations_calc(size_t i, const double* NObar, const double* NHbar, double* Phi_NObar, double* Phi_NHbar)
 {	using namespace Fex_H2O_FittedCorrelations_internal;
 	double Nmean = (1.0/3)*(NObar[i] + NHbar[i]);
 	double fDotMean = fexDot(Nmean);
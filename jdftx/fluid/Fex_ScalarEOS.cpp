@@ -91,7 +91,7 @@ double JeffereyAustinEOS::vdwRadius() const
 {	return eval->vdwRadius();
 }
 
-void evalJeffereyAustinEOS_sub(size_t iStart, size_t iStop, const double* N, double* Aex, double* Aex_N, double Vhs, const JeffereyAustinEOS_eval& eval)
+__simd_dispatch__ void evalJeffereyAustinEOS_sub(size_t iStart, size_t iStop, const double* N, double* Aex, double* Aex_N, double Vhs, const JeffereyAustinEOS_eval eval)
 {	for(size_t i=iStart; i<iStop; i++) eval(i, N, Aex, Aex_N, Vhs);
 }
 void JeffereyAustinEOS::evaluate(size_t nData, const double* N, double* Aex, double* Aex_N, double Vhs) const
@@ -115,7 +115,7 @@ double TaoMasonEOS::vdwRadius() const
 {	return eval->vdwRadius();
 }
 
-void evalTaoMasonEOS_sub(size_t iStart, size_t iStop, const double* N, double* Aex, double* Aex_N, double Vhs, const TaoMasonEOS_eval& eval)
+__simd_dispatch__ void evalTaoMasonEOS_sub(size_t iStart, size_t iStop, const double* N, double* Aex, double* Aex_N, double Vhs, const TaoMasonEOS_eval eval)
 {	for(size_t i=iStart; i<iStop; i++) eval(i, N, Aex, Aex_N, Vhs);
 }
 void TaoMasonEOS::evaluate(size_t nData, const double* N, double* Aex, double* Aex_N, double Vhs) const
@@ -21,11 +21,12 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_FLUID_FEX_SCALAREOS_INTERNAL_H
 
 #include <core/Units.h>
-#include <core/scalar.h>
+#include <core/SimdMath.h>
 
 //! @addtogroup ClassicalDFT
 //! @{
 //! @file Fex_ScalarEOS_internal.h Equation of state evaluators for ScalarEOS functional
+//! The pointwise evaluators are branch-free and use the simd_* functions so that the CPU loops vectorize
 
 //! Base class for equation of state evaluators
 struct ScalarEOS_eval
@@ -36,10 +37,10 @@ struct ScalarEOS_eval
 	}
 	
 	__hostanddev__ double getAhs(double N, double& Ahs_N, double Vhs) const
-	{	double n3 = Vhs*N; if(n3 >= 1.) { Ahs_N = NAN; return NAN; }
+	{	double n3 = Vhs*N; bool valid = (n3 < 1.);
 		double den = 1./(1-n3);
-		Ahs_N = T*Vhs * (den*den*den)*2*(2-n3);
-		return T * (den*den)*n3*(4-3*n3); //corresponds to Carnahan-Starling EOS
+		Ahs_N = valid ? T*Vhs * (den*den*den)*2*(2-n3) : NAN;
+		return valid ? T * (den*den)*n3*(4-3*n3) : NAN; //corresponds to Carnahan-Starling EOS
 	}
 };
 
@@ -92,38 +93,37 @@ struct JeffereyAustinEOS_eval : public ScalarEOS_eval
 		const double d0 = 1.917;
 		const double d1 = 26.01;
 		const double beta = 3.24;
-		double x = n/nc, xPowBetaM1 = pow(x, beta-1.), xPow57 = pow(x,5.7);
+		double x = n/nc, xPowBetaM1 = simd_pow(x, beta-1.), xPow57 = simd_pow(x,5.7);
 		double den = 1./(d0*(1 + d0*x*(1 + d0*x)) + x*d1*xPowBetaM1);
 		double den_x = -den*den*(d0*d0*(1 + d0*x*2) + beta*d1*xPowBetaM1);
-		double expTerm = exp(-A4*xPow57*x);
+		double expTerm = simd_exp(-A4*xPow57*x);
 		VPphiInt_n = expTerm*(A4*xPow57*6.7*den-den_x);
 		return -nc*expTerm*den;
 	}
 	
 	//Compute the per-particle free energies at each grid point, and the gradient w.r.t the weighted density
-	__hostanddev__ void operator()(int i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
-	{
-		if(Nbar[i]<0.)
-		{	Aex[i] = 0.;
-			Aex_Nbar[i] = 0.;
-			return;
-		}
+	__hostanddev__ void operator()(size_t i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
+	{	double N = Nbar[i];
 		//HB part:
-		double gaussHB = exp(pow((Nbar[i]-nHB)/dnHB,2));
+		double dNHB = (N-nHB)/dnHB;
+		double gaussHB = simd_exp(dNHB*dNHB);
 		double fHBden = C1 + gaussHB;
-		double fHBdenPrime = gaussHB * 2*(Nbar[i]-nHB)/pow(dnHB,2);
+		double fHBdenPrime = gaussHB * 2*dNHB/dnHB;
 		double AHB = prefacHB / fHBden;
 		double AHB_Nbar = -AHB * fHBdenPrime/fHBden;
 		//VW part:
-		double Ginv = 1 - lambda*b*Nbar[i]; if(Ginv<=0.0) { Aex_Nbar[i] = NAN; Aex[i]=NAN; return; }
-		double VPphiInt_Nbar, VPphiInt = getVPphiInt(Nbar[i], VPphiInt_Nbar);
-		double AVW = prefacVW1*log(Ginv) + (VPzi*VPphiInt -  Nbar[i])*prefacVW2;
+		double Ginv = 1 - lambda*b*N;
+		double VPphiInt_Nbar, VPphiInt = getVPphiInt(N, VPphiInt_Nbar);
+		double AVW = prefacVW1*simd_log(Ginv) + (VPzi*VPphiInt - N)*prefacVW2;
 		double AVW_Nbar = T*alpha/Ginv + (VPzi*VPphiInt_Nbar - 1.) * prefacVW2;
 		//FMT part:
-		double AFMT_Nbar, AFMT = getAhs(Nbar[i], AFMT_Nbar, Vhs);
-		//Total
-		Aex_Nbar[i] = AHB_Nbar + AVW_Nbar - AFMT_Nbar;
-		Aex[i] = AHB + AVW - AFMT;
+		double AFMT_Nbar, AFMT = getAhs(N, AFMT_Nbar, Vhs);
+		//Total (zero for negative densities, and NAN beyond the pole in the VW part):
+		double AexTot = AHB + AVW - AFMT, AexTot_Nbar = AHB_Nbar + AVW_Nbar - AFMT_Nbar;
+		AexTot = Ginv<=0. ? NAN : AexTot;
+		AexTot_Nbar = Ginv<=0. ? NAN : AexTot_Nbar;
+		Aex_Nbar[i] = N<0. ? 0. : AexTot_Nbar;
+		Aex[i] = N<0. ? 0. : AexTot;
 	}
 };
 
@@ -156,27 +156,25 @@ struct TaoMasonEOS_eval : public ScalarEOS_eval
 	}
 	
 	//Compute the per-particle free energies at each grid point, and the gradient w.r.t the weighted density
-	__hostanddev__ void operator()(int i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
-	{
-		if(Nbar[i]<0.)
-		{	Aex[i] = 0.;
-			Aex_Nbar[i] = 0.;
-			return;
-		}
+	__hostanddev__ void operator()(size_t i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
+	{	double N = Nbar[i];
 		//VW part:
-		double Ginv = 1 - lambda*b*Nbar[i]; if(Ginv<=0.0) { Aex_Nbar[i] = NAN; Aex[i]=NAN; return; }
-		double AVW = Nbar[i]*prefacQuad + prefacPole*(-log(Ginv));
+		double Ginv = 1 - lambda*b*N;
+		double AVW = N*prefacQuad + prefacPole*(-simd_log(Ginv));
 		double AVW_Nbar = prefacQuad + prefacPole*(lambda*b/Ginv);
 		//Vapor pressure correction:
 		double b2term = sqrt(1.8)*b*b;
-		double bn2term = b2term*Nbar[i]*Nbar[i];
-		double Avap = prefacVap * atan(bn2term);
-		double Avap_Nbar = prefacVap * b2term*Nbar[i]*2. / (1 + bn2term*bn2term);
+		double bn2term = b2term*N*N;
+		double Avap = prefacVap * simd_atan(bn2term);
+		double Avap_Nbar = prefacVap * b2term*N*2. / (1 + bn2term*bn2term);
 		//FMT part:
-		double AFMT_Nbar, AFMT = getAhs(Nbar[i], AFMT_Nbar, Vhs);
-		//Total
-		Aex_Nbar[i] = AVW_Nbar + Avap_Nbar - AFMT_Nbar;
-		Aex[i] = AVW + Avap - AFMT;
+		double AFMT_Nbar, AFMT = getAhs(N, AFMT_Nbar, Vhs);
+		//Total (zero for negative densities, and NAN beyond the pole in the VW part):
+		double AexTot = AVW + Avap - AFMT, AexTot_Nbar = AVW_Nbar + Avap_Nbar - AFMT_Nbar;
+		AexTot = Ginv<=0. ? NAN : AexTot;
+		AexTot_Nbar = Ginv<=0. ? NAN : AexTot_Nbar;
+		Aex_Nbar[i] = N<0. ? 0. : AexTot_Nbar;
+		Aex[i] = N<0. ? 0. : AexTot;
 	}
 };
 
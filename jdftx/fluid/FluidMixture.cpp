@@ -19,6 +19,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fluid/FluidMixture.h>
 #include <fluid/IdealGas.h>
+#include <core/Pulay.h>
+#include <core/ScalarFieldIO.h>
 #include <gsl/gsl_multiroots.h>
 
 extern string rigidMoleculeCDFT_ScalarEOSpaper;
@@ -271,6 +273,73 @@ double FluidMixture::sync(double x) const
 	return x;
 }
 
+//Pulay mixing of the fixed-point iteration state -> state - K grad, where K is the (bulk-response) preconditioner of compute()
+class FluidMixtureSCF : public Pulay<ScalarFieldArray>
+{	FluidMixture& fm;
+	double mixFraction;
+	double residualMin; int nStalled; //lowest residual so far and number of consecutive cycles exceeding it
+	ScalarFieldArray cycleState; //state at the start of the latest cycle (whose residual is passed to stalled())
+public:
+	ScalarFieldArray bestState; //!< state with the lowest residual so far (initial state to begin with)
+	bool isStalled; //!< whether minimize() ended due to the residual not decreasing
+	
+	FluidMixtureSCF(FluidMixture& fm, const PulayParams& pp)
+	: Pulay<ScalarFieldArray>(pp), fm(fm), mixFraction(pp.mixFraction), residualMin(DBL_MAX), nStalled(0), bestState(clone(fm.state)), isStalled(false)
+	{
+	}
+	
+	double sync(double x) const { return fm.sync(x); }
+	
+protected:
+	double cycle(double dEprev, std::vector<double>& extraValues)
+	{	ScalarFieldArray Kgrad;
+		double E = fm.compute(0, &Kgrad);
+		cycleState = fm.state; //keep the state that produced this energy and residual
+		fm.state = cycleState - Kgrad;
+		return E;
+	}
+	
+	bool stalled(double residualNorm)
+	{	if(residualNorm < residualMin)
+		{	residualMin = residualNorm;
+			bestState = cycleState; //state before the step (not modified in place subsequently)
+			nStalled = 0;
+		}
+		else nStalled++;
+		isStalled = (nStalled >= 2); //residual above minimum for 2 consecutive cycles
+		return isStalled;
+	}
+	
+	void axpy(double alpha, const ScalarFieldArray& X, ScalarFieldArray& Y) const
+	{	if(!Y.size()) Y.resize(X.size());
+		::axpy(alpha, X, Y);
+	}
+	double dot(const ScalarFieldArray& X, const ScalarFieldArray& Y) const { return ::dot(X, Y); }
+	size_t variableSize() const { return fm.get_nIndep() * fm.gInfo.nr * sizeof(double); }
+	void readVariable(ScalarFieldArray& X, FILE* fp) const
+	{	nullToZero(X, fm.gInfo, fm.get_nIndep());
+		for(ScalarField& x: X) loadRawBinary(x, fp);
+	}
+	void writeVariable(const ScalarFieldArray& X, FILE* fp) const
+	{	for(const ScalarField& x: X) saveRawBinary(x, fp);
+	}
+	ScalarFieldArray getVariable() const { return clone(fm.state); }
+	void setVariable(const ScalarFieldArray& X) { fm.state = clone(X); }
+	ScalarFieldArray precondition(const ScalarFieldArray& X) const { return mixFraction * X; } //residual is already preconditioned by K
+	ScalarFieldArray applyMetric(const ScalarFieldArray& X) const { return clone(X); }
+};
+
+double FluidMixture::minimizeSCF(const PulayParams& pp, const MinimizeParams& mpFallback)
+{	if(!state.size()) initState();
+	FluidMixtureSCF scf(*this, pp);
+	double E = scf.minimize(compute(0,0));
+	if(killFlag || !(scf.isStalled || std::isnan(E))) return E;
+	//Fall back to conjugate gradients from the best state encountered:
+	fprintf(pp.fpLog, "%sSwitching to conjugate-gradients minimization.\n\n", pp.linePrefix); fflush(pp.fpLog);
+	state = scf.bestState;
+	return minimize(mpFallback);
+}
+
 double FluidMixture::compute_p(double Ntot) const
 {	std::vector<double> Nmol(component.size()), Phi_Nmol(component.size());
 	double Nguess=0.;
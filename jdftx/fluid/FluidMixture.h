@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/Fmix.h>
 #include <core/Units.h>
 #include <core/Minimize.h>
+#include <core/PulayParams.h>
 #include <core/EnergyComponents.h>
 
 //! @addtogroup ClassicalDFT
@@ -114,6 +115,13 @@ public:
 	
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
 	
+	//! @brief Solve the Euler-Lagrange equations by Pulay (Anderson / DIIS) mixing of preconditioned fixed-point steps,
+	//! falling back to conjugate-gradients minimize() with mpFallback if the residual stops decreasing
+	//! @param pp Pulay mixing parameters
+	//! @param mpFallback Parameters for the fallback minimize()
+	//! @return Free energy at the final state
+	double minimizeSCF(const PulayParams& pp, const MinimizeParams& mpFallback);
+	
 private:
 	unsigned nIndepIdgas; //!< number of scalar fields used as independent variables for the component ideal gases
 	unsigned nDensities; //!< total number of site densities
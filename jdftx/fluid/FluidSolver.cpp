@@ -237,7 +237,8 @@ public:
 
 	void minimizeFluid()
 	{	TIME("Fluid minimize", globalLog,
-			fluidMixture->minimize(e.fluidMinParams);
+			if(fsp.cdftSCF) fluidMixture->minimizeSCF(fsp.scfParams, e.fluidMinParams);
+			else fluidMixture->minimize(e.fluidMinParams);
 			updateCached();
 		)
 	}
@@ -140,9 +140,10 @@ struct FluidSolverParams
 	bool linearScreening; //!< If true, work in the linearized Poisson-Boltzman limit for the ions
 	bool nonlinearSCF; //!< whether to use an SCF method for nonlinear PCMs
 	double screenOverride; //! overrides screening factor with this value
-	PulayParams scfParams; //!< parameters controlling Pulay mixing for SCF version of nonlinear PCM
+	PulayParams scfParams; //!< parameters controlling Pulay mixing for SCF version of nonlinear PCM or classical DFT
 	
 	//For Explicit Fluid JDFT alone:
+	bool cdftSCF; //!< whether to use Pulay mixing (with conjugate-gradients fallback) to converge classical DFT fluids
 	ExCorr exCorr; //!< Fluid exchange-correlation and kinetic energy functional
         std::vector<FmixParams> FmixList; //!< Tabulates which components interact through an additional Fmix
 
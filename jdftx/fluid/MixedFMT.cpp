@@ -62,6 +62,23 @@ ScalarFieldTilde tensorKernel_grad(const TensorFieldTilde& grad_mTilde)
 }
 
 
+__simd_dispatch__ void phiFMT_sub(size_t iStart, size_t iStop, double* phiArr,
+	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
+	vector3<const double*> n1vArr, vector3<const double*> n2vArr, tensor3<const double*> n2mArr,
+	double *grad_n0arr, double *grad_n1arr, double *grad_n2arr, double *grad_n3arr,
+	vector3<double*> grad_n1vArr, vector3<double*> grad_n2vArr, tensor3<double*> grad_n2mArr)
+{	SIMD_IVDEP for(size_t i=iStart; i<iStop; i++)
+		phiArr[i] = phiFMT_calc(i, n0arr, n1arr, n2arr, n3arr, n1vArr, n2vArr, n2mArr,
+			grad_n0arr, grad_n1arr, grad_n2arr, grad_n3arr, grad_n1vArr, grad_n2vArr, grad_n2mArr);
+}
+void phiFMT(int N, double* phiArr,
+	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
+	vector3<const double*> n1vArr, vector3<const double*> n2vArr, tensor3<const double*> n2mArr,
+	double *grad_n0arr, double *grad_n1arr, double *grad_n2arr, double *grad_n3arr,
+	vector3<double*> grad_n1vArr, vector3<double*> grad_n2vArr, tensor3<double*> grad_n2mArr)
+{	threadLaunch(phiFMT_sub, N, phiArr, n0arr, n1arr, n2arr, n3arr, n1vArr, n2vArr, n2mArr,
+		grad_n0arr, grad_n1arr, grad_n2arr, grad_n3arr, grad_n1vArr, grad_n2vArr, grad_n2mArr);
+}
 #ifdef GPU_ENABLED
 void phiFMT_gpu(int N, double* phiArr,
 	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
@@ -86,21 +103,12 @@ double PhiFMT(const ScalarField& n0, const ScalarField& n1, const ScalarField& n
 	nullToZero(grad_n0, gInfo); nullToZero(grad_n1, gInfo); nullToZero(grad_n2, gInfo); nullToZero(grad_n3, gInfo);
 	nullToZero(grad_n1v, gInfo); nullToZero(grad_n2v, gInfo); nullToZero(grad_n2m, gInfo);
 
-	double result;
-	#ifdef GPU_ENABLED
-	{	ScalarField phiArr(ScalarFieldData::alloc(gInfo, true));
-		phiFMT_gpu(gInfo.nr, phiArr->dataGpu(),
-			n0->dataGpu(), n1->dataGpu(), n2->dataGpu(), n3->dataGpu(), n1v.const_dataGpu(), n2v.const_dataGpu(), n2m.const_dataGpu(),
-			grad_n0->dataGpu(), grad_n1->dataGpu(), grad_n2->dataGpu(), grad_n3->dataGpu(),
-			grad_n1v.dataGpu(), grad_n2v.dataGpu(), grad_n2m.dataGpu());
-		result = gInfo.dV * sum(phiArr);
-	}
-	#else
-	result = gInfo.dV*threadedAccumulate(phiFMT_calc, gInfo.nr,
-			n0->data(), n1->data(), n2->data(), n3->data(), n1v.const_data(), n2v.const_data(), n2m.const_data(),
-			grad_n0->data(), grad_n1->data(), grad_n2->data(), grad_n3->data(),
-			grad_n1v.data(), grad_n2v.data(), grad_n2m.data());
-	#endif
+	ScalarField phiArr(ScalarFieldData::alloc(gInfo, isGpuEnabled()));
+	callPref(phiFMT)(gInfo.nr, phiArr->dataPref(),
+		n0->dataPref(), n1->dataPref(), n2->dataPref(), n3->dataPref(), n1v.const_dataPref(), n2v.const_dataPref(), n2m.const_dataPref(),
+		grad_n0->dataPref(), grad_n1->dataPref(), grad_n2->dataPref(), grad_n3->dataPref(),
+		grad_n1v.dataPref(), grad_n2v.dataPref(), grad_n2m.dataPref());
+	double result = gInfo.dV * sum(phiArr);
 	n3=0; n1v=0; n2v=0; n2m=0; //no longer need these weighted densities (clean up)
 
 	grad_n2mTilde += tensorKernel_grad(Idag(grad_n2m)); grad_n2m=0;
@@ -120,6 +128,19 @@ double phiFMTuniform(double n0, double n1, double n2, double n3,
 		&grad_n0, &grad_n1, &grad_n2, &grad_n3, zeroArr, zeroArr, zeroArr);
 }
 
+__simd_dispatch__ void phiBond_sub(size_t iStart, size_t iStop, double Rhm, double scale, double* phiArr,
+	const double *n0arr, const double *n2arr, const double *n3arr, vector3<const double*> n2vArr,
+	double *grad_n0arr, double *grad_n2arr, double *grad_n3arr, vector3<double*> grad_n2vArr)
+{	SIMD_IVDEP for(size_t i=iStart; i<iStop; i++)
+		phiArr[i] = phiBond_calc(i, Rhm, scale,
+			n0arr, n2arr, n3arr, n2vArr, grad_n0arr, grad_n2arr, grad_n3arr, grad_n2vArr);
+}
+void phiBond(int N, double Rhm, double scale, double* phiArr,
+	const double *n0arr, const double *n2arr, const double *n3arr, vector3<const double*> n2vArr,
+	double *grad_n0arr, double *grad_n2arr, double *grad_n3arr, vector3<double*> grad_n2vArr)
+{	threadLaunch(phiBond_sub, N, Rhm, scale, phiArr,
+		n0arr, n2arr, n3arr, n2vArr, grad_n0arr, grad_n2arr, grad_n3arr, grad_n2vArr);
+}
 #ifdef GPU_ENABLED
 void phiBond_gpu(int N, double Rhm, double scale, double* phiArr,
 	const double *n0arr, const double *n2arr, const double *n3arr, vector3<const double*> n2vArr,
@@ -139,17 +160,11 @@ double PhiBond(double Rhm, double scale, const ScalarField& n0mol, const ScalarF
 	nullToZero(grad_n2, gInfo);
 	nullToZero(grad_n3, gInfo);
 	nullToZero(grad_n2v, gInfo);
-	#ifdef GPU_ENABLED
-	ScalarField phiArr(ScalarFieldData::alloc(gInfo, true));
-	phiBond_gpu(gInfo.nr, Rhm, scale, phiArr->dataGpu(),
-		n0mol->dataGpu(), n2->dataGpu(), n3->dataGpu(), n2v.const_dataGpu(),
-		grad_n0mol->dataGpu(), grad_n2->dataGpu(), grad_n3->dataGpu(), grad_n2v.dataGpu());
+	ScalarField phiArr(ScalarFieldData::alloc(gInfo, isGpuEnabled()));
+	callPref(phiBond)(gInfo.nr, Rhm, scale, phiArr->dataPref(),
+		n0mol->dataPref(), n2->dataPref(), n3->dataPref(), n2v.const_dataPref(),
+		grad_n0mol->dataPref(), grad_n2->dataPref(), grad_n3->dataPref(), grad_n2v.dataPref());
 	double result = gInfo.dV * sum(phiArr);
-	#else
-	double result = gInfo.dV * threadedAccumulate(phiBond_calc, gInfo.nr, Rhm, scale,
-			n0mol->data(), n2->data(), n3->data(), n2v.const_data(),
-			grad_n0mol->data(), grad_n2->data(), grad_n3->data(), grad_n2v.data());
-	#endif
 	n3=0; n2v=0; //no longer need these weighted densities (clean up)
 	//Propagate grad_n2v and grad_n3 to grad_n3tilde:
 	grad_n3tilde += ( Idag(grad_n3) + divergence(Idag(grad_n2v)) );
@@ -22,10 +22,12 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/matrix3.h>
 #include <core/tensor3.h>
+#include <core/SimdMath.h>
 
 //! @addtogroup ClassicalDFT
 //! @{
 //! @file MixedFMT_internal.h Implementation of Mixed FMT (internals)
+//! The pointwise free energy kernels are branch-free so that the CPU loops vectorize (see SimdMath.h)
 
 //! Calculate tensor derivative
 __hostanddev__ void tensorKernel_calc(int i, const vector3<int> iG, bool nyq, const matrix3<> G,
@@ -90,30 +92,30 @@ __hostanddev__ void trace_cubed_grad(const double grad_trace, const tensor3<>& m
 
 //! White-Bear mark II FMT scale function f2 (and derivative) [replace with f2(x)=f3(x)=1 for standard Tarazona FMT]:
 __hostanddev__ double WB_f2(double x, double& f2_x)
-{	if(x<0.002)
-	{	f2_x = x*((2./9) + x*(3./18 + x*(4./30)));
-		return 1 + x*x*((1./9) + x*(1./18 + x*(1./30)));
-	}
-	else
-	{	f2_x = (-1./3)*(x*(2+x) + 2*log(1-x)) / (x*x);
-		return 1 + (1./3)*(2-x + 2*(1-x)*log(1-x)/x);
-	}
+{	bool useSeries = (x<0.002);
+	double logTerm = simd_log(1-x);
+	double f2_xSeries = x*((2./9) + x*(3./18 + x*(4./30)));
+	double f2Series = 1 + x*x*((1./9) + x*(1./18 + x*(1./30)));
+	double f2_xExact = (-1./3)*(x*(2+x) + 2*logTerm) / (x*x);
+	double f2Exact = 1 + (1./3)*(2-x + 2*(1-x)*logTerm/x);
+	f2_x = useSeries ? f2_xSeries : f2_xExact;
+	return useSeries ? f2Series : f2Exact;
 }
 
 //! White-Bear mark II FMT scale function f3 (and derivative) [replace with f2(x)=f3(x)=1 for standard Tarazona FMT]:
 __hostanddev__ double WB_f3(double x, double& f3_x)
-{	if(x<0.005)
-	{	f3_x = -4./9 + x*(2./18 + x*(3./45 + x*(4./90)));
-		return 1 + x*(-4./9 + x*(1./18 + x*(1./45 + x*(1./90))));
-	}
-	else
-	{	f3_x = 2*(1-x) * (x*(2+x) + 2*log(1-x)) / (3*x*x*x);
-		return 1 - (x*(2+x*(-3+x*2)) + 2*(1-x)*(1-x)*log(1-x)) / (3*x*x);
-	}
+{	bool useSeries = (x<0.005);
+	double logTerm = simd_log(1-x);
+	double f3_xSeries = -4./9 + x*(2./18 + x*(3./45 + x*(4./90)));
+	double f3Series = 1 + x*(-4./9 + x*(1./18 + x*(1./45 + x*(1./90))));
+	double f3_xExact = 2*(1-x) * (x*(2+x) + 2*logTerm) / (3*x*x*x);
+	double f3Exact = 1 - (x*(2+x*(-3+x*2)) + 2*(1-x)*(1-x)*logTerm) / (3*x*x);
+	f3_x = useSeries ? f3_xSeries : f3_xExact;
+	return useSeries ? f3Series : f3Exact;
 }
 
 //! Calculate FMT functional
-__hostanddev__ double phiFMT_calc(int i,
+__hostanddev__ double phiFMT_calc(size_t i,
 	const double *n0arr, const double *n1arr, const double *n2arr, const double *n3arr,
 	vector3<const double*> n1vArr, vector3<const double*> n2vArr, tensor3<const double*> n2mArr,
 	double *grad_n0arr, double *grad_n1arr, double *grad_n2arr, double *grad_n3arr,
@@ -123,11 +125,15 @@ __hostanddev__ double phiFMT_calc(int i,
 	double n1 = n1arr[i];
 	double n2 = n2arr[i];
 	double n3 = n3arr[i];
-	if(n0<0. || n1<0. || n2<0. || n3<0.) return 0.;
-	if(n3>=1.) return NAN;
-	vector3<> n1v = loadVector(n1vArr, i);
-	vector3<> n2v = loadVector(n2vArr, i);
+	//Zero free energy and gradient for negative densities, and NAN beyond the packing-fraction pole.
+	//Branch-free implementation: the weighted densities are zeroed in those cases, which yields zero contributions below
+	double zeroFac = (n0<0. || n1<0. || n2<0. || n3<0. || n3>=1.) ? 0. : 1.;
+	double phiInvalid = (n0<0. || n1<0. || n2<0. || n3<0.) ? 0. : NAN; //returned when zeroFac = 0
+	n0 *= zeroFac; n1 *= zeroFac; n2 *= zeroFac; n3 *= zeroFac;
+	vector3<> n1v = zeroFac * loadVector(n1vArr, i);
+	vector3<> n2v = zeroFac * loadVector(n2vArr, i);
 	tensor3<> n2m = loadTensor(n2mArr, i);
+	for(int k=0; k<5; k++) n2m[k] *= zeroFac;
 	double tensorPart = mul_vTmv(n2m, n2v) - 0.5*trace_cubed(n2m);
 
 	double n1v_n2v = dot(n1v, n2v);
@@ -136,8 +142,9 @@ __hostanddev__ double phiFMT_calc(int i,
 
 	double f2prime, f2 = WB_f2(n3, f2prime), comb2 = (n1*n2-n1v_n2v);
 	double f3prime, f3 = WB_f3(n3, f3prime), comb3 = (n2*(n2*n2-3*n2vsq) + 9.*tensorPart);
-	double phi    = n0*log(pole) + pole*(f2*comb2 + pole*((1./((24*M_PI)))*f3*comb3));
-	double phi_n0 = log(pole);
+	double logPole = -simd_log(1-n3);
+	double phi    = n0*logPole + pole*(f2*comb2 + pole*((1./((24*M_PI)))*f3*comb3));
+	double phi_n0 = logPole;
 	double phi_n1 = pole*(f2*n2);
 	double phi_n2 = pole*(f2*n1 + pole*((1./(8*M_PI))*f3*(n2*n2-n2vsq)));
 	double phi_n3 = pole*(n0 + pole*(f2*comb2 + pole*((1./(12*M_PI))*f3*comb3)))
@@ -156,33 +163,39 @@ __hostanddev__ double phiFMT_calc(int i,
 	grad_n2arr[i] += phi_n2;
 	grad_n1arr[i] += phi_n1;
 	grad_n0arr[i] += phi_n0;
-	return phi;
+	return zeroFac==0. ? phiInvalid : phi;
 }
 
 //! Calculate bonding term
-__hostanddev__ double phiBond_calc(int i, double Rhm, double scale,
+__hostanddev__ double phiBond_calc(size_t i, double Rhm, double scale,
 	const double *n0arr, const double *n2arr, const double *n3arr, vector3<const double*> n2vArr,
 	double *grad_n0arr, double *grad_n2arr, double *grad_n3arr, vector3<double*> grad_n2vArr)
 {
 	double n0 = n0arr[i];
 	double n2 = n2arr[i];
 	double n3 = n3arr[i];
-	if(n0<0. || n2<0. || n3<0.) return 0.;
+	//Zero contributions for negative densities (branch-free: zeroed weighted densities yield zero contributions below)
+	double zeroFac = (n0<0. || n2<0. || n3<0.) ? 0. : 1.;
+	n0 *= zeroFac; n2 *= zeroFac; n3 *= zeroFac;
 	double pole = 1.0/(1-n3); //The following is derived easily using: d(pole^N)/d(n3) = N pole^(N+1)
 	//Vector correction factor and derivatives:
-	vector3<> n2v = loadVector(n2vArr, i);
+	vector3<> n2v = zeroFac * loadVector(n2vArr, i);
 	double n2vsq = n2v.length_squared();
-	double zeta = (n2<=0 || n2vsq>n2*n2) ? 0.0 : (1-n2vsq/(n2*n2));
-	double zeta_n2 = zeta ? 2*n2vsq/(n2*n2*n2) : 0.0;
-	vector3<> zeta_n2v = zeta ? (-2/(n2*n2))*n2v : vector3<>();
+	double n2sqInv = 1./(n2*n2);
+	double zeta = (n2<=0 || n2vsq>n2*n2) ? 0.0 : (1-n2vsq*n2sqInv);
+	double zeta_n2 = (zeta==0.) ? 0.0 : 2*n2vsq*n2sqInv/n2;
+	double zeta_n2vFac = (zeta==0.) ? 0.0 : -2*n2sqInv;
+	vector3<> zeta_n2v = zeta_n2vFac * n2v;
 	//Compute the contact correlation function and its derivatives:
-	double gContact      = pole*(1 + zeta * pole*(Rhm*n2 + pole*(2.0/9)*pow(Rhm*n2,2) ));
-	double gContact_n2   = zeta * pow(pole,2)*(Rhm + pole*(4.0/9)*pow(Rhm,2)*n2 );
-	double gContact_n3   = pow(pole,2)*(1 + zeta * pole*(2*Rhm*n2 + pole*(6.0/9)*pow(Rhm*n2,2) ));
-	double gContact_zeta = pow(pole,2) * (Rhm*n2 + pole*(2.0/9)*pow(Rhm*n2,2) );
+	double Rhmn2 = Rhm*n2, poleSq = pole*pole;
+	double gContact      = pole*(1 + zeta * pole*(Rhmn2 + pole*(2.0/9)*Rhmn2*Rhmn2 ));
+	double gContact_n2   = zeta * poleSq*(Rhm + pole*(4.0/9)*Rhm*Rhmn2 );
+	double gContact_n3   = poleSq*(1 + zeta * pole*(2*Rhmn2 + pole*(6.0/9)*Rhmn2*Rhmn2 ));
+	double gContact_zeta = poleSq * (Rhmn2 + pole*(2.0/9)*Rhmn2*Rhmn2 );
 	//Compute the bonding corrections and its derivatives:
-	double phi     = -scale*n0*log(gContact);
-	double phi_n0   = -scale*log(gContact);
+	double logGcontact = simd_log(gContact);
+	double phi     = -scale*n0*logGcontact;
+	double phi_n0   = -scale*logGcontact;
 	double phi_n2   = -scale*n0*gContact_n2/gContact;
 	double phi_n3   = -scale*n0*gContact_n3/gContact;
 	double phi_zeta = -scale*n0*gContact_zeta/gContact;
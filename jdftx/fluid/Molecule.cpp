@@ -20,6 +20,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/ErfFMTweight.h>
 #include <fluid/Molecule.h>
 #include <core/Operators.h>
+#include <core/KernelCache.h>
 #include <electronic/ColumnBundle.h>
 
 Molecule::Site::Site(string name, int atomicNumber) : name(name), Rhs(0), atomicNumber(atomicNumber), Znuc(0), sigmaNuc(0), Zelec(0), aElec(0), Zsite(0), deltaS(0), sigmaElec(0), rcElec(0), alpha(0), aPol(0), initialized(false)
@@ -90,6 +91,7 @@ void Molecule::Site::setup(const GridInfo& gInfo)
 		else
 		{	logPrintf("proportional to exp(-r/%lg)*erfc((r-%lg)/%lg) with norm %lg\n", aElec, rcElec, sigmaElec, Zelec);
 			//--- construct the radial function in real space:
+			//--- (not cached here, since elecKernel retains KernelR as rFunc; the transform itself is cached by RadialFunctionR)
 			RadialFunctionR KernelR(getLogGridKernel());
 			for(unsigned i=0; i<KernelR.r.size(); i++)
 				KernelR.f[i] = PeakedExponential(KernelR.r[i], aElec, rcElec, sigmaElec);
@@ -98,14 +100,16 @@ void Molecule::Site::setup(const GridInfo& gInfo)
 			for(double& f: KernelR.f)
 				f *= scale_factor;
 			KernelR.transform(0, dG, nGridLoc, elecKernel);
-			//--- calculate deltaS that accounts for mismatched charge kernels:
+			//--- calculate deltaS correction for the difference between radial and analytical functions:
 			//where deltaS = -2*pi/3*int(r^2*n(r))dV (realspace formula)
 			for(unsigned i=0; i<KernelR.r.size(); i++)
 			{	double r = KernelR.r[i];
 				KernelR.f[i] = (-2*M_PI/3)*(r*r) * (KernelR.f[i] - Exponential(r,Zelec,aElec));
 			}
+			double deltaSradial = KernelR.transform(0, 0.);
+			//--- calculate deltaS that accounts for mismatched charge kernels:
 			deltaS -= 8*M_PI*Zelec*pow(aElec,2); //apply the potential correction for the analytical exponential function
-			deltaS += KernelR.transform(0, 0.); //apply the potential correction for the difference between radial and analytical functions
+			deltaS += deltaSradial; //apply the potential correction for the difference between radial and analytical functions
 		}
 		
 		if(elecFilename.length())
@@ -128,13 +132,28 @@ void Molecule::Site::setup(const GridInfo& gInfo)
 				rVec.push_back(r);
 				nVec.push_back(n);
 			}
-			RadialFunctionR KernelR(rVec.size());
-			KernelR.r = rVec;
-			KernelR.f = nVec;
-			KernelR.initWeights();
+			KernelCacheKey key("siteElecFileKernel"); key << string("v1") << rVec << nVec << aElec << dG << nGridLoc;
+			std::vector<double> cached; //spline coefficients of radial model, followed by the deltaS correction
+			KernelCache::get(key, cached, [&](std::vector<double>& result)
+			{	RadialFunctionR KernelR(rVec.size());
+				KernelR.r = rVec;
+				KernelR.f = nVec;
+				KernelR.initWeights();
+				RadialFunctionG KernelG;
+				KernelR.transform(0, dG, nGridLoc, KernelG);
+				result = KernelG.coeff;
+				//--- deltaS correction for difference from analytical exponential of same norm
+				double norm = KernelG(0.0);
+				KernelG.free();
+				for(unsigned i=0; i<rVec.size(); i++)
+				{	double r = KernelR.r[i];
+					KernelR.f[i] = (-2*M_PI/3)*(r*r) * (KernelR.f[i] - Exponential(r,norm,aElec));
+				}
+				result.push_back(KernelR.transform(0, 0.));
+			});
+			double deltaSradial = cached.back(); cached.pop_back();
+			RadialFunctionG KernelG; KernelG.set(cached, 1./dG);
 			//--- Put kernel in G space and add to existing elecKernel:
-			RadialFunctionG KernelG;
-			KernelR.transform(0, dG, nGridLoc, KernelG);
 			std::vector<double> newKernel;
 			for (int i=0; i<nGridLoc; i++)
 			{	double G = i*dG;
@@ -145,12 +164,9 @@ void Molecule::Site::setup(const GridInfo& gInfo)
 			logPrintf("         Adjusting Znuc to %lg to ensure correct site charge.\n",Znuc);
 			//--- Update deltaS correction for new piece
 			double norm = KernelG(0.0);
-			for(unsigned i=0; i<rVec.size(); i++)
-			{	double r = KernelR.r[i];
-				KernelR.f[i] = (-2*M_PI/3)*(r*r) * (KernelR.f[i] - Exponential(r,norm,aElec));
-			}
+			KernelG.free();
 			deltaS -= 8*M_PI*norm*pow(aElec,2); //apply the potential correction for the analytical exponential function
-			deltaS += KernelR.transform(0, 0.); //apply the potential correction for the difference between radial and analytical functions
+			deltaS += deltaSradial; //apply the potential correction for the difference between radial and analytical functions
 		}
 		
 		if(elecFilenameG.length())
@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ScalarFieldIO.h>
 #include <core/VectorField.h>
 #include <core/SphericalHarmonics.h>
+#include <core/KernelCache.h>
 #include <fluid/SaLSA.h>
 #include <fluid/PCM_internal.h>
 #include <gsl/gsl_linalg.h>
@@ -79,49 +80,70 @@ SaLSA::SaLSA(const Everything& e, const FluidSolverParams& fsp)
 	//Rotational and translational response (includes ionic response):
 	const double bessel_jl_by_Gl_zero[4] = {1., 1./3, 1./15, 1./105}; //G->0 limit of j_l(G)/G^l
 	for(const auto& c: fsp.components)
-		for(int l=0; l<=fsp.lMax; l++)
-		{	//Calculate radial densities for all m:
-			gsl_matrix* V = gsl_matrix_calloc(nGradial, 2*l+1); //allocate and set to zero
-			double prefac = sqrt(4.*M_PI*c->Nbulk/fsp.T);
-			for(unsigned iG=0; iG<nGradial; iG++)
-			{	double G = iG*dG;
-				for(const auto& site: c->molecule.sites)
-				{	double Vsite = prefac * site->chargeKernel(G);
-					for(const vector3<>& r: site->positions)
-					{	double rLength = r.length();
-						double bessel_jl_by_Gl = G ? bessel_jl(l,G*rLength)/pow(G,l) : bessel_jl_by_Gl_zero[l]*pow(rLength,l);
-						vector3<> rHat = (rLength ? 1./rLength : 0.) * r;
-						for(int m=-l; m<=+l; m++)
-							*gsl_matrix_ptr(V,iG,l+m) += Vsite * bessel_jl_by_Gl * Ylm(l,m, rHat);
+	{	double prefac = sqrt(4.*M_PI*c->Nbulk/fsp.T);
+		KernelCacheKey key("SaLSAresponse"); key << string("v1") << fsp.lMax << prefac << sqrtCrot << dG << size_t(nGradial);
+		for(const auto& site: c->molecule.sites)
+		{	key << site->chargeKernel.coeff;
+			for(const vector3<>& r: site->positions) key << r;
+		}
+		std::vector<double> cached; //for each l: l, number of modes, followed by the radial functions of each mode
+		KernelCache::get(key, cached, [&](std::vector<double>& result)
+		{	result.clear();
+			for(int l=0; l<=fsp.lMax; l++)
+			{	//Calculate radial densities for all m:
+				gsl_matrix* V = gsl_matrix_calloc(nGradial, 2*l+1); //allocate and set to zero
+				for(unsigned iG=0; iG<nGradial; iG++)
+				{	double G = iG*dG;
+					for(const auto& site: c->molecule.sites)
+					{	double Vsite = prefac * site->chargeKernel(G);
+						for(const vector3<>& r: site->positions)
+						{	double rLength = r.length();
+							double bessel_jl_by_Gl = G ? bessel_jl(l,G*rLength)/pow(G,l) : bessel_jl_by_Gl_zero[l]*pow(rLength,l);
+							vector3<> rHat = (rLength ? 1./rLength : 0.) * r;
+							for(int m=-l; m<=+l; m++)
+								*gsl_matrix_ptr(V,iG,l+m) += Vsite * bessel_jl_by_Gl * Ylm(l,m, rHat);
+						}
 					}
 				}
-			}
-			//Scale dipole active modes:
-			for(int lm=0; lm<2l+1; lm++)
-				if(l==1 && fabs(gsl_matrix_get(V,0,lm))>1e-6)
+				//Scale dipole active modes:
+				for(int lm=0; lm<2l+1; lm++)
+					if(l==1 && fabs(gsl_matrix_get(V,0,lm))>1e-6)
+						for(unsigned iG=0; iG<nGradial; iG++)
+							*gsl_matrix_ptr(V,iG,lm) *= sqrtCrot;
+				//Get linearly-independent non-zero modes by performing an SVD:
+				gsl_vector* S = gsl_vector_alloc(2*l+1);
+				gsl_matrix* U = gsl_matrix_alloc(2*l+1, 2*l+1);
+				gsl_matrix* tmpMat = gsl_matrix_alloc(2*l+1, 2*l+1);
+				gsl_vector* tmpVec = gsl_vector_alloc(2*l+1);
+				gsl_linalg_SV_decomp_mod(V, tmpMat, U, S, tmpVec);
+				gsl_vector_free(tmpVec);
+				gsl_matrix_free(tmpMat);
+				gsl_matrix_free(U);
+				//Collect response functions for non-singular modes:
+				result.push_back(l);
+				size_t nModesIndex = result.size(); result.push_back(0.);
+				for(int mode=0; mode<2*l+1; mode++)
+				{	double Smode = gsl_vector_get(S, mode);
+					if(Smode*Smode < 1e-3) break;
 					for(unsigned iG=0; iG<nGradial; iG++)
-						*gsl_matrix_ptr(V,iG,lm) *= sqrtCrot;
-			//Get linearly-independent non-zero modes by performing an SVD:
-			gsl_vector* S = gsl_vector_alloc(2*l+1);
-			gsl_matrix* U = gsl_matrix_alloc(2*l+1, 2*l+1);
-			gsl_matrix* tmpMat = gsl_matrix_alloc(2*l+1, 2*l+1);
-			gsl_vector* tmpVec = gsl_vector_alloc(2*l+1);
-			gsl_linalg_SV_decomp_mod(V, tmpMat, U, S, tmpVec);
-			gsl_vector_free(tmpVec);
-			gsl_matrix_free(tmpMat);
-			gsl_matrix_free(U);
-			//Add response functions for non-singular modes:
-			for(int mode=0; mode<2*l+1; mode++)
-			{	double Smode = gsl_vector_get(S, mode);
-				if(Smode*Smode < 1e-3) break;
-				std::vector<double> Vsamples(nGradial);
-				for(unsigned iG=0; iG<nGradial; iG++)
-					Vsamples[iG] = Smode * gsl_matrix_get(V, iG, mode);
+						result.push_back(Smode * gsl_matrix_get(V, iG, mode));
+					result[nModesIndex] += 1.;
+				}
+				gsl_vector_free(S);
+				gsl_matrix_free(V);
+			}
+		});
+		//Add response functions:
+		std::vector<double>::const_iterator data = cached.begin();
+		for(int l=0; l<=fsp.lMax; l++)
+		{	assert(int(*(data++)) == l);
+			int nModes = int(*(data++));
+			for(int mode=0; mode<nModes; mode++)
+			{	std::vector<double> Vsamples(data, data+nGradial); data += nGradial;
 				response.push_back(std::make_shared<MultipoleResponse>(l, -1, 1, Vsamples, dG));
 			}
-			gsl_vector_free(S);
-			gsl_matrix_free(V);
 		}
+	}
 	
 	//Polarizability response:
 	for(unsigned iSite=0; iSite<solvent->molecule.sites.size(); iSite++)
@@ -27,6 +27,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/IonDynamics.h>
 #include <fluid/FluidSolver.h>
 #include <core/Util.h>
+#include <core/Metrics.h>
 #include <commands/parser.h>
 
 //Program entry point
@@ -42,6 +43,7 @@ int main(int argc, char** argv)
 	if(ip.dryRun) eVars.skipWfnsInit = true;
 	e.setup();
 	e.dump(DumpFreq_Init, 0);
+	Metrics::Record("stage").add("name", "setup").emit(mpiWorld);
 	Citations::print();
 	if(ip.dryRun)
 	{	logPrintf("Dry run successful: commands are valid and initialization succeeded.\n");
@@ -91,8 +93,12 @@ int main(int argc, char** argv)
 		imin.minimize(e.ionicMinParams);
 	}
 
+	Metrics::Record("stage").add("name", "calculation").emit(mpiWorld);
+
 	//Final dump:
 	e.dump(DumpFreq_End, 0);
+	Metrics::Record("stage").add("name", "dump").emit(mpiWorld);
+	e.memoryPlan.report();
 	
 	finalizeSystem();
 	return 0;
@@ -0,0 +1,7 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#Relative deviation of analytic from finite-difference stress (first StressCheck line: initial lattice)
+awk '/StressCheck:/ { print $3/$5, "0 0.01 Si LDA stress deviation"; exit }' SiLDA.out
+awk '/StressCheck:/ { print $3/$5, "0 0.01 Mg GGA+D2 stress deviation"; exit }' MgGGA.out
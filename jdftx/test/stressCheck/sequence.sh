@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="SiLDA MgGGA"
+export nProcs="4"
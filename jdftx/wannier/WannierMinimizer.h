@@ -66,6 +66,7 @@ public:
 	void constrain(WannierGradient& grad); //!< enforce hermiticity
 	bool report(int iter);
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
+	const MPIUtil* metricsComm() const { return mpiWorld; } //!< All processes minimize together
 	
 	//! Entries in the k-point mesh
 	struct Kpoint : public QuantumNumber, public Supercell::KmeshTransform